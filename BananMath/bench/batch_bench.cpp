@@ -0,0 +1,128 @@
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "batch.h"
+#include "bench.h"
+#include "mat.h"
+#include "parallel.h"
+#include "quat.h"
+#include "random.h"
+#include "vec.h"
+
+// Batch kernels run serially and on thread pools of 1, 2, 4, ... up to
+// the hardware thread count. Speedups are against the serial overload,
+// the small size stays in cache, the large one streams from memory and
+// takes the non-temporal store path of the transforms.
+
+namespace
+{
+	using namespace Banan;
+
+	constexpr std::size_t small_count = std::size_t(1) << 16;
+	constexpr std::size_t large_count = std::size_t(1) << 22;
+
+	std::vector<uint32_t> thread_counts()
+	{
+		const uint32_t hardware = std::max(std::thread::hardware_concurrency(), 1u);
+		std::vector<uint32_t> counts;
+		for (uint32_t n = 1; n < hardware; n *= 2)
+			counts.push_back(n);
+		counts.push_back(hardware);
+		return counts;
+	}
+
+	std::vector<vec3f> random_points(std::size_t count)
+	{
+		pcg32_fast engine(42);
+		std::vector<vec3f> points(count);
+		for (vec3f& p : points)
+			p = vec3f::random(engine, -10.0f, 10.0f);
+		return points;
+	}
+
+	// Times serial(), then parallel(pool) for every pool size
+	template<typename Serial, typename Parallel>
+	void sweep(const std::string& name, std::size_t count, const Serial& serial, const Parallel& parallel)
+	{
+		const double baseline = bench::best_of(serial);
+		bench::report(name + ", serial", baseline, count, baseline, "vec");
+		for (uint32_t threads : thread_counts())
+		{
+			thread_pool pool(threads);
+			const double seconds = bench::best_of([&] { parallel(pool); });
+			bench::report(name + ", " + std::to_string(threads) + " threads", seconds, count, baseline, "vec");
+		}
+	}
+
+	void batch_threads()
+	{
+		for (std::size_t count : { small_count, large_count })
+		{
+			const std::string size = std::to_string(count);
+			const std::vector<vec3f> a = random_points(count);
+			const std::vector<vec3f> b = random_points(count);
+			std::vector<vec3f> out(count);
+			std::vector<float> scalars(count);
+			const std::span<vec3f> o(out);
+			const std::span<float> s(scalars);
+
+			sweep("add vec3f x" + size, count,
+				[&] { batch::add(a, b, o); },
+				[&](thread_pool& pool) { batch::add(pool, a, b, o); });
+			sweep("dot vec3f x" + size, count,
+				[&] { batch::dot<3>(a, b, s); },
+				[&](thread_pool& pool) { batch::dot<3>(pool, a, b, s); });
+			sweep("normalize vec3f x" + size, count,
+				[&] { batch::normalize(a, o); },
+				[&](thread_pool& pool) { batch::normalize(pool, a, o); });
+			sweep("cross vec3f x" + size, count,
+				[&] { batch::cross(a, b, o); },
+				[&](thread_pool& pool) { batch::cross(pool, a, b, o); });
+
+			const quatf q = quatf::from_axis_angle(vec3f(1.0f, 2.0f, 3.0f).normalize(), 0.7f);
+			sweep("rotate vec3f x" + size, count,
+				[&] { batch::rotate(q, a, o); },
+				[&](thread_pool& pool) { batch::rotate(pool, q, a, o); });
+			bench::keep(out[count / 2]);
+			bench::keep(scalars[count / 2]);
+		}
+	}
+
+	// Points per second of the affine transform engine
+	void batch_transform_threads()
+	{
+		const float values[16] = {
+			0.8f, -0.6f, 0.0f, 4.0f,
+			0.6f, 0.8f, 0.0f, -2.0f,
+			0.0f, 0.0f, 1.0f, 1.5f,
+			0.0f, 0.0f, 0.0f, 1.0f
+		};
+		const mat4f m = mat4f::from_row_major(values);
+
+		for (std::size_t count : { small_count, large_count })
+		{
+			const std::string size = std::to_string(count);
+			const std::vector<vec3f> points = random_points(count);
+			std::vector<vec3f> out(count);
+			const std::span<vec3f> o(out);
+
+			sweep("transform_points vec3f x" + size, count,
+				[&] { batch::transform_points(m, points, o); },
+				[&](thread_pool& pool) { batch::transform_points(pool, m, points, o); });
+			sweep("transform_directions vec3f x" + size, count,
+				[&] { batch::transform_directions(m, points, o); },
+				[&](thread_pool& pool) { batch::transform_directions(pool, m, points, o); });
+			sweep("project_points vec3f x" + size, count,
+				[&] { batch::project_points(m, points, o); },
+				[&](thread_pool& pool) { batch::project_points(pool, m, points, o); });
+			bench::keep(out[count / 2]);
+		}
+	}
+}
+
+BANAN_BENCHMARK("batch kernels, thread sweep", batch_threads);
+BANAN_BENCHMARK("batch transforms, thread sweep", batch_transform_threads);
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+// Minimal benchmark harness.
+//
+// Every bench/*.cpp registers its benchmarks with BANAN_BENCHMARK and
+// main.cpp runs the ones whose name contains one of the command line
+// arguments, or all of them. Timings are the fastest of a few runs, so
+// one noisy run does not skew the numbers. Benchmarks registered with
+// BANAN_BENCHMARK_OPT_IN are too slow or large for a default run and only
+// run when an argument is their full name.
+
+namespace Banan::bench
+{
+
+	struct benchmark
+	{
+		const char* name;
+		void (*run)();
+		bool opt_in;
+	};
+
+	inline std::vector<benchmark>& registry()
+	{
+		static std::vector<benchmark> s_benchmarks;
+		return s_benchmarks;
+	}
+
+	struct registrar
+	{
+		registrar(const char* name, void (*run)(), bool opt_in = false)
+		{
+			registry().push_back({ name, run, opt_in });
+		}
+	};
+
+	// Seconds taken by the fastest of repeats calls of f
+	template<typename F>
+	double best_of(int repeats, const F& f)
+	{
+		double best = 1e30;
+		for (int i = 0; i < repeats; i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			f();
+			best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		}
+		return best;
+	}
+	template<typename F>
+	double best_of(const F& f)
+	{
+		return best_of(5, f);
+	}
+
+	inline volatile unsigned char s_sink;
+
+	// Reads value through a volatile so the work producing it is kept
+	template<typename T>
+	void keep(const T& value)
+	{
+		s_sink = *reinterpret_cast<const volatile unsigned char*>(&value);
+	}
+
+	// Prints one result line, rate in millions of items per second and
+	// time per item in nanoseconds
+	inline void report(std::string_view name, double seconds, std::size_t items, std::string_view unit = "items")
+	{
+		std::printf("  %-50.*s %10.1f M%.*s/s %9.3f ns\n", int(name.size()), name.data(),
+			double(items) / seconds * 1e-6, int(unit.size()), unit.data(), seconds / double(items) * 1e9);
+	}
+
+	// Same with the speedup over a baseline time for the same work
+	inline void report(std::string_view name, double seconds, std::size_t items, double baseline, std::string_view unit = "items")
+	{
+		std::printf("  %-50.*s %10.1f M%.*s/s %9.3f ns %7.2fx\n", int(name.size()), name.data(),
+			double(items) / seconds * 1e-6, int(unit.size()), unit.data(), seconds / double(items) * 1e9, baseline / seconds);
+	}
+
+}
+
+#define BANAN_BENCH_CONCAT2(a, b) a##b
+#define BANAN_BENCH_CONCAT(a, b) BANAN_BENCH_CONCAT2(a, b)
+#define BANAN_BENCHMARK(name, function) \
+	static const ::Banan::bench::registrar BANAN_BENCH_CONCAT(s_benchmark_, __LINE__)(name, function)
+#define BANAN_BENCHMARK_OPT_IN(name, function) \
+	static const ::Banan::bench::registrar BANAN_BENCH_CONCAT(s_benchmark_, __LINE__)(name, function, true)
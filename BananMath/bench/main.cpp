@@ -0,0 +1,37 @@
+#include <cstdio>
+#include <string_view>
+#include <thread>
+
+#include "bench.h"
+#include "simd.h"
+
+// Runs every registered benchmark, or those whose name contains one of
+// the arguments: BananMathBench batch random. Opt-in benchmarks need their
+// full name: BananMathBench "random alias table 100M"
+
+int main(int argc, char** argv)
+{
+#if defined(BANAN_AVX512)
+	const char* isa = "AVX-512";
+#elif defined(BANAN_AVX2)
+	const char* isa = "AVX2";
+#elif defined(BANAN_SSE)
+	const char* isa = "SSE";
+#else
+	const char* isa = "scalar";
+#endif
+	std::printf("BananMath benchmarks, %s, %u hardware threads\n", isa, std::thread::hardware_concurrency());
+
+	for (const Banan::bench::benchmark& b : Banan::bench::registry())
+	{
+		bool selected = argc < 2 && !b.opt_in;
+		for (int i = 1; i < argc; i++)
+			selected |= b.opt_in ? std::string_view(b.name) == argv[i] : std::string_view(b.name).find(argv[i]) != std::string_view::npos;
+		if (!selected)
+			continue;
+
+		std::printf("\n%s\n", b.name);
+		b.run();
+	}
+	return 0;
+}
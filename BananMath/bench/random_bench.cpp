@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "alias_table.h"
+#include "bench.h"
+#include "parallel.h"
+#include "random.h"
+#include "random_lanes.h"
+#include "sampling.h"
+#include "vec.h"
+
+// Generators and distributions, the bulk fill_* functions against a loop
+// of single draws and against the standard library where it has the same
+// distribution. Every benchmark fills count values.
+
+namespace
+{
+	using namespace Banan;
+
+	constexpr std::size_t count = std::size_t(1) << 20;
+
+	/* ######################## Engines ######################### */
+
+	template<typename Engine>
+	double engine_rate(const std::string& name, double baseline = 0)
+	{
+		Engine engine(42);
+		std::vector<typename Engine::result_type> out(count);
+		const double seconds = bench::best_of([&] { for (auto& v : out) v = engine(); });
+		if (baseline > 0)
+			bench::report(name, seconds, count, baseline, "draw");
+		else
+			bench::report(name, seconds, count, "draw");
+		bench::keep(out[count / 2]);
+		return seconds;
+	}
+
+	void engines()
+	{
+		const double baseline = engine_rate<pcg32>("pcg32");
+		engine_rate<pcg32_fast>("pcg32_fast", baseline);
+		engine_rate<pcg64>("pcg64", baseline);
+		engine_rate<pcg64_fast>("pcg64_fast", baseline);
+		engine_rate<std::mt19937>("std::mt19937", baseline);
+
+		// The lanes engines through fill, a whole register of lanes a step
+		std::vector<uint32_t> out(count);
+		auto lanes = [&]<uint32_t Lanes>(const char* name) {
+			pcg32_lanes<Lanes> engine(42);
+			const double seconds = bench::best_of([&] { engine.fill(out); });
+			bench::report(name, seconds, count, baseline, "draw");
+		};
+		lanes.template operator()<4>("pcg32_lanes<4> fill");
+		lanes.template operator()<8>("pcg32_lanes<8> fill");
+		lanes.template operator()<16>("pcg32_lanes<16> fill");
+		bench::keep(out[count / 2]);
+	}
+
+	// Engines per second from random_streams, one per task or tile
+	void streams()
+	{
+		const random_streams source(42);
+		constexpr std::size_t engines = 1 << 16;
+		uint32_t sum = 0;
+		double seconds = bench::best_of([&] { for (std::size_t i = 0; i < engines; i++) sum += source.stream(i)(); });
+		bench::report("stream(i)", seconds, engines, "engine");
+		seconds = bench::best_of([&] { for (std::size_t i = 0; i < engines; i++) sum += source.block(i, 1 << 20)(); });
+		bench::report("block(i, 2^20)", seconds, engines, "engine");
+		seconds = bench::best_of([&] { for (std::size_t i = 0; i < engines; i++) sum += pcg32(std::seed_seq{ uint32_t(i) })(); });
+		bench::report("pcg32(seed_seq)", seconds, engines, "engine");
+		bench::keep(sum);
+	}
+
+	/* ######################## Uniform ######################### */
+
+	// fill_uniform against get_random_uniform per value
+	template<typename T, typename Engine>
+	void uniform_of(const std::string& name, T min, T max)
+	{
+		Engine engine(42);
+		std::vector<T> out(count);
+		const double baseline = bench::best_of([&] { for (T& v : out) v = get_random_uniform<T>(engine, min, max); });
+		bench::report(name + ", get_random_uniform", baseline, count, "draw");
+		const double seconds = bench::best_of([&] { fill_uniform<T>(engine, out, min, max); });
+		bench::report(name + ", fill_uniform", seconds, count, baseline, "draw");
+		bench::keep(out[count / 2]);
+	}
+
+	void uniform()
+	{
+		uniform_of<float, pcg32_fast>("float, pcg32_fast", 0.0f, 1.0f);
+		uniform_of<float, pcg32_simd>("float, pcg32_simd", 0.0f, 1.0f);
+		uniform_of<double, pcg64_fast>("double, pcg64_fast", 0.0, 1.0);
+		uniform_of<uint32_t, pcg32_fast>("uint32_t [0, 1000)", 0u, 999u);
+		uniform_of<uint32_t, pcg32_fast>("uint32_t [0, 3 * 2^30]", 0u, 3u << 30);
+		uniform_of<uint64_t, pcg64_fast>("uint64_t [0, 10^12)", 0ull, 999999999999ull);
+
+		// Bounded integers from the standard library for comparison
+		pcg32_fast engine(42);
+		std::vector<uint32_t> out(count);
+		std::uniform_int_distribution<uint32_t> dist(0, 999);
+		const double seconds = bench::best_of([&] { for (uint32_t& v : out) v = dist(engine); });
+		bench::report("uint32_t [0, 1000), std::uniform_int_distribution", seconds, count, "draw");
+		bench::keep(out[count / 2]);
+	}
+
+	/* ######################## Ziggurat ######################## */
+
+	template<typename T, typename Engine, uint32_t Layers>
+	void ziggurat_layers_of(const std::string& type, double normal_baseline, double exponential_baseline)
+	{
+		Engine engine(42);
+		std::vector<T> out(count);
+		const std::string layers = std::to_string(Layers) + " layers";
+		double seconds = bench::best_of([&] { fill_normal<T, Layers>(engine, out); });
+		bench::report("fill_normal " + type + ", " + layers, seconds, count, normal_baseline, "draw");
+		seconds = bench::best_of([&] { fill_exponential<T, Layers>(engine, out); });
+		bench::report("fill_exponential " + type + ", " + layers, seconds, count, exponential_baseline, "draw");
+		bench::keep(out[count / 2]);
+	}
+
+	// Normal and exponential samples against the standard library, then the
+	// ziggurat layer counts against the same baselines
+	template<typename T, typename Engine>
+	void ziggurat_of(const std::string& type)
+	{
+		Engine engine(42);
+		std::vector<T> out(count);
+
+		std::normal_distribution<T> normal;
+		const double normal_baseline = bench::best_of([&] { for (T& v : out) v = normal(engine); });
+		bench::report("std::normal_distribution " + type, normal_baseline, count, "draw");
+		double seconds = bench::best_of([&] { for (T& v : out) v = get_random_normal<T>(engine, T(0), T(1)); });
+		bench::report("get_random_normal " + type, seconds, count, normal_baseline, "draw");
+		seconds = bench::best_of([&] { fill_normal<T>(engine, out); });
+		bench::report("fill_normal " + type, seconds, count, normal_baseline, "draw");
+
+		// The inversion method, one log per value
+		const double exponential_baseline = bench::best_of([&] { for (T& v : out) v = -std::log(T(1) - get_random_uniform<T>(engine)); });
+		bench::report("-log(1 - u) " + type, exponential_baseline, count, "draw");
+		std::exponential_distribution<T> exponential;
+		seconds = bench::best_of([&] { for (T& v : out) v = exponential(engine); });
+		bench::report("std::exponential_distribution " + type, seconds, count, exponential_baseline, "draw");
+		seconds = bench::best_of([&] { for (T& v : out) v = get_random_exponential<T>(engine, T(1)); });
+		bench::report("get_random_exponential " + type, seconds, count, exponential_baseline, "draw");
+		seconds = bench::best_of([&] { fill_exponential<T>(engine, out); });
+		bench::report("fill_exponential " + type, seconds, count, exponential_baseline, "draw");
+		bench::keep(out[count / 2]);
+
+		ziggurat_layers_of<T, Engine, 128>(type, normal_baseline, exponential_baseline);
+		ziggurat_layers_of<T, Engine, 256>(type, normal_baseline, exponential_baseline);
+		ziggurat_layers_of<T, Engine, 1024>(type, normal_baseline, exponential_baseline);
+	}
+
+	void ziggurat()
+	{
+		ziggurat_of<float, pcg32_fast>("float");
+		ziggurat_of<double, pcg64_fast>("double");
+	}
+
+	/* ######################### Gamma ########################## */
+
+	void gamma()
+	{
+		pcg64_fast engine(42);
+		std::vector<double> out(count);
+		for (double shape : { 0.3, 1.0, 2.5, 30.0 })
+		{
+			const std::string name = "shape " + std::to_string(shape).substr(0, 4);
+			std::gamma_distribution<double> dist(shape);
+			const double baseline = bench::best_of([&] { for (double& v : out) v = dist(engine); });
+			bench::report(name + ", std::gamma_distribution", baseline, count, "draw");
+			double seconds = bench::best_of([&] { for (double& v : out) v = get_random_gamma<double>(engine, shape); });
+			bench::report(name + ", get_random_gamma", seconds, count, baseline, "draw");
+			seconds = bench::best_of([&] { fill_gamma<double>(engine, out, shape); });
+			bench::report(name + ", fill_gamma", seconds, count, baseline, "draw");
+		}
+		const double seconds = bench::best_of([&] { fill_beta<double>(engine, out, 2.0, 5.0); });
+		bench::report("fill_beta (2, 5)", seconds, count, "draw");
+		bench::keep(out[count / 2]);
+	}
+
+	/* ###################### Alias table ####################### */
+
+	// Building and sampling a table of size outcomes, against
+	// std::discrete_distribution which searches the cumulative weights
+	void alias_of(std::size_t size)
+	{
+		const std::string name = std::to_string(size) + " weights";
+		pcg64_fast engine(42);
+		std::vector<double> weights(size);
+		fill_exponential<double>(engine, weights);
+
+		std::discrete_distribution<uint32_t> dist;
+		const double std_build = bench::best_of([&] { dist = std::discrete_distribution<uint32_t>(weights.begin(), weights.end()); });
+		bench::report(name + ", std::discrete_distribution build", std_build, size, "weight");
+		alias_table<double> table;
+		const double build = bench::best_of([&] { table = alias_table<double>(weights); });
+		bench::report(name + ", build", build, size, std_build, "weight");
+		const uint32_t hardware = std::max(std::thread::hardware_concurrency(), 1u);
+		thread_pool pool(hardware);
+		const double parallel = bench::best_of([&] { table = alias_table<double>(pool, weights); });
+		bench::report(name + ", build on " + std::to_string(hardware) + " threads", parallel, size, build, "weight");
+
+		std::vector<uint32_t> out(count);
+		const double baseline = bench::best_of([&] { for (uint32_t& v : out) v = dist(engine); });
+		bench::report(name + ", std::discrete_distribution", baseline, count, "draw");
+		double seconds = bench::best_of([&] { for (uint32_t& v : out) v = table.sample(engine); });
+		bench::report(name + ", sample", seconds, count, baseline, "draw");
+		seconds = bench::best_of([&] { table.fill(engine, out); });
+		bench::report(name + ", fill", seconds, count, baseline, "draw");
+		pcg32_simd lanes(42);
+		seconds = bench::best_of([&] { table.fill(lanes, out); });
+		bench::report(name + ", fill pcg32_simd", seconds, count, baseline, "draw");
+		bench::keep(out[count / 2]);
+	}
+
+	void alias()
+	{
+		alias_of(std::size_t(1) << 10);
+		alias_of(std::size_t(1) << 20);
+	}
+
+	// 100M outcomes need about 2.5 GB for the weights, the table and the
+	// standard distribution, so this one only runs when asked for
+	void alias_large()
+	{
+		alias_of(100000000);
+	}
+
+	/* ####################### Geometry ######################### */
+
+	// Points in the unit disc and ball against rejection sampling from the
+	// enclosing square (cube)
+	void points()
+	{
+		pcg32_fast engine(42);
+		std::vector<vec2f> disc(count);
+		std::vector<vec3f> ball(count);
+
+		double baseline = bench::best_of([&] {
+			for (vec2f& p : disc)
+				do p = vec2f(get_random_uniform<float>(engine, -1.0f, 1.0f), get_random_uniform<float>(engine, -1.0f, 1.0f));
+				while (p.magSq() > 1.0f);
+		});
+		bench::report("disc, rejection", baseline, count, "point");
+		double seconds = bench::best_of([&] { for (vec2f& p : disc) p = vec2f::random_in_unit_disc(engine); });
+		bench::report("disc, random_in_unit_disc", seconds, count, baseline, "point");
+		seconds = bench::best_of([&] { fill_in_unit_disc(engine, std::span<vec2f>(disc)); });
+		bench::report("disc, fill_in_unit_disc", seconds, count, baseline, "point");
+
+		baseline = bench::best_of([&] {
+			for (vec3f& p : ball)
+				do p = vec3f::random(engine, -1.0f, 1.0f);
+				while (p.magSq() > 1.0f);
+		});
+		bench::report("ball, rejection", baseline, count, "point");
+		seconds = bench::best_of([&] { for (vec3f& p : ball) p = vec3f::random_in_unit_sphere(engine); });
+		bench::report("ball, random_in_unit_sphere", seconds, count, baseline, "point");
+		seconds = bench::best_of([&] { fill_in_unit_sphere(engine, std::span<vec3f>(ball)); });
+		bench::report("ball, fill_in_unit_sphere", seconds, count, baseline, "point");
+		seconds = bench::best_of([&] { fill_on_unit_sphere(engine, std::span<vec3f>(ball)); });
+		bench::report("sphere, fill_on_unit_sphere", seconds, count, "point");
+		bench::keep(disc[count / 2]);
+		bench::keep(ball[count / 2]);
+	}
+
+	// Direction samplers around per-sample normals, a single draw per
+	// direction against the bulk fill
+	void directions()
+	{
+		pcg32_fast engine(42);
+		std::vector<vec3f> normals(count), out(count);
+		fill_on_unit_sphere(engine, std::span<vec3f>(normals));
+		const std::span<vec3f> o(out);
+
+		auto compare = [&](const std::string& name, const auto& single, const auto& bulk) {
+			const double baseline = bench::best_of([&] { for (std::size_t i = 0; i < count; i++) out[i] = single(normals[i]); });
+			bench::report(name + ", single", baseline, count, "dir");
+			const double seconds = bench::best_of(bulk);
+			bench::report(name + ", fill", seconds, count, baseline, "dir");
+		};
+		compare("hemisphere",
+			[&](const vec3f& n) { return random_hemisphere(engine, n); },
+			[&] { fill_hemisphere(engine, normals, o); });
+		compare("cosine hemisphere",
+			[&](const vec3f& n) { return random_cosine_hemisphere(engine, n); },
+			[&] { fill_cosine_hemisphere(engine, normals, o); });
+		compare("cone 0.8",
+			[&](const vec3f& n) { return random_cone(engine, n, 0.8f); },
+			[&] { fill_cone(engine, normals, 0.8f, o); });
+		compare("ggx half 0.3",
+			[&](const vec3f& n) { return random_ggx_half(engine, n, 0.3f); },
+			[&] { fill_ggx_half(engine, normals, 0.3f, o); });
+		compare("beckmann half 0.3",
+			[&](const vec3f& n) { return random_beckmann_half(engine, n, 0.3f); },
+			[&] { fill_beckmann_half(engine, normals, 0.3f, o); });
+		bench::keep(out[count / 2]);
+	}
+}
+
+BANAN_BENCHMARK("random engines", engines);
+BANAN_BENCHMARK("random streams", streams);
+BANAN_BENCHMARK("random uniform", uniform);
+BANAN_BENCHMARK("random normal and exponential", ziggurat);
+BANAN_BENCHMARK("random gamma", gamma);
+BANAN_BENCHMARK("random alias table", alias);
+BANAN_BENCHMARK_OPT_IN("random alias table 100M", alias_large);
+BANAN_BENCHMARK("random points", points);
+BANAN_BENCHMARK("random directions", directions);
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "mat.h"
+#include "quat.h"
+#include "random.h"
+#include "vec.h"
+#include "vec_expr.h"
+
+// Vector operations against the plain scalar code they replace. Every
+// benchmark runs over an array of count elements so the loop, not a
+// single call, is timed.
+
+namespace
+{
+	using namespace Banan;
+
+	constexpr std::size_t count = std::size_t(1) << 16;
+
+	// Three floats and nothing else, what the vec3f register class replaces
+	struct scalar3
+	{
+		float x, y, z;
+
+		scalar3 operator+(const scalar3& v) const { return { x + v.x, y + v.y, z + v.z }; }
+		scalar3 operator*(float s) const { return { x * s, y * s, z * s }; }
+		float dot(const scalar3& v) const { return x * v.x + y * v.y + z * v.z; }
+		scalar3 cross(const scalar3& v) const { return { y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x }; }
+		scalar3 unit() const { return *this * (1.0f / std::sqrt(dot(*this))); }
+	};
+
+	std::vector<vec3f> random_points(std::size_t n)
+	{
+		pcg32_fast engine(42);
+		std::vector<vec3f> points(n);
+		for (vec3f& p : points)
+			p = vec3f::random(engine, -10.0f, 10.0f);
+		return points;
+	}
+
+	std::vector<scalar3> to_scalar(const std::vector<vec3f>& points)
+	{
+		std::vector<scalar3> out(points.size());
+		for (std::size_t i = 0; i < points.size(); i++)
+			out[i] = { points[i].x, points[i].y, points[i].z };
+		return out;
+	}
+
+	// vec3f against scalar3 for the everyday operations
+	void vec3_operations()
+	{
+		const std::vector<vec3f> a = random_points(count), b = random_points(count);
+		const std::vector<scalar3> sa = to_scalar(a), sb = to_scalar(b);
+		std::vector<vec3f> out(count);
+		std::vector<scalar3> sout(count);
+		std::vector<float> dots(count);
+
+		double baseline = bench::best_of([&] { for (std::size_t i = 0; i < count; i++) sout[i] = sa[i] + sb[i] * 0.5f; });
+		bench::report("a + b * s, scalar", baseline, count, "vec");
+		double seconds = bench::best_of([&] { for (std::size_t i = 0; i < count; i++) out[i] = a[i] + b[i] * 0.5f; });
+		bench::report("a + b * s, vec3f", seconds, count, baseline, "vec");
+
+		baseline = bench::best_of([&] { for (std::size_t i = 0; i < count; i++) dots[i] = sa[i].dot(sb[i]); });
+		bench::report("dot, scalar", baseline, count, "vec");
+		seconds = bench::best_of([&] { for (std::size_t i = 0; i < count; i++) dots[i] = a[i].dot(b[i]); });
+		bench::report("dot, vec3f", seconds, count, baseline, "vec");
+
+		baseline = bench::best_of([&] { for (std::size_t i = 0; i < count; i++) sout[i] = sa[i].cross(sb[i]); });
+		bench::report("cross, scalar", baseline, count, "vec");
+		seconds = bench::best_of([&] { for (std::size_t i = 0; i < count; i++) out[i] = a[i].cross(b[i]); });
+		bench::report("cross, vec3f", seconds, count, baseline, "vec");
+
+		baseline = bench::best_of([&] { for (std::size_t i = 0; i < count; i++) sout[i] = sa[i].unit(); });
+		bench::report("unit, scalar", baseline, count, "vec");
+		seconds = bench::best_of([&] { for (std::size_t i = 0; i < count; i++) out[i] = unit(a[i]); });
+		bench::report("unit, vec3f", seconds, count, baseline, "vec");
+		seconds = bench::best_of([&] { for (std::size_t i = 0; i < count; i++) out[i] = unit_fast(a[i]); });
+		bench::report("unit_fast, vec3f", seconds, count, baseline, "vec");
+		seconds = bench::best_of([&] { unit_fast(std::span<const vec3f>(a), std::span<vec3f>(out)); });
+		bench::report("unit_fast, vec3f span", seconds, count, baseline, "vec");
+
+		bench::keep(out[count / 2]);
+		bench::keep(sout[count / 2]);
+		bench::keep(dots[count / 2]);
+	}
+
+	// Generic vec of Size floats against a loop over plain arrays
+	template<uint32_t Size>
+	void generic_size()
+	{
+		constexpr std::size_t n = count / Size;
+		std::vector<vec<float, Size>> a(n), b(n), out(n);
+		pcg32_fast engine(Size);
+		for (std::size_t i = 0; i < n; i++)
+			for (uint32_t j = 0; j < Size; j++)
+			{
+				a[i][j] = get_random_uniform<float>(engine, -1.0f, 1.0f);
+				b[i][j] = get_random_uniform<float>(engine, -1.0f, 1.0f);
+			}
+
+		const std::string name = "vec<float, " + std::to_string(Size) + ">";
+		const double baseline = bench::best_of([&] {
+			for (std::size_t i = 0; i < n; i++)
+				for (uint32_t j = 0; j < Size; j++)
+					out[i][j] = a[i][j] + b[i][j] * 0.5f;
+		});
+		bench::report(name + " a + b * s, loop", baseline, n * Size, "float");
+		const double seconds = bench::best_of([&] { for (std::size_t i = 0; i < n; i++) out[i] = a[i] + b[i] * 0.5f; });
+		bench::report(name + " a + b * s, vec", seconds, n * Size, baseline, "float");
+
+		float sum = 0;
+		const double dot = bench::best_of([&] { for (std::size_t i = 0; i < n; i++) sum += a[i].dot(b[i]); });
+		bench::report(name + " dot", dot, n * Size, "float");
+		bench::keep(out[n / 2]);
+		bench::keep(sum);
+	}
+
+	void generic_sizes()
+	{
+		generic_size<5>();
+		generic_size<8>();
+		generic_size<16>();
+		generic_size<17>();
+		generic_size<64>();
+		generic_size<1024>();
+	}
+
+	// Expression templates against the eager operators, which store a
+	// temporary vector per operator
+	template<uint32_t Size>
+	void expression_size()
+	{
+		constexpr std::size_t n = std::max<std::size_t>(count / Size, 1);
+		std::vector<vec<float, Size>> a(n), b(n), c(n), out(n);
+		pcg32_fast engine(Size);
+		for (std::size_t i = 0; i < n; i++)
+			for (uint32_t j = 0; j < Size; j++)
+			{
+				a[i][j] = get_random_uniform<float>(engine);
+				b[i][j] = get_random_uniform<float>(engine);
+				c[i][j] = get_random_uniform<float>(engine);
+			}
+
+		const std::string name = "a + s * b - c, vec<float, " + std::to_string(Size) + ">";
+		const double baseline = bench::best_of([&] { for (std::size_t i = 0; i < n; i++) out[i] = a[i] + 2.5f * b[i] - c[i]; });
+		bench::report(name + ", eager", baseline, n * Size, "float");
+		const double seconds = bench::best_of([&] { for (std::size_t i = 0; i < n; i++) out[i] = expr::lazy(a[i]) + 2.5f * expr::lazy(b[i]) - c[i]; });
+		bench::report(name + ", lazy", seconds, n * Size, baseline, "float");
+		bench::keep(out[n / 2]);
+	}
+
+	void expressions()
+	{
+		expression_size<64>();
+		expression_size<256>();
+		expression_size<4096>();
+	}
+
+	// Rotating by a quaternion against the equivalent 3x3 matrix
+	void quat_rotation()
+	{
+		const std::vector<vec3f> points = random_points(count);
+		std::vector<vec3f> out(count);
+		const quatf q = quatf::from_axis_angle(vec3f(1.0f, 2.0f, 3.0f).normalize(), 0.7f);
+		const mat3f m = q.to_mat3();
+
+		const double baseline = bench::best_of([&] { for (std::size_t i = 0; i < count; i++) out[i] = m * points[i]; });
+		bench::report("rotate, mat3f", baseline, count, "vec");
+		const double seconds = bench::best_of([&] { for (std::size_t i = 0; i < count; i++) out[i] = q.rotate(points[i]); });
+		bench::report("rotate, quatf", seconds, count, baseline, "vec");
+
+		quatf r = q;
+		const quatf step = quatf::from_axis_angle(vec3f(0.0f, 1.0f, 0.0f), 1e-3f);
+		const double compose = bench::best_of([&] { for (std::size_t i = 0; i < count; i++) r = r * step; });
+		bench::report("compose, quatf", compose, count, "quat");
+		bench::keep(out[count / 2]);
+		bench::keep(r);
+	}
+}
+
+BANAN_BENCHMARK("vec3f against scalar code", vec3_operations);
+BANAN_BENCHMARK("generic vec sizes", generic_sizes);
+BANAN_BENCHMARK("vec expression templates", expressions);
+BANAN_BENCHMARK("quat rotation", quat_rotation);
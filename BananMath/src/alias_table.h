@@ -0,0 +1,439 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "parallel.h"
+#include "random.h"
+#include "simd.h"
+
+// alias_table<Ty> draws indices in [0, n) with probability proportional
+// to n non-negative weights in O(1) per draw, whatever the distribution
+// (Walker's alias method):
+//
+//	alias_table<float> lights(light_power);
+//	uint32_t light = lights.sample(engine);
+//	float pdf = light_power[light] / lights.total();
+//
+// Every bucket i holds a threshold and an alias in 8 bytes. A draw picks a
+// bucket uniformly and returns i if a 32 bit coin falls below the
+// threshold, the alias otherwise, so one draw costs one 64 bit engine
+// output and one table read.
+//
+// The table is built in O(n) by sweeping the weights with one cursor over
+// the light items (at most the mean weight) and one over the heavy items,
+// heavy items handing their excess to light items in index order. Where
+// the cursors stand after the first k light positions only depends on
+// prefix sums of the deficits and excesses, so an executor builds the
+// table in independent chunks:
+//
+//	alias_table<float> triangles(thread_pool::global(), triangle_areas);
+//
+// The weights are scaled to a mean of 2^32 and rounded to integers before
+// the sweep, so the sums are exact and both builds give the same table.
+//
+// Weights must be finite and non-negative with a positive sum, there must
+// be fewer than 2^32 of them.
+
+namespace Banan
+{
+
+	template<typename Ty = float> requires std::is_floating_point_v<Ty>
+	class alias_table
+	{
+	public:
+		using weight_type = Ty;
+
+		// sample() returns i when its coin is below threshold, alias otherwise
+		struct entry
+		{
+			uint32_t threshold;
+			uint32_t alias;
+		};
+
+	private:
+		// Every build chunk sorts its items into a light and a heavy list,
+		// with an executor the sweep runs one chunk of lights at a time
+		static constexpr std::size_t chunk_size = 64 * 1024;
+
+		// Outcomes per bulk sampling block
+		static constexpr uint32_t block_size = 256;
+
+		// Tables up to this size are read straight away when filling
+		static constexpr std::size_t cached_bytes = 256 * 1024;
+
+		// The items of every chunk split into lights (at most the mean
+		// weight) from the front of the chunk's range of order and heavies
+		// from the back, both in index order
+		struct lists
+		{
+			std::span<const Ty> weights;
+			double scale;
+			std::vector<uint32_t> order;
+			std::vector<uint32_t> lights;
+
+			std::size_t size() const
+			{
+				return weights.size();
+			}
+			// Weight scaled to a mean of one, in 32.32 fixed point
+			uint64_t q(std::size_t i) const
+			{
+				return uint64_t(double(weights[i]) * scale + 0.5);
+			}
+			// Item at position k of order, size() past the end
+			std::size_t item(std::size_t k) const
+			{
+				return k < size() ? order[k] : size();
+			}
+
+			std::size_t begin(std::size_t c) const
+			{
+				return c * chunk_size;
+			}
+			std::size_t end(std::size_t c) const
+			{
+				return std::min(size(), (c + 1) * chunk_size);
+			}
+
+			// Position of the first light or heavy item of chunk c or a later
+			// one, size() if there is none
+			std::size_t first_light(std::size_t c) const
+			{
+				for (; c < lights.size(); c++)
+					if (lights[c] > 0)
+						return begin(c);
+				return size();
+			}
+			std::size_t first_heavy(std::size_t c) const
+			{
+				for (; c < lights.size(); c++)
+					if (end(c) - begin(c) > lights[c])
+						return end(c) - 1;
+				return size();
+			}
+			std::size_t next_light(std::size_t k) const
+			{
+				const std::size_t c = k / chunk_size;
+				return k + 1 < begin(c) + lights[c] ? k + 1 : first_light(c + 1);
+			}
+			std::size_t next_heavy(std::size_t k) const
+			{
+				const std::size_t c = k / chunk_size;
+				return k > begin(c) + lights[c] ? k - 1 : first_heavy(c + 1);
+			}
+		};
+
+		// Mean weight in the fixed point of lists::q, n of them stay below
+		// 2^64 for n < 2^32
+		static constexpr uint64_t one = uint64_t(1) << 32;
+
+		// Where the sweep stands: positions in order of the next light and
+		// the current heavy item, and the weight the heavy item has left
+		struct cursor
+		{
+			std::size_t light;
+			std::size_t heavy;
+			uint64_t residual;
+		};
+
+		// Light deficits and heavy excesses summed over chunks
+		struct chunk_sums
+		{
+			uint64_t deficit;
+			uint64_t excess;
+		};
+
+	public:
+		// Constructors
+		alias_table() = default;
+		explicit alias_table(std::span<const Ty> weights)
+		{
+			build(weights, nullptr);
+		}
+		template<executor E>
+		alias_table(E& exec, std::span<const Ty> weights)
+		{
+			build(weights, &exec);
+		}
+
+		// Number of outcomes
+		uint32_t size() const
+		{
+			return uint32_t(m_entries.size());
+		}
+		bool empty() const
+		{
+			return m_entries.empty();
+		}
+
+		// Sum of the weights, outcome i has probability weights[i] / total()
+		Ty total() const
+		{
+			return Ty(m_total);
+		}
+
+		std::span<const entry> entries() const
+		{
+			return m_entries;
+		}
+
+		// Index in [0, size()), the table must not be empty
+		template<random_engine Engine>
+		uint32_t sample(Engine& engine) const
+		{
+			using E = std::remove_cvref_t<Engine>;
+			if constexpr (detail::has_bits<E>)
+			{
+				// Bucket from the high half, coin from the low half
+				const uint64_t bits = detail::bits64(engine);
+				return resolve(bucket(engine, uint32_t(bits >> 32)), uint32_t(bits));
+			}
+			else
+			{
+				const uint32_t index = get_random_uniform<uint32_t>(engine, 0, size() - 1);
+				return resolve(index, get_random_uniform<uint32_t>(engine, 0, std::numeric_limits<uint32_t>::max()));
+			}
+		}
+		uint32_t sample() const
+		{
+			return sample(thread_generator64());
+		}
+
+		// out.size() independent draws. Tables past the cache draw a block of
+		// buckets first and prefetch their entries, so the reads overlap.
+		template<random_engine Engine>
+		void fill(Engine& engine, std::span<uint32_t> out) const
+		{
+			using E = std::remove_cvref_t<Engine>;
+			if constexpr (!detail::has_bits<E>)
+			{
+				for (uint32_t& value : out)
+					value = sample(engine);
+			}
+			else
+			{
+				alignas(64) uint32_t bits[2 * block_size];
+				alignas(64) uint32_t buckets[block_size];
+				const bool cached = m_entries.size() * sizeof(entry) <= cached_bytes;
+
+				for (std::size_t begin = 0; begin < out.size(); begin += block_size)
+				{
+					const uint32_t count = uint32_t(std::min<std::size_t>(block_size, out.size() - begin));
+					detail::fill_bits(engine, std::span(bits, 2 * count));
+
+					// Even words are coins, odd words pick buckets
+					if (cached)
+					{
+						for (uint32_t i = 0; i < count; i++)
+							out[begin + i] = resolve(bucket(engine, bits[2 * i + 1]), bits[2 * i]);
+					}
+					else
+					{
+						for (uint32_t i = 0; i < count; i++)
+						{
+							buckets[i] = bucket(engine, bits[2 * i + 1]);
+#if defined(BANAN_SSE)
+							_mm_prefetch(reinterpret_cast<const char*>(m_entries.data() + buckets[i]), _MM_HINT_T0);
+#endif
+						}
+						for (uint32_t i = 0; i < count; i++)
+							out[begin + i] = resolve(buckets[i], bits[2 * i]);
+					}
+				}
+			}
+		}
+		void fill(std::span<uint32_t> out) const
+		{
+			fill(thread_generator64(), out);
+		}
+
+	private:
+		// Bucket by multiply-shift from 32 random bits, redrawn from engine
+		// in the rare case they are rejected
+		template<typename Engine>
+		uint32_t bucket(Engine& engine, uint32_t bits) const
+		{
+			uint64_t m = uint64_t(bits) * size();
+			while (uint32_t(m) < m_reject)
+				m = uint64_t(detail::bits32(engine)) * size();
+			return uint32_t(m >> 32);
+		}
+
+		uint32_t resolve(uint32_t index, uint32_t coin) const
+		{
+			const entry e = m_entries[index];
+			return coin < e.threshold ? index : e.alias;
+		}
+
+		// exec is an executor pointer or nullptr
+		template<typename Exec>
+		void build(std::span<const Ty> weights, Exec exec)
+		{
+			const std::size_t n = weights.size();
+			m_entries.resize(n);
+			m_total = 0;
+			m_reject = n > 0 ? uint32_t(-uint32_t(n)) % uint32_t(n) : 0;
+			if (n == 0)
+				return;
+
+			const std::size_t chunks = (n + chunk_size - 1) / chunk_size;
+			lists items { weights, 0, std::vector<uint32_t>(n), std::vector<uint32_t>(chunks) };
+
+			std::vector<double> totals(chunks);
+			for_chunks(exec, chunks, [&](std::size_t c)
+			{
+				double sum = 0;
+				for (std::size_t i = items.begin(c); i < items.end(c); i++)
+					sum += double(weights[i]);
+				totals[c] = sum;
+			});
+			for (double sum : totals)
+				m_total += sum;
+
+			// Without any weight every item is light and keeps its whole bucket
+			items.scale = m_total > 0 ? double(n) / m_total * double(one) : 0;
+
+			std::vector<chunk_sums> prefix(chunks + 1, { 0, 0 });
+			for_chunks(exec, chunks, [&](std::size_t c)
+			{
+				// Both list ends are written for every item, one of them advances
+				std::size_t light = items.begin(c), heavy = items.end(c) - 1;
+				chunk_sums sums { 0, 0 };
+				for (std::size_t i = items.begin(c); i < items.end(c); i++)
+				{
+					const uint64_t w = items.q(i);
+					const bool is_light = w <= one;
+					items.order[light] = uint32_t(i);
+					items.order[heavy] = uint32_t(i);
+					light += is_light;
+					heavy -= !is_light;
+					const uint64_t kept = std::min(w, one);
+					sums.deficit += one - kept;
+					sums.excess += w - kept;
+				}
+				items.lights[c] = uint32_t(light - items.begin(c));
+				prefix[c + 1] = sums;
+			});
+
+			if constexpr (std::is_same_v<Exec, std::nullptr_t>)
+			{
+				const std::size_t heavy = items.first_heavy(0);
+				sweep(items, { items.first_light(0), heavy, heavy < n ? items.q(items.order[heavy]) : 0 }, n, n);
+			}
+			else
+			{
+				for (std::size_t c = 0; c < chunks; c++)
+				{
+					prefix[c + 1].deficit += prefix[c].deficit;
+					prefix[c + 1].excess += prefix[c].excess;
+				}
+
+				// Before chunk c the lights in front have taken prefix[c].deficit
+				// from the heavy items. The current heavy item is the one whose
+				// share of the excess covers that amount.
+				const auto start = [&](std::size_t c) -> cursor
+				{
+					const uint64_t taken = prefix[c].deficit;
+
+					// Last chunk whose excess before it does not pass taken
+					const auto after = std::upper_bound(prefix.begin(), prefix.begin() + chunks, taken, [](uint64_t t, const chunk_sums& s) { return t < s.excess; });
+
+					// given <= taken throughout, the differences do not wrap
+					uint64_t given = (after - 1)->excess;
+					for (std::size_t heavy = items.first_heavy(std::size_t(after - prefix.begin()) - 1); heavy < n; heavy = items.next_heavy(heavy))
+					{
+						const uint64_t w = items.q(items.order[heavy]);
+						if (w - one > taken - given)
+							return { items.first_light(c), heavy, w - (taken - given) };
+						given += w - one;
+					}
+					return { items.first_light(c), n, 0 };
+				};
+
+				for_chunks(exec, chunks, [&](std::size_t c)
+				{
+					const std::size_t heavy_end = c + 1 < chunks ? items.item(start(c + 1).heavy) : n;
+					sweep(items, start(c), items.end(c), heavy_end);
+				});
+			}
+		}
+
+		// Runs the sweep until the light cursor reaches position light_end
+		// and the heavy cursor item heavy_end. The heavy item heavy_end
+		// belongs to the next chunk, lights still alias it.
+		void sweep(const lists& items, cursor at, std::size_t light_end, std::size_t heavy_end)
+		{
+			const std::size_t n = items.size();
+			for (;;)
+			{
+				if (at.light < light_end && (at.residual > one || items.item(at.heavy) >= heavy_end))
+				{
+					// Light item, the current heavy item fills its bucket.
+					// Without one left the sums were off by rounding.
+					const std::size_t i = items.order[at.light];
+					const uint64_t w = items.q(i);
+					if (at.heavy < n)
+					{
+						set(i, w, items.order[at.heavy]);
+						at.residual -= one - w;
+					}
+					else
+						set(i, one, i);
+					at.light = items.next_light(at.light);
+				}
+				else if (items.item(at.heavy) < heavy_end)
+				{
+					// Heavy item down to its mean, the next one fills the rest
+					const std::size_t j = items.order[at.heavy];
+					const std::size_t next = items.next_heavy(at.heavy);
+					if (next < n)
+					{
+						set(j, at.residual, items.order[next]);
+						at.residual += items.q(items.order[next]) - one;
+					}
+					else
+						set(j, one, j);
+					at.heavy = next;
+				}
+				else
+					break;
+			}
+		}
+
+		// probability is in units of 2^-32, a full bucket keeps the remaining
+		// 2^-32 itself
+		void set(std::size_t bucket, uint64_t probability, std::size_t alias)
+		{
+			if (probability >= one)
+				m_entries[bucket] = { std::numeric_limits<uint32_t>::max(), uint32_t(bucket) };
+			else
+				m_entries[bucket] = { uint32_t(probability), uint32_t(alias) };
+		}
+
+		template<typename Exec, typename Body>
+		static void for_chunks(Exec exec, std::size_t chunks, const Body& body)
+		{
+			const auto run = [&](std::size_t begin, std::size_t end)
+			{
+				for (std::size_t c = begin; c < end; c++)
+					body(c);
+			};
+			if constexpr (std::is_same_v<Exec, std::nullptr_t>)
+				run(0, chunks);
+			else
+				exec->parallel_for(chunks, 1, run);
+		}
+
+	private:
+		std::vector<entry> m_entries;
+		double m_total = 0;
+		uint32_t m_reject = 0;
+	};
+
+}
@@ -0,0 +1,612 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <span>
+#include <type_traits>
+
+#include "mat.h"
+#include "parallel.h"
+#include "quat.h"
+#include "simd.h"
+#include "vec.h"
+#include "vec_packet.h"
+
+// Kernels over contiguous arrays of vectors.
+//
+// Lane-wise kernels (add, scale, lerp, elem_mult) treat the array as one
+// flat run of scalars and stream it through the widest native register.
+// Kernels that combine components (dot, cross, normalize, ...) load blocks
+// of vectors into a vec_packet, do the work in SoA form and store the
+// results back; the remainder is processed one vector at a time.
+//
+// Every input is read before its block is stored, so the output may be
+// the same span as an input:
+//
+//	batch::normalize(points, points);
+//
+// Inputs must hold at least out.size() elements.
+//
+// Every kernel also takes an executor as first argument and splits the
+// arrays into chunks of about 32 KiB of vectors across its threads:
+//
+//	batch::normalize(thread_pool::global(), points, points);
+//
+// The transform kernels apply one 4x4 or 3x4 affine matrix to every
+// vector. Outputs larger than stream_threshold bytes are written with
+// non-temporal stores so they do not evict the inputs from the cache.
+
+namespace Banan::batch
+{
+
+	namespace detail
+	{
+		template<typename Ty, uint32_t N>
+		constexpr bool in_register = simd::has_reg4<Ty> && (N == 3 || N == 4);
+
+		// Vectors held in a simd register transpose four at a time
+		template<typename Ty, uint32_t N>
+		constexpr uint32_t width = in_register<Ty, N> ? 4 : simd::native_widest<Ty>::lanes;
+
+		// Inputs convert from any span or container of vectors, the element
+		// type is deduced from the output span
+		template<typename Ty, uint32_t N>
+		using input = std::type_identity_t<std::span<const vec<Ty, N>>>;
+		template<typename Ty>
+		using quat_input = std::type_identity_t<std::span<const quat<Ty>>>;
+
+		// quat<Ty> has the layout of vec<Ty, 4>, so quaternion arrays go
+		// through the vec4 kernels
+		template<typename Ty>
+		std::span<const vec<Ty, 4>> as_vec(std::span<const quat<Ty>> q)
+		{
+			static_assert(sizeof(quat<Ty>) == sizeof(vec<Ty, 4>));
+			return { reinterpret_cast<const vec<Ty, 4>*>(q.data()), q.size() };
+		}
+		template<typename Ty>
+		std::span<vec<Ty, 4>> as_vec(std::span<quat<Ty>> q)
+		{
+			static_assert(sizeof(quat<Ty>) == sizeof(vec<Ty, 4>));
+			return { reinterpret_cast<vec<Ty, 4>*>(q.data()), q.size() };
+		}
+
+		// Elements per parallel chunk, sized to stay in L1/L2 per input. A
+		// whole number of packets, so chunks split the array where a single
+		// call would and every vector takes the same path whatever the
+		// thread count.
+		template<typename Ty, uint32_t N>
+		constexpr std::size_t grain = std::max<std::size_t>(width<Ty, N>, 32 * 1024 / sizeof(vec<Ty, N>) / width<Ty, N> * width<Ty, N>);
+
+		// Runs kernel(begin, count) over [0, count) on exec
+		template<typename Ty, uint32_t N, executor E, typename Kernel>
+		void split(E& exec, std::size_t count, const Kernel& kernel)
+		{
+			exec.parallel_for(count, grain<Ty, N>, [&](std::size_t begin, std::size_t end) { kernel(begin, end - begin); });
+		}
+
+		// op is called with a native register description followed by one
+		// register per input, native<Ty, 1> handles the tail. Padding lanes
+		// go through op as well and are cleared before the store, so an
+		// infinite scale cannot leave NaN in them.
+		template<typename Ty, uint32_t N, typename Op, typename... In>
+		void transform_flat(std::span<vec<Ty, N>> out, Op op, In... in)
+		{
+			using native = simd::native_widest<Ty>;
+			using scalar = simd::native<Ty, 1>;
+			static_assert(sizeof(vec<Ty, N>) % sizeof(Ty) == 0);
+			constexpr bool padded = in_register<Ty, N> && N == 3;
+			static_assert(!padded || native::lanes % 4 == 0);
+			assert(((in.size() >= out.size()) && ...) && "batch input is shorter than its output");
+
+			const std::size_t count = out.size() * (sizeof(vec<Ty, N>) / sizeof(Ty));
+			Ty* dst = reinterpret_cast<Ty*>(out.data());
+
+			// Every fourth lane is padding, registers start on a vector
+			alignas(64) static constexpr Ty padding[16] = { 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+			const typename native::type keep = native::cmp_eq(native::loadu(padding), native::broadcast(Ty(0)));
+
+			std::size_t i = 0;
+			for (; i + native::lanes <= count; i += native::lanes)
+			{
+				typename native::type result = op(native(), native::loadu(reinterpret_cast<const Ty*>(in.data()) + i)...);
+				if constexpr (padded)
+					result = native::mask_and(result, keep);
+				native::storeu(dst + i, result);
+			}
+			for (; i < count; i++)
+				dst[i] = padded && i % 4 == 3 ? Ty(0) : op(scalar(), reinterpret_cast<const Ty*>(in.data())[i]...);
+		}
+
+		// op is called with vec_packets for full blocks and with vecs for
+		// the remainder, so one generic lambda covers both. Kernels too light
+		// to pay for the transpose pass Transpose = false for vectors that
+		// are already held in a simd register.
+		template<typename Ty, uint32_t N, bool Transpose = true, typename Out, typename Op, typename... In>
+		void transform(std::span<Out> out, Op op, In... in)
+		{
+			constexpr uint32_t Width = width<Ty, N>;
+			using packet_type = vec_packet<Ty, N, Width>;
+			assert(((in.size() >= out.size()) && ...) && "batch input is shorter than its output");
+
+			std::size_t i = 0;
+			if constexpr (Transpose)
+			{
+				for (; i + Width <= out.size(); i += Width)
+					op(packet_type::load(in.data() + i)...).store(out.data() + i);
+			}
+			for (; i < out.size(); i++)
+				out[i] = op(in[i]...);
+		}
+
+		// Outputs at least this large bypass the cache when stored
+		inline constexpr std::size_t stream_threshold = 8 * 1024 * 1024;
+
+		// 3x4 affine matrices get the implied bottom row (0, 0, 0, 1)
+		template<typename Ty, uint32_t R, layout L>
+		constexpr mat<Ty, 4, 4, L> affine(const mat<Ty, R, 4, L>& m)
+		{
+			if constexpr (R == 4)
+				return m;
+			else
+			{
+				mat<Ty, 4, 4, L> result = mat<Ty, 4, 4, L>::identity();
+				for (uint32_t r = 0; r < 3; r++)
+					for (uint32_t c = 0; c < 4; c++)
+						result(r, c) = m(r, c);
+				return result;
+			}
+		}
+
+		// Upper 3x3 of m, with the translation column cleared
+		template<typename Ty, layout L>
+		constexpr mat<Ty, 4, 4, L> linear(const mat<Ty, 4, 4, L>& m)
+		{
+			mat<Ty, 4, 4, L> result;
+			for (uint32_t r = 0; r < 3; r++)
+				for (uint32_t c = 0; c < 3; c++)
+					result(r, c) = m(r, c);
+			return result;
+		}
+
+		// Inverse-transpose of the upper 3x3 of m, maps normals of surfaces
+		// transformed by m
+		template<typename Ty, layout L>
+		constexpr mat<Ty, 4, 4, L> normal_matrix(const mat<Ty, 4, 4, L>& m)
+		{
+			mat<Ty, 3, 3, L> upper;
+			for (uint32_t r = 0; r < 3; r++)
+				for (uint32_t c = 0; c < 3; c++)
+					upper(r, c) = m(r, c);
+			upper = upper.inverse().transpose();
+
+			mat<Ty, 4, 4, L> result;
+			for (uint32_t r = 0; r < 3; r++)
+				for (uint32_t c = 0; c < 3; c++)
+					result(r, c) = upper(r, c);
+			return result;
+		}
+
+		// out = m * (in, 1) for vec3 and m * in for vec4. With Project the
+		// xyz of a vec3 result is divided by the resulting w.
+		template<typename Ty, uint32_t N, bool Project, layout L>
+		void transform_mat(const mat<Ty, 4, 4, L>& m, std::span<const vec<Ty, N>> in, std::span<vec<Ty, N>> out, bool stream)
+		{
+			static_assert(N == 3 || N == 4);
+			static_assert(N == 3 || !Project);
+			assert(in.size() >= out.size() && "batch input is shorter than its output");
+
+			if constexpr (in_register<Ty, N>)
+			{
+				// One column register per input component. vec3 results keep
+				// the 4th lane at zero, so row 3 is dropped.
+				using reg = simd::reg4<Ty>;
+				const Ty w_row = N == 4 ? Ty(1) : Ty(0);
+				typename reg::type col[4];
+				for (uint32_t c = 0; c < 4; c++)
+					col[c] = reg::set(m(0, c), m(1, c), m(2, c), m(3, c) * w_row);
+
+				auto apply = [&](const vec<Ty, N>& v)
+				{
+					typename reg::type xy = reg::add(reg::mul(col[0], reg::broadcast(v.x)), reg::mul(col[1], reg::broadcast(v.y)));
+					typename reg::type zw = reg::mul(col[2], reg::broadcast(v.z));
+					if constexpr (N == 4)
+						zw = reg::add(zw, reg::mul(col[3], reg::broadcast(v.w)));
+					else
+						zw = reg::add(zw, col[3]);
+					typename reg::type result = reg::add(xy, zw);
+					if constexpr (Project)
+						result = reg::div(result, reg::broadcast(m(3, 0) * v.x + m(3, 1) * v.y + m(3, 2) * v.z + m(3, 3)));
+					return result;
+				};
+
+				if (stream)
+				{
+					for (std::size_t i = 0; i < out.size(); i++)
+						reg::stream(out[i].values, apply(in[i]));
+					simd::stream_fence();
+				}
+				else
+				{
+					for (std::size_t i = 0; i < out.size(); i++)
+						out[i] = vec<Ty, N>(apply(in[i]));
+				}
+			}
+			else
+			{
+				// Works on both vec_packets and vecs, the matrix elements
+				// are broadcast to the component type
+				transform<Ty, N>(out, [&m](const auto& v)
+				{
+					using S = std::remove_cvref_t<decltype(v[0])>;
+					auto row = [&](uint32_t r)
+					{
+						S result = S(m(r, 0)) * v[0] + S(m(r, 1)) * v[1] + S(m(r, 2)) * v[2];
+						if constexpr (N == 4)
+							return result + S(m(r, 3)) * v[3];
+						else
+							return result + S(m(r, 3));
+					};
+					using V = std::remove_cvref_t<decltype(v)>;
+					if constexpr (N == 4)
+						return V(row(0), row(1), row(2), row(3));
+					else if constexpr (Project)
+					{
+						S w = row(3);
+						return V(row(0) / w, row(1) / w, row(2) / w);
+					}
+					else
+						return V(row(0), row(1), row(2));
+				}, in);
+			}
+		}
+
+		template<typename Ty, uint32_t N, bool Project, layout L>
+		void transform_mat(const mat<Ty, 4, 4, L>& m, std::span<const vec<Ty, N>> in, std::span<vec<Ty, N>> out)
+		{
+			transform_mat<Ty, N, Project>(m, in, out, out.size_bytes() >= stream_threshold);
+		}
+
+		// Parallel version, the stores stream if the whole output is large
+		template<typename Ty, uint32_t N, bool Project, executor E, layout L>
+		void transform_mat(E& exec, const mat<Ty, 4, 4, L>& m, std::span<const vec<Ty, N>> in, std::span<vec<Ty, N>> out)
+		{
+			const bool stream = out.size_bytes() >= stream_threshold;
+			split<Ty, N>(exec, out.size(), [&](std::size_t begin, std::size_t count) { transform_mat<Ty, N, Project>(m, in.subspan(begin, count), out.subspan(begin, count), stream); });
+		}
+
+		// Taylor series of asin on [-1/2, 1/2], asin(x) = x * sum of
+		// asin[k] * x^2k with asin[k] = (2k)! / (4^k k!^2 (2k + 1)). The
+		// terms kept stay within an ulp of Ty at x = 1/2.
+		template<typename Ty>
+		struct asin_series
+		{
+			static constexpr uint32_t terms = sizeof(Ty) == 4 ? 10 : 24;
+			static constexpr std::array<Ty, terms> asin = []()
+			{
+				std::array<Ty, terms> result {};
+				double central = 1;
+				for (uint32_t k = 0; k < terms; k++)
+				{
+					result[k] = Ty(central / double(2 * k + 1));
+					central *= double(2 * k + 1) / double(2 * k + 2);
+				}
+				return result;
+			}();
+		};
+
+		// acos of lanes in [0, 1]. Above 1/2 the half angle identity
+		// acos(c) = 2 asin(sqrt((1 - c) / 2)) keeps the series argument small.
+		template<typename Ty, uint32_t Width>
+		packet<Ty, Width> acos_unit(const packet<Ty, Width>& c)
+		{
+			using P = packet<Ty, Width>;
+			using series = asin_series<Ty>;
+			const packet_mask<Ty, Width> upper = c > P(Ty(0.5));
+			const P x = select(upper, sqrt((Ty(1) - c) * Ty(0.5)), c);
+			const P x2 = x * x;
+			P s = P(series::asin[series::terms - 1]);
+			for (uint32_t k = series::terms - 1; k-- > 0;)
+				s = series::asin[k] + s * x2;
+			s = s * x;
+			return select(upper, s + s, std::numbers::pi_v<Ty> / Ty(2) - s);
+		}
+
+		// sin of lanes in [0, pi/2], above pi/4 as cos(pi/2 - x)
+		template<typename Ty, uint32_t Width>
+		packet<Ty, Width> sin_quadrant(const packet<Ty, Width>& x)
+		{
+			using P = packet<Ty, Width>;
+			using series = Banan::detail::sincos_series<Ty>;
+			const packet_mask<Ty, Width> upper = x > P(std::numbers::pi_v<Ty> / Ty(4));
+			const P y = select(upper, std::numbers::pi_v<Ty> / Ty(2) - x, x);
+			const P y2 = y * y;
+			P s = P(series::sin[series::terms - 1]);
+			P c = P(series::cos[series::terms - 1]);
+			for (uint32_t k = series::terms - 1; k-- > 0;)
+			{
+				s = series::sin[k] + s * y2;
+				c = series::cos[k] + c * y2;
+			}
+			return select(upper, c, s * y);
+		}
+
+		// slerp of Width quaternion pairs. With t in [0, 1] both sine
+		// arguments stay in [0, theta], and theta in [0, pi/2] once the
+		// shorter arc is chosen.
+		template<typename Ty, uint32_t Width>
+		vec_packet<Ty, 4, Width> slerp_packet(const vec_packet<Ty, 4, Width>& a, const vec_packet<Ty, 4, Width>& b, Ty t)
+		{
+			using P = packet<Ty, Width>;
+			const P d = a.dot(b);
+			const vec_packet<Ty, 4, Width> end = select(d < P(Ty(0)), -b, b);
+			const P cos_theta = min(abs(d), P(Ty(1)));
+			const P theta = acos_unit(cos_theta);
+
+			// sin(theta) from cos(theta), (1 - c) (1 + c) keeps its precision near c = 1
+			const P inv_sin = Ty(1) / sqrt((Ty(1) - cos_theta) * (Ty(1) + cos_theta));
+			const vec_packet<Ty, 4, Width> arc = a * (sin_quadrant((Ty(1) - t) * theta) * inv_sin) + end * (sin_quadrant(t * theta) * inv_sin);
+
+			// sin(theta) vanishes for nearly equal rotations, where nlerp is exact enough
+			return select(cos_theta > P(Ty(0.9995)), Banan::unit(a + (end - a) * t), arc);
+		}
+	}
+
+	/* ####################### Arithmetic ######################## */
+
+	// out = a + b
+	template<typename Ty, uint32_t N>
+	void add(detail::input<Ty, N> a, detail::input<Ty, N> b, std::span<vec<Ty, N>> out)
+	{
+		detail::transform_flat<Ty, N>(out, [](auto r, auto x, auto y) { return decltype(r)::add(x, y); }, a, b);
+	}
+	template<executor E, typename Ty, uint32_t N>
+	void add(E& exec, detail::input<Ty, N> a, detail::input<Ty, N> b, std::span<vec<Ty, N>> out)
+	{
+		detail::split<Ty, N>(exec, out.size(), [&](std::size_t begin, std::size_t count) { add<Ty, N>(a.subspan(begin, count), b.subspan(begin, count), out.subspan(begin, count)); });
+	}
+
+	// out = a * val
+	template<typename Ty, uint32_t N>
+	void scale(detail::input<Ty, N> a, Ty val, std::span<vec<Ty, N>> out)
+	{
+		detail::transform_flat<Ty, N>(out, [val](auto r, auto x) { return decltype(r)::mul(x, decltype(r)::broadcast(val)); }, a);
+	}
+	template<executor E, typename Ty, uint32_t N>
+	void scale(E& exec, detail::input<Ty, N> a, Ty val, std::span<vec<Ty, N>> out)
+	{
+		detail::split<Ty, N>(exec, out.size(), [&](std::size_t begin, std::size_t count) { scale<Ty, N>(a.subspan(begin, count), val, out.subspan(begin, count)); });
+	}
+
+	// out = a + (b - a) * t
+	template<typename Ty, uint32_t N>
+	void lerp(detail::input<Ty, N> a, detail::input<Ty, N> b, Ty t, std::span<vec<Ty, N>> out)
+	{
+		detail::transform_flat<Ty, N>(out, [t](auto r, auto x, auto y) {
+			using R = decltype(r);
+			return R::add(x, R::mul(R::sub(y, x), R::broadcast(t)));
+		}, a, b);
+	}
+	template<executor E, typename Ty, uint32_t N>
+	void lerp(E& exec, detail::input<Ty, N> a, detail::input<Ty, N> b, Ty t, std::span<vec<Ty, N>> out)
+	{
+		detail::split<Ty, N>(exec, out.size(), [&](std::size_t begin, std::size_t count) { lerp<Ty, N>(a.subspan(begin, count), b.subspan(begin, count), t, out.subspan(begin, count)); });
+	}
+
+	// Multiply elements together
+	template<typename Ty, uint32_t N>
+	void elem_mult(detail::input<Ty, N> a, detail::input<Ty, N> b, std::span<vec<Ty, N>> out)
+	{
+		detail::transform_flat<Ty, N>(out, [](auto r, auto x, auto y) { return decltype(r)::mul(x, y); }, a, b);
+	}
+	template<executor E, typename Ty, uint32_t N>
+	void elem_mult(E& exec, detail::input<Ty, N> a, detail::input<Ty, N> b, std::span<vec<Ty, N>> out)
+	{
+		detail::split<Ty, N>(exec, out.size(), [&](std::size_t begin, std::size_t count) { elem_mult<Ty, N>(a.subspan(begin, count), b.subspan(begin, count), out.subspan(begin, count)); });
+	}
+
+	/* ######################## Geometry ######################### */
+
+	// Cross product
+	template<typename Ty>
+	void cross(detail::input<Ty, 3> a, detail::input<Ty, 3> b, std::span<vec<Ty, 3>> out)
+	{
+		detail::transform<Ty, 3, !detail::in_register<Ty, 3>>(out, [](const auto& x, const auto& y) { return x.cross(y); }, a, b);
+	}
+	template<executor E, typename Ty>
+	void cross(E& exec, detail::input<Ty, 3> a, detail::input<Ty, 3> b, std::span<vec<Ty, 3>> out)
+	{
+		detail::split<Ty, 3>(exec, out.size(), [&](std::size_t begin, std::size_t count) { cross<Ty>(a.subspan(begin, count), b.subspan(begin, count), out.subspan(begin, count)); });
+	}
+
+	// Unit vectors, zero length vectors are left untouched
+	template<typename Ty, uint32_t N>
+	void normalize(detail::input<Ty, N> a, std::span<vec<Ty, N>> out)
+	{
+		detail::transform<Ty, N>(out, [](const auto& x) { return Banan::unit(x); }, a);
+	}
+	template<executor E, typename Ty, uint32_t N>
+	void normalize(E& exec, detail::input<Ty, N> a, std::span<vec<Ty, N>> out)
+	{
+		detail::split<Ty, N>(exec, out.size(), [&](std::size_t begin, std::size_t count) { normalize<Ty, N>(a.subspan(begin, count), out.subspan(begin, count)); });
+	}
+
+	// Reflect/Refract vectors about normals
+	template<typename Ty, uint32_t N>
+	void reflect(detail::input<Ty, N> v, detail::input<Ty, N> n, std::span<vec<Ty, N>> out)
+	{
+		detail::transform<Ty, N, !detail::in_register<Ty, N>>(out, [](const auto& x, const auto& y) { return Banan::reflect(x, y); }, v, n);
+	}
+	template<executor E, typename Ty, uint32_t N>
+	void reflect(E& exec, detail::input<Ty, N> v, detail::input<Ty, N> n, std::span<vec<Ty, N>> out)
+	{
+		detail::split<Ty, N>(exec, out.size(), [&](std::size_t begin, std::size_t count) { reflect<Ty, N>(v.subspan(begin, count), n.subspan(begin, count), out.subspan(begin, count)); });
+	}
+	template<typename Ty, uint32_t N>
+	void refract(detail::input<Ty, N> v, detail::input<Ty, N> n, Ty refraction_ratio, std::span<vec<Ty, N>> out)
+	{
+		detail::transform<Ty, N, !detail::in_register<Ty, N>>(out, [refraction_ratio](const auto& x, const auto& y) { return Banan::refract(x, y, refraction_ratio); }, v, n);
+	}
+	template<executor E, typename Ty, uint32_t N>
+	void refract(E& exec, detail::input<Ty, N> v, detail::input<Ty, N> n, Ty refraction_ratio, std::span<vec<Ty, N>> out)
+	{
+		detail::split<Ty, N>(exec, out.size(), [&](std::size_t begin, std::size_t count) { refract<Ty, N>(v.subspan(begin, count), n.subspan(begin, count), refraction_ratio, out.subspan(begin, count)); });
+	}
+
+	/* ####################### Reductions ######################## */
+
+	// out[i] = dot(a[i], b[i]). The output holds scalars, so N cannot be
+	// deduced and is given first: batch::dot<3>(a, b, out).
+	template<uint32_t N, typename Ty>
+	void dot(detail::input<Ty, N> a, detail::input<Ty, N> b, std::span<Ty> out)
+	{
+		detail::transform<Ty, N, !detail::in_register<Ty, N>>(out, [](const auto& x, const auto& y) { return x.dot(y); }, a, b);
+	}
+	template<uint32_t N, executor E, typename Ty>
+	void dot(E& exec, detail::input<Ty, N> a, detail::input<Ty, N> b, std::span<Ty> out)
+	{
+		detail::split<Ty, N>(exec, out.size(), [&](std::size_t begin, std::size_t count) { dot<N, Ty>(a.subspan(begin, count), b.subspan(begin, count), out.subspan(begin, count)); });
+	}
+
+	// out[i] = a[i].magSq(), N is given first as for dot
+	template<uint32_t N, typename Ty>
+	void magSq(detail::input<Ty, N> a, std::span<Ty> out)
+	{
+		detail::transform<Ty, N>(out, [](const auto& x) { return x.magSq(); }, a);
+	}
+	template<uint32_t N, executor E, typename Ty>
+	void magSq(E& exec, detail::input<Ty, N> a, std::span<Ty> out)
+	{
+		detail::split<Ty, N>(exec, out.size(), [&](std::size_t begin, std::size_t count) { magSq<N, Ty>(a.subspan(begin, count), out.subspan(begin, count)); });
+	}
+
+	/* ####################### Transforms ######################## */
+
+	// out = m * (p, 1), the bottom row of m is ignored
+	template<typename Ty, uint32_t R, layout L> requires (R == 3 || R == 4)
+	void transform_points(const mat<Ty, R, 4, L>& m, detail::input<Ty, 3> in, std::span<vec<Ty, 3>> out)
+	{
+		detail::transform_mat<Ty, 3, false>(detail::affine(m), in, out);
+	}
+	template<executor E, typename Ty, uint32_t R, layout L> requires (R == 3 || R == 4)
+	void transform_points(E& exec, const mat<Ty, R, 4, L>& m, detail::input<Ty, 3> in, std::span<vec<Ty, 3>> out)
+	{
+		detail::transform_mat<Ty, 3, false>(exec, detail::affine(m), in, out);
+	}
+
+	// out = m * (p, 1) divided by its w, for projection matrices
+	template<typename Ty, layout L>
+	void project_points(const mat<Ty, 4, 4, L>& m, detail::input<Ty, 3> in, std::span<vec<Ty, 3>> out)
+	{
+		detail::transform_mat<Ty, 3, true>(m, in, out);
+	}
+	template<executor E, typename Ty, layout L>
+	void project_points(E& exec, const mat<Ty, 4, 4, L>& m, detail::input<Ty, 3> in, std::span<vec<Ty, 3>> out)
+	{
+		detail::transform_mat<Ty, 3, true>(exec, m, in, out);
+	}
+
+	// out = m * (d, 0), translation does not apply to directions
+	template<typename Ty, uint32_t R, layout L> requires (R == 3 || R == 4)
+	void transform_directions(const mat<Ty, R, 4, L>& m, detail::input<Ty, 3> in, std::span<vec<Ty, 3>> out)
+	{
+		detail::transform_mat<Ty, 3, false>(detail::linear(detail::affine(m)), in, out);
+	}
+	template<executor E, typename Ty, uint32_t R, layout L> requires (R == 3 || R == 4)
+	void transform_directions(E& exec, const mat<Ty, R, 4, L>& m, detail::input<Ty, 3> in, std::span<vec<Ty, 3>> out)
+	{
+		detail::transform_mat<Ty, 3, false>(exec, detail::linear(detail::affine(m)), in, out);
+	}
+
+	// Normals by the inverse-transpose of the upper 3x3 of m. Results are
+	// not renormalized, non-uniform scales change their length.
+	template<typename Ty, uint32_t R, layout L> requires (R == 3 || R == 4)
+	void transform_normals(const mat<Ty, R, 4, L>& m, detail::input<Ty, 3> in, std::span<vec<Ty, 3>> out)
+	{
+		detail::transform_mat<Ty, 3, false>(detail::normal_matrix(detail::affine(m)), in, out);
+	}
+	template<executor E, typename Ty, uint32_t R, layout L> requires (R == 3 || R == 4)
+	void transform_normals(E& exec, const mat<Ty, R, 4, L>& m, detail::input<Ty, 3> in, std::span<vec<Ty, 3>> out)
+	{
+		detail::transform_mat<Ty, 3, false>(exec, detail::normal_matrix(detail::affine(m)), in, out);
+	}
+
+	// out = m * v for homogeneous vectors
+	template<typename Ty, uint32_t R, layout L> requires (R == 3 || R == 4)
+	void transform(const mat<Ty, R, 4, L>& m, detail::input<Ty, 4> in, std::span<vec<Ty, 4>> out)
+	{
+		detail::transform_mat<Ty, 4, false>(detail::affine(m), in, out);
+	}
+	template<executor E, typename Ty, uint32_t R, layout L> requires (R == 3 || R == 4)
+	void transform(E& exec, const mat<Ty, R, 4, L>& m, detail::input<Ty, 4> in, std::span<vec<Ty, 4>> out)
+	{
+		detail::transform_mat<Ty, 4, false>(exec, detail::affine(m), in, out);
+	}
+
+	/* ######################## Rotations ######################## */
+
+	// out = q.rotate(v), through the rotation matrix of q
+	template<typename Ty>
+	void rotate(const quat<Ty>& q, detail::input<Ty, 3> in, std::span<vec<Ty, 3>> out)
+	{
+		detail::transform_mat<Ty, 3, false>(q.to_mat4(), in, out);
+	}
+	template<executor E, typename Ty>
+	void rotate(E& exec, const quat<Ty>& q, detail::input<Ty, 3> in, std::span<vec<Ty, 3>> out)
+	{
+		detail::transform_mat<Ty, 3, false>(exec, q.to_mat4(), in, out);
+	}
+
+	// out = nlerp(a, b, t)
+	template<typename Ty>
+	void nlerp(detail::quat_input<Ty> a, detail::quat_input<Ty> b, Ty t, std::span<quat<Ty>> out)
+	{
+		detail::transform<Ty, 4>(detail::as_vec(out), [t](const auto& x, const auto& y)
+		{
+			using S = decltype(x.dot(y));
+			S d = x.dot(y);
+			S sign;
+			if constexpr (std::is_same_v<S, Ty>)
+				sign = d < Ty(0) ? Ty(-1) : Ty(1);
+			else
+				sign = select(d < S(Ty(0)), S(Ty(-1)), S(Ty(1)));
+			return Banan::unit(x + (y * sign - x) * t);
+		}, detail::as_vec(a), detail::as_vec(b));
+	}
+	template<executor E, typename Ty>
+	void nlerp(E& exec, detail::quat_input<Ty> a, detail::quat_input<Ty> b, Ty t, std::span<quat<Ty>> out)
+	{
+		detail::split<Ty, 4>(exec, out.size(), [&](std::size_t begin, std::size_t count) { nlerp<Ty>(a.subspan(begin, count), b.subspan(begin, count), t, out.subspan(begin, count)); });
+	}
+
+	// out = slerp(a, b, t). For t in [0, 1] blocks of quaternions take a
+	// polynomial acos and sin in SoA form, within a few ulp of the
+	// quaternion slerp. Other t extrapolate past the arc and, like the
+	// remainder, go through the quaternion slerp.
+	template<typename Ty>
+	void slerp(detail::quat_input<Ty> a, detail::quat_input<Ty> b, Ty t, std::span<quat<Ty>> out)
+	{
+		if (!(t >= Ty(0) && t <= Ty(1)))
+		{
+			for (std::size_t i = 0; i < out.size(); i++)
+				out[i] = Banan::slerp(a[i], b[i], t);
+			return;
+		}
+		detail::transform<Ty, 4>(detail::as_vec(out), [t](const auto& x, const auto& y)
+		{
+			if constexpr (std::is_same_v<std::remove_cvref_t<decltype(x)>, vec<Ty, 4>>)
+				return Banan::slerp(quat<Ty>(x), quat<Ty>(y), t).xyzw;
+			else
+				return detail::slerp_packet(x, y, t);
+		}, detail::as_vec(a), detail::as_vec(b));
+	}
+	template<executor E, typename Ty>
+	void slerp(E& exec, detail::quat_input<Ty> a, detail::quat_input<Ty> b, Ty t, std::span<quat<Ty>> out)
+	{
+		detail::split<Ty, 4>(exec, out.size(), [&](std::size_t begin, std::size_t count) { slerp<Ty>(a.subspan(begin, count), b.subspan(begin, count), t, out.subspan(begin, count)); });
+	}
+
+}
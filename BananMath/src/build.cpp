@@ -1,2 +1,12 @@
+#include "alias_table.h"
+#include "batch.h"
+#include "mat.h"
+#include "parallel.h"
+#include "quat.h"
+#include "random.h"
+#include "random_lanes.h"
+#include "sampling.h"
+#include "simd.h"
 #include "vec.h"
-#include "random.h"
\ No newline at end of file
+#include "vec_expr.h"
+#include "vec_packet.h"
\ No newline at end of file
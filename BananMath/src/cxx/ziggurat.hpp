@@ -28,6 +28,8 @@
 #ifndef INCLUDED_ZIGGURAT_HPP
 #define INCLUDED_ZIGGURAT_HPP
 
+#include <array>
+#include <bit>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
@@ -68,7 +70,7 @@ namespace cxx
         template<std::size_t N, typename URNG>
         inline std::uint64_t generate_bits(URNG& random)
         {
-            constexpr std::uint64_t mask = (std::uint64_t(1) << N) - 1;
+            constexpr std::uint64_t mask = N < 64 ? (std::uint64_t(1) << (N % 64)) - 1 : ~std::uint64_t(0);
 
             if (URNG::min() == 0 && URNG::max() >= mask && is_pow2m1(URNG::max())) {
                 return std::uint64_t(random()) & mask;
@@ -97,21 +99,270 @@ namespace cxx
             return std::exp(T(-0.5) * x * x);
         }
 
-        // normal_ziggurat holds a pre-computed ziggurat table.
+        // exponential returns exp(-x).
         template<typename T>
-        struct normal_ziggurat
+        inline T exponential(T x)
+        {
+            return std::exp(-x);
+        }
+
+        // bit_count is the number of random bits one call of URNG produces.
+        template<typename URNG>
+        inline constexpr std::size_t bit_count()
+        {
+            return log2(URNG::max() - URNG::min()) + (is_pow2m1(URNG::max() - URNG::min()) ? 1 : 0);
+        }
+
+        // Constant-evaluable exp, log and sqrt for building the tables at
+        // compile time. They are accurate to a few ulps for the arguments
+        // used here (normal numbers, exp arguments above -700).
+        inline constexpr double ln2 = 0.693147180559945309417232121458;
+
+        // Cody-Waite split of ln2: ln2_hi has its low bits clear, so k ln2_hi
+        // is exact for |k| < 2^11 and the reduction below keeps full precision
+        // for large |x|.
+        inline constexpr double ln2_hi = 6.93147180369123816490e-01;
+        inline constexpr double ln2_lo = 1.90821492927058770002e-10;
+
+        inline constexpr double const_exp(double x)
+        {
+            // exp(x) = 2^k exp(t) with |t| <= ln2 / 2.
+            std::int64_t const k = std::int64_t(x / ln2 + (x < 0 ? -0.5 : 0.5));
+            double const t = (x - double(k) * ln2_hi) - double(k) * ln2_lo;
+            double term = 1, sum = 1;
+            for (int i = 1; i < 20; i++) {
+                term *= t / i;
+                sum += term;
+            }
+            return sum * std::bit_cast<double>(std::uint64_t(k + 1023) << 52);
+        }
+
+        inline constexpr double const_log(double x)
+        {
+            // log(x) = e ln2 + 2 atanh((m - 1) / (m + 1)) with x = m 2^e and
+            // m in [sqrt(1/2), sqrt(2)].
+            std::uint64_t const bits = std::bit_cast<std::uint64_t>(x);
+            int e = int((bits >> 52) & 0x7FF) - 1023;
+            double m = std::bit_cast<double>((bits & 0xFFFFFFFFFFFFFull) | 0x3FF0000000000000ull);
+            if (m > 1.41421356237309504880) {
+                m /= 2;
+                e++;
+            }
+            double const z = (m - 1) / (m + 1);
+            double term = z, sum = 0;
+            for (int i = 1; i < 24; i += 2) {
+                sum += term / i;
+                term *= z * z;
+            }
+            return e * ln2_hi + (2 * sum + e * ln2_lo);
+        }
+
+        inline constexpr double const_sqrt(double x)
+        {
+            if (x <= 0) {
+                return 0;
+            }
+            // Halving the exponent gives a start within a factor of 2.
+            double r = std::bit_cast<double>((std::bit_cast<std::uint64_t>(x) >> 1) + (std::uint64_t(1023) << 51));
+            for (int i = 0; i < 6; i++) {
+                r = (r + x / r) / 2;
+            }
+            return r;
+        }
+
+        // normal_density describes exp(-x^2/2) for make_ziggurat.
+        struct normal_density
+        {
+            static constexpr double f(double x)
+            {
+                return const_exp(-0.5 * x * x);
+            }
+
+            static constexpr double inverse(double y)
+            {
+                return const_sqrt(-2 * const_log(y));
+            }
+
+            // Area beyond r, from the continued fraction of Mills' ratio.
+            static constexpr double tail_area(double r)
+            {
+                double t = r;
+                for (int k = 200; k > 0; k--) {
+                    t = r + k / t;
+                }
+                return f(r) / t;
+            }
+        };
+
+        // exponential_density describes exp(-x) for make_ziggurat.
+        struct exponential_density
+        {
+            static constexpr double f(double x)
+            {
+                return const_exp(-x);
+            }
+
+            static constexpr double inverse(double y)
+            {
+                return -const_log(y);
+            }
+
+            static constexpr double tail_area(double r)
+            {
+                return f(r);
+            }
+        };
+
+        // ziggurat_table holds the layer edges and the density at each edge.
+        template<std::size_t Layers>
+        struct ziggurat_table
+        {
+            std::array<double, Layers + 1> edges{};
+            std::array<double, Layers + 1> densities{};
+        };
+
+        // make_ziggurat computes a table of Layers layers of equal area v
+        // under the density. The base layer is the rectangle [0, r] x
+        // [0, f(r)] plus the tail beyond r, layer i > 0 spans heights
+        // [f(x_i), f(x_i+1)] with x_i (f(x_i+1) - f(x_i)) = v. edges[0] is
+        // v / f(r), the width of a rectangle with the base layer's area,
+        // and the top edge is 0. r is solved for so that the stacked layers
+        // end exactly at f(0) = 1.
+        template<std::size_t Layers, typename Density>
+        constexpr ziggurat_table<Layers> make_ziggurat()
+        {
+            auto area = [](double r) {
+                return r * Density::f(r) + Density::tail_area(r);
+            };
+
+            // overshoot of the stacked layers past f(0), decreasing in r.
+            auto overshoot = [&](double r) {
+                double const v = area(r);
+                double x = r;
+                double y = Density::f(r);
+                for (std::size_t i = 1; i < Layers - 1; i++) {
+                    y += v / x;
+                    if (y >= 1) {
+                        return double(Layers - i);
+                    }
+                    x = Density::inverse(y);
+                }
+                return y + v / x - 1;
+            };
+
+            // Bisection down to a bracket where overshoot is smooth, then
+            // regula falsi with the Illinois modification.
+            double a = 1, b = 16;
+            double fa = overshoot(a), fb = overshoot(b);
+            for (int i = 0; i < 16; i++) {
+                double const c = (a + b) / 2;
+                double const fc = overshoot(c);
+                if (fc > 0) {
+                    a = c;
+                    fa = fc;
+                }
+                else {
+                    b = c;
+                    fb = fc;
+                }
+            }
+            for (int i = 0, side = 0; i < 100 && fa != fb; i++) {
+                double const c = (a * fb - b * fa) / (fb - fa);
+                if (c <= a || c >= b) {
+                    break;
+                }
+                double const fc = overshoot(c);
+                if (fc == 0) {
+                    a = b = c;
+                    break;
+                }
+                if (fc > 0) {
+                    a = c;
+                    fa = fc;
+                    if (side == 1) {
+                        fb /= 2;
+                    }
+                    side = 1;
+                }
+                else {
+                    b = c;
+                    fb = fc;
+                    if (side == -1) {
+                        fa /= 2;
+                    }
+                    side = -1;
+                }
+            }
+
+            // The endpoint closer to the root, the other one can stay far
+            // off once regula falsi converges from one side.
+            double const r = (fa < -fb) ? a : b;
+            double const v = area(r);
+
+            ziggurat_table<Layers> table;
+            table.edges[0] = v / Density::f(r);
+            table.edges[1] = r;
+            table.densities[0] = Density::f(table.edges[0]);
+            table.densities[1] = Density::f(r);
+            for (std::size_t i = 1; i < Layers - 1; i++) {
+                table.densities[i + 1] = table.densities[i] + v / table.edges[i];
+                table.edges[i + 1] = Density::inverse(table.densities[i + 1]);
+            }
+            table.edges[Layers] = 0;
+            table.densities[Layers] = 1;
+            return table;
+        }
+
+        // ziggurat_constants holds the computed table, once per density and
+        // layer count.
+        template<std::size_t Layers, typename Density>
+        struct ziggurat_constants
+        {
+            static_assert(Layers >= 4 && is_pow2m1(Layers - 1), "Layers must be a power of two");
+
+            static constexpr ziggurat_table<Layers> table = make_ziggurat<Layers, Density>();
+        };
+
+        // ziggurat_tables holds the table converted to T.
+        template<typename T, std::size_t Layers, typename Density>
+        struct ziggurat_tables
+        {
+
+            static constexpr std::array<T, Layers + 1> convert(std::array<double, Layers + 1> const& values)
+            {
+                std::array<T, Layers + 1> result{};
+                for (std::size_t i = 0; i <= Layers; i++) {
+                    result[i] = T(values[i]);
+                }
+                return result;
+            }
+
+            static constexpr std::array<T, Layers + 1> edges = convert(ziggurat_constants<Layers, Density>::table.edges);
+            static constexpr std::array<T, Layers + 1> densities = convert(ziggurat_constants<Layers, Density>::table.densities);
+        };
+
+        // normal_ziggurat holds the ziggurat table of the normal density.
+        template<typename T, std::size_t Layers = 128>
+        struct normal_ziggurat : ziggurat_tables<T, Layers, normal_density>
+        {
+        };
+
+        // exponential_ziggurat holds the ziggurat table of the exponential
+        // density.
+        template<typename T, std::size_t Layers = 128>
+        struct exponential_ziggurat : ziggurat_tables<T, Layers, exponential_density>
         {
-            static T const edges[0x81];
         };
     }
 
     // ziggurat_normal_distribution generates normal random numbers using the fast
-    // ziggurat algorithm.
-    template<typename T>
+    // ziggurat algorithm with Layers layers (a power of two). More layers need
+    // fewer slow-path rejections at the cost of a larger table.
+    template<typename T, std::size_t Layers = 128>
     class ziggurat_normal_distribution
     {
         // Pull in the ziggurat table to use.
-        using ziggurat = ziggurat_detail::normal_ziggurat<T>;
+        using ziggurat = ziggurat_detail::normal_ziggurat<T, Layers>;
 
     public:
         // result_type is an alias of T.
@@ -279,17 +530,20 @@ namespace cxx
 
     private:
         // sample generates a standard normal number.
+        // The low bits of a draw pick the layer, the next one the sign and
+        // the rest the position in the layer, up to the precision of T.
         template<typename URNG>
         inline T sample(URNG& random) const
         {
-            constexpr std::size_t bit_count = ziggurat_detail::log2(URNG::max() - URNG::min());
+            constexpr std::size_t bit_count = ziggurat_detail::bit_count<URNG>();
+            constexpr std::size_t layer_bits = ziggurat_detail::log2(Layers);
 
             for (;;)
             {
                 auto const bits = ziggurat_detail::generate_bits<bit_count>(random);
-                auto const uniform = ziggurat_detail::canonicalize<bit_count, T>(bits);
-                auto const layer = std::size_t(bits & 0x7F);
-                auto const sign = T((bits & 0x80) ? 1 : -1);
+                auto const uniform = ziggurat_detail::canonicalize<bit_count - layer_bits - 1, T>(bits >> (layer_bits + 1));
+                auto const layer = std::size_t(bits & (Layers - 1));
+                auto const sign = T((bits >> layer_bits & 1) ? 1 : -1);
 
                 auto const lower_edge = ziggurat::edges[layer];
                 auto const upper_edge = ziggurat::edges[layer + 1];
@@ -304,7 +558,7 @@ namespace cxx
                     return sign * sample_from_tail(random);
                 }
 
-                if (check_accept(random, lower_edge, upper_edge, x)) {
+                if (check_accept(random, layer, x)) {
                     return sign * x;
                 }
             }
@@ -329,12 +583,12 @@ namespace cxx
 
         template<typename URNG>
         ZIGGURAT_NOINLINE
-            bool check_accept(URNG& random, T lower_edge, T upper_edge, T x) const
+            bool check_accept(URNG& random, std::size_t layer, T x) const
         {
             // Rejection sampling from the interval [upper_edge, lower_edge].
             std::uniform_real_distribution<T> uniform(
-                ziggurat_detail::gaussian(lower_edge),
-                ziggurat_detail::gaussian(upper_edge)
+                ziggurat::densities[layer],
+                ziggurat::densities[layer + 1]
             );
             return uniform(random) < ziggurat_detail::gaussian(x);
         }
@@ -345,85 +599,307 @@ namespace cxx
 
     // Equality comparison d1 == d2 compares the equality of distribution
     // parameters.
-    template<typename T>
+    template<typename T, std::size_t Layers>
     bool operator==(
-        ziggurat_normal_distribution<T> const& d1,
-        ziggurat_normal_distribution<T> const& d2
+        ziggurat_normal_distribution<T, Layers> const& d1,
+        ziggurat_normal_distribution<T, Layers> const& d2
         )
     {
         return d1.param() == d2.param();
     }
 
-    template<typename T>
+    template<typename T, std::size_t Layers>
     bool operator!=(
-        ziggurat_normal_distribution<T> const& d1,
-        ziggurat_normal_distribution<T> const& d2
+        ziggurat_normal_distribution<T, Layers> const& d1,
+        ziggurat_normal_distribution<T, Layers> const& d2
         )
     {
         return !(d1 == d2);
     }
 
     // Stream output operator writes mean and stddev parameters to a stream.
-    template<typename Char, typename Tr, typename T>
+    template<typename Char, typename Tr, typename T, std::size_t Layers>
     std::basic_ostream<Char, Tr>& operator<<(
         std::basic_ostream<Char, Tr>& os,
-        ziggurat_normal_distribution<T> const& dist
+        ziggurat_normal_distribution<T, Layers> const& dist
         )
     {
         return os << dist.param();
     }
 
     // Stream input operator reads mean and stddev parameters from a stream.
-    template<typename Char, typename Tr, typename T>
+    template<typename Char, typename Tr, typename T, std::size_t Layers>
     std::basic_istream<Char, Tr>& operator>>(
         std::basic_istream<Char, Tr>& is,
-        ziggurat_normal_distribution<T>& dist
+        ziggurat_normal_distribution<T, Layers>& dist
         )
     {
-        typename ziggurat_normal_distribution<T>::param_type param;
+        typename ziggurat_normal_distribution<T, Layers>::param_type param;
         if (is >> param) {
             dist.param(param);
         }
         return is;
     }
 
-    // Pre-computed ziggurat table.
-    template<typename T>
-    T const ziggurat_detail::normal_ziggurat<T>::edges[] = {
-        T(3.71308624674036292), T(3.44261985589665231), T(3.22308498457861869), T(3.083228858214214),
-        T(2.97869625264501714), T(2.89434400701867078), T(2.82312535054596658), T(2.76116937238415394),
-        T(2.70611357311872291), T(2.65640641125819288), T(2.61097224842861353), T(2.56903362592163953),
-        T(2.53000967238546703), T(2.49345452209195129), T(2.4590181774083506), T(2.42642064553021219),
-        T(2.395434278007468), T(2.36587137011398818), T(2.3375752413355313), T(2.31041368369500244),
-        T(2.28427405967365704), T(2.25905957386533007), T(2.23468639558705728), T(2.21108140887472837),
-        T(2.18818043207202084), T(2.16592679374484121), T(2.14427018235626177), T(2.1231657086697906),
-        T(2.10257313518499966), T(2.08245623798772517), T(2.0627822745039639), T(2.04352153665067027),
-        T(2.02464697337293442), T(2.00613386995896725), T(1.98795957412306135), T(1.97010326084971399),
-        T(1.9525457295488895), T(1.93526922829190084), T(1.91825730085973256), T(1.90149465310031829),
-        T(1.88496703570286983), T(1.86866114098954261), T(1.85256451172308778), T(1.83666546025338473),
-        T(1.82095299659100562), T(1.80541676421404929), T(1.79004698259461947), T(1.77483439558076972),
-        T(1.7597702248942324), T(1.74484612810837714), T(1.73005416055824424), T(1.71538674070811714),
-        T(1.70083661856430157), T(1.68639684677348689), T(1.67206075409185284), T(1.65782192094820813),
-        T(1.64367415685698326), T(1.62961147946467899), T(1.61562809503713356), T(1.6017183802152779),
-        T(1.5878768648844015), T(1.57409821601675048), T(1.56037722235984133), T(1.54670877985350419),
-        T(1.53308787766755672), T(1.51950958475937159), T(1.50596903685655104), T(1.49246142377461632),
-        T(1.47898197698309875), T(1.46552595733579549), T(1.45208864288221728), T(1.43866531667746189),
-        T(1.4252512545068623), T(1.41184171243976109), T(1.39843191412360701), T(1.38501703772514939),
-        T(1.3715922024197329), T(1.35815245432242371), T(1.3446927517457139), T(1.33120794965767741),
-        T(1.31769278320134386), T(1.30414185012042227), T(1.29054959191787399), T(1.27691027355170061),
-        T(1.26321796144602927), T(1.24946649956433475), T(1.23564948325448198), T(1.22176023053096339),
-        T(1.20779175040675857), T(1.19373670782377306), T(1.17958738465446178), T(1.16533563615504776),
-        T(1.1509728421389771), T(1.1364898520030764), T(1.12187692257225491), T(1.1071236475235362),
-        T(1.09221887689655461), T(1.07715062488193869), T(1.06190596368362034), T(1.0464709007525812),
-        T(1.03083023605645652), T(1.01496739523930057), T(0.998864233480644681), T(0.982500803502761477),
-        T(0.965855079388131865), T(0.948902625497913155), T(0.931616196601354973), T(0.913965251008802881),
-        T(0.895915352566239664), T(0.877427429097716982), T(0.858456843178052043), T(0.838952214281208697),
-        T(0.818853906683319033), T(0.798092060626276134), T(0.776583987876149906), T(0.754230664434511699),
-        T(0.730911910621882877), T(0.706479611313609812), T(0.680747918645906114), T(0.653478638715044413),
-        T(0.62435859730909038), T(0.592962942441980445), T(0.558692178375520654), T(0.520656038725148096),
-        T(0.477437837253791464), T(0.426547986303309479), T(0.362871431028424229), T(0.272320864704672982),
-        T(8.56006539842194211e-08)
+    // ziggurat_exponential_distribution generates exponential random numbers
+    // using the fast ziggurat algorithm. The table has the same layout as the
+    // normal one, so the same bits pick the layer and the position within it.
+    template<typename T, std::size_t Layers = 128>
+    class ziggurat_exponential_distribution
+    {
+        // Pull in the ziggurat table to use.
+        using ziggurat = ziggurat_detail::exponential_ziggurat<T, Layers>;
+
+    public:
+        // result_type is an alias of T.
+        using result_type = T;
+
+        // param_type holds distribution parameters.
+        struct param_type
+        {
+            using distribution_type = ziggurat_exponential_distribution;
+
+            // Default constructor initializes lambda to 1.
+            param_type() = default;
+
+            // Single-parameter constructor initializes lambda to given value.
+            explicit param_type(result_type lambda)
+                : lambda_{ lambda }
+            {
+            }
+
+            // lambda returns the rate parameter.
+            inline result_type lambda() const
+            {
+                return lambda_;
+            }
+
+            // Equality comparison p1 == p2 returns true if and only if the
+            // lambda parameters are the same for p1 and p2.
+            friend bool operator==(param_type const& p1, param_type const& p2)
+            {
+                return p1.lambda_ == p2.lambda_;
+            }
+
+            friend bool operator!=(param_type const& p1, param_type const& p2)
+            {
+                return !(p1 == p2);
+            }
+
+            // Stream output writes lambda to a stream.
+            template<typename Char, typename Tr>
+            friend std::basic_ostream<Char, Tr>& operator<<(
+                std::basic_ostream<Char, Tr>& os,
+                param_type const& param
+                )
+            {
+                using sentry_type = typename std::basic_ostream<Char, Tr>::sentry;
+
+                if (sentry_type sentry{ os }) {
+                    os << param.lambda_;
+                }
+
+                return os;
+            }
+
+            // Stream input reads lambda from a stream.
+            template<typename Char, typename Tr>
+            friend std::basic_istream<Char, Tr>& operator>>(
+                std::basic_istream<Char, Tr>& is,
+                param_type& param
+                )
+            {
+                using sentry_type = typename std::basic_istream<Char, Tr>::sentry;
+
+                if (sentry_type sentry{ is }) {
+                    param_type tmp;
+                    if (is >> tmp.lambda_) {
+                        param = tmp;
+                    }
+                }
+
+                return is;
+            }
+
+        private:
+            result_type lambda_ = 1;
+        };
+
+        // Default constructor creates an exponential distribution with
+        // lambda = 1.
+        ziggurat_exponential_distribution() = default;
+
+        // This constructor creates an exponential distribution with given
+        // lambda.
+        explicit ziggurat_exponential_distribution(result_type lambda)
+            : param_{ lambda }
+        {
+        }
+
+        // This constructor creates an exponential distribution having given
+        // parameters.
+        explicit ziggurat_exponential_distribution(param_type const& param)
+            : param_{ param }
+        {
+        }
+
+        // reset does nothing; this is a RandomNumberDistribution requirement.
+        void reset()
+        {
+        }
+
+        // Invoking a distribution with a random number engine returns a newly
+        // generated exponential random number with the preconfigured
+        // parameters.
+        template<typename URNG>
+        inline T operator()(URNG& random)
+        {
+            return sample(random) / param_.lambda();
+        }
+
+        // Invoking a distribution with a random number engine and a parameter
+        // object returns a newly generated exponential random number with
+        // given parameters.
+        template<typename URNG>
+        inline T operator()(URNG& random, param_type const& param)
+        {
+            return sample(random) / param.lambda();
+        }
+
+        // lambda returns the rate parameter of this distribution.
+        result_type lambda() const
+        {
+            return param_.lambda();
+        }
+
+        // param returns the parameters of this distribution as a param_type.
+        param_type param() const
+        {
+            return param_;
+        }
+
+        // param sets the parameters of this distribution.
+        void param(param_type const& param)
+        {
+            param_ = param;
+        }
+
+        // min returns zero.
+        result_type min() const
+        {
+            return 0;
+        }
+
+        // max returns +infinity.
+        result_type max() const
+        {
+            return std::numeric_limits<result_type>::infinity();
+        }
+
+    private:
+        // sample generates a standard exponential number.
+        // The low bits of a draw pick the layer and the rest the position
+        // in the layer, up to the precision of T.
+        template<typename URNG>
+        inline T sample(URNG& random) const
+        {
+            constexpr std::size_t bit_count = ziggurat_detail::bit_count<URNG>();
+            constexpr std::size_t layer_bits = ziggurat_detail::log2(Layers);
+
+            for (;;)
+            {
+                auto const bits = ziggurat_detail::generate_bits<bit_count>(random);
+                auto const uniform = ziggurat_detail::canonicalize<bit_count - layer_bits, T>(bits >> layer_bits);
+                auto const layer = std::size_t(bits & (Layers - 1));
+
+                auto const lower_edge = ziggurat::edges[layer];
+                auto const upper_edge = ziggurat::edges[layer + 1];
+
+                auto const x = uniform * lower_edge;
+
+                if (ZIGGURAT_LIKELY(x < upper_edge)) {
+                    return x;
+                }
+
+                if (layer == 0) {
+                    return sample_from_tail(random);
+                }
+
+                if (check_accept(random, layer, x)) {
+                    return x;
+                }
+            }
+        }
+
+        template<typename URNG>
+        ZIGGURAT_NOINLINE
+            T sample_from_tail(URNG& random) const
+        {
+            // The exponential is memoryless: the tail beyond the base layer
+            // is the same distribution shifted by the tail edge.
+            std::uniform_real_distribution<T> uniform;
+            return ziggurat::edges[1] - std::log(1 - uniform(random));
+        }
+
+        template<typename URNG>
+        ZIGGURAT_NOINLINE
+            bool check_accept(URNG& random, std::size_t layer, T x) const
+        {
+            // Rejection sampling from the interval [upper_edge, lower_edge].
+            std::uniform_real_distribution<T> uniform(
+                ziggurat::densities[layer],
+                ziggurat::densities[layer + 1]
+            );
+            return uniform(random) < ziggurat_detail::exponential(x);
+        }
+
+    private:
+        param_type param_;
     };
+
+    // Equality comparison d1 == d2 compares the equality of distribution
+    // parameters.
+    template<typename T, std::size_t Layers>
+    bool operator==(
+        ziggurat_exponential_distribution<T, Layers> const& d1,
+        ziggurat_exponential_distribution<T, Layers> const& d2
+        )
+    {
+        return d1.param() == d2.param();
+    }
+
+    template<typename T, std::size_t Layers>
+    bool operator!=(
+        ziggurat_exponential_distribution<T, Layers> const& d1,
+        ziggurat_exponential_distribution<T, Layers> const& d2
+        )
+    {
+        return !(d1 == d2);
+    }
+
+    // Stream output operator writes the lambda parameter to a stream.
+    template<typename Char, typename Tr, typename T, std::size_t Layers>
+    std::basic_ostream<Char, Tr>& operator<<(
+        std::basic_ostream<Char, Tr>& os,
+        ziggurat_exponential_distribution<T, Layers> const& dist
+        )
+    {
+        return os << dist.param();
+    }
+
+    // Stream input operator reads the lambda parameter from a stream.
+    template<typename Char, typename Tr, typename T, std::size_t Layers>
+    std::basic_istream<Char, Tr>& operator>>(
+        std::basic_istream<Char, Tr>& is,
+        ziggurat_exponential_distribution<T, Layers>& dist
+        )
+    {
+        typename ziggurat_exponential_distribution<T, Layers>::param_type param;
+        if (is >> param) {
+            dist.param(param);
+        }
+        return is;
+    }
 }
 
 #undef ZIGGURAT_LIKELY
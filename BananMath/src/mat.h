@@ -0,0 +1,543 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "simd.h"
+#include "vec.h"
+
+namespace Banan
+{
+
+	// Storage order of mat. column_major matches GLSL/Vulkan/OpenGL and is
+	// the default, row_major matches HLSL and C arrays.
+	enum class layout
+	{
+		column_major,
+		row_major
+	};
+
+	// mat<Ty, R, C, L> is an R x C matrix stored as an array of vec "lines":
+	// C columns of vec<Ty, R> for column_major, R rows of vec<Ty, C> for
+	// row_major. Arithmetic works on whole lines, so 4-wide float lines (and
+	// double lines with AVX) multiply in simd registers.
+	//
+	// data() points at the lines as stored. Lines of 3 float/double held in
+	// a simd register are padded to 4 elements (the std140 mat3 layout), use
+	// store_column_major/store_row_major for tightly packed arrays.
+	template<typename Ty, uint32_t R, uint32_t C, layout L = layout::column_major>
+	class mat
+	{
+	public:
+		static constexpr layout storage_layout = L;
+		static constexpr uint32_t line_count = L == layout::column_major ? C : R;
+		static constexpr uint32_t line_size = L == layout::column_major ? R : C;
+		using line_type = vec<Ty, line_size>;
+
+	public:
+		line_type lines[line_count];
+
+	public:
+		// Constructors
+		constexpr mat()
+			: lines()
+		{ }
+		// Elements are given row by row like the matrix is written down
+		template<typename... Args> requires (sizeof...(Args) == R * C && R * C > 1)
+		constexpr mat(const Args&... values)
+			: lines()
+		{
+			const Ty list[R * C] { Ty(values)... };
+			for (uint32_t r = 0; r < R; r++)
+				for (uint32_t c = 0; c < C; c++)
+					(*this)(r, c) = list[r * C + c];
+		}
+
+		static constexpr mat<Ty, R, C, L> identity() requires (R == C)
+		{
+			mat<Ty, R, C, L> result;
+			for (uint32_t i = 0; i < R; i++)
+				result.lines[i][i] = Ty(1);
+			return result;
+		}
+
+		// Build from vectors
+		template<typename... Cols> requires (sizeof...(Cols) == C)
+		static constexpr mat<Ty, R, C, L> from_columns(const Cols&... cols)
+		{
+			const vec<Ty, R> list[C] { cols... };
+			mat<Ty, R, C, L> result;
+			for (uint32_t c = 0; c < C; c++)
+				result.set_col(c, list[c]);
+			return result;
+		}
+		template<typename... Rows> requires (sizeof...(Rows) == R)
+		static constexpr mat<Ty, R, C, L> from_rows(const Rows&... rows)
+		{
+			const vec<Ty, C> list[R] { rows... };
+			mat<Ty, R, C, L> result;
+			for (uint32_t r = 0; r < R; r++)
+				result.set_row(r, list[r]);
+			return result;
+		}
+
+		// Loading/Storing tightly packed arrays of R * C elements
+		static constexpr mat<Ty, R, C, L> from_column_major(const Ty* src)
+		{
+			mat<Ty, R, C, L> result;
+			for (uint32_t c = 0; c < C; c++)
+				for (uint32_t r = 0; r < R; r++)
+					result(r, c) = src[c * R + r];
+			return result;
+		}
+		static constexpr mat<Ty, R, C, L> from_row_major(const Ty* src)
+		{
+			mat<Ty, R, C, L> result;
+			for (uint32_t r = 0; r < R; r++)
+				for (uint32_t c = 0; c < C; c++)
+					result(r, c) = src[r * C + c];
+			return result;
+		}
+		constexpr void store_column_major(Ty* dst) const
+		{
+			for (uint32_t c = 0; c < C; c++)
+				for (uint32_t r = 0; r < R; r++)
+					dst[c * R + r] = (*this)(r, c);
+		}
+		constexpr void store_row_major(Ty* dst) const
+		{
+			for (uint32_t r = 0; r < R; r++)
+				for (uint32_t c = 0; c < C; c++)
+					dst[r * C + c] = (*this)(r, c);
+		}
+
+		// Raw storage, line_count lines of sizeof(line_type) bytes each
+		Ty* data()
+		{
+			return &lines[0][0];
+		}
+		const Ty* data() const
+		{
+			return &lines[0][0];
+		}
+
+		// Element access
+		constexpr Ty& operator()(uint32_t r, uint32_t c)
+		{
+			if constexpr (L == layout::column_major)
+				return lines[c][r];
+			else
+				return lines[r][c];
+		}
+		constexpr const Ty& operator()(uint32_t r, uint32_t c) const
+		{
+			if constexpr (L == layout::column_major)
+				return lines[c][r];
+			else
+				return lines[r][c];
+		}
+		constexpr vec<Ty, C> row(uint32_t r) const
+		{
+			if constexpr (L == layout::row_major)
+				return lines[r];
+			vec<Ty, C> result;
+			for (uint32_t c = 0; c < C; c++)
+				result[c] = (*this)(r, c);
+			return result;
+		}
+		constexpr vec<Ty, R> col(uint32_t c) const
+		{
+			if constexpr (L == layout::column_major)
+				return lines[c];
+			vec<Ty, R> result;
+			for (uint32_t r = 0; r < R; r++)
+				result[r] = (*this)(r, c);
+			return result;
+		}
+		constexpr void set_row(uint32_t r, const vec<Ty, C>& v)
+		{
+			if constexpr (L == layout::row_major)
+				lines[r] = v;
+			else
+				for (uint32_t c = 0; c < C; c++)
+					(*this)(r, c) = v[c];
+		}
+		constexpr void set_col(uint32_t c, const vec<Ty, R>& v)
+		{
+			if constexpr (L == layout::column_major)
+				lines[c] = v;
+			else
+				for (uint32_t r = 0; r < R; r++)
+					(*this)(r, c) = v[r];
+		}
+
+		// Unary operators
+		constexpr mat<Ty, R, C, L> operator+() const
+		{
+			return *this;
+		}
+		constexpr mat<Ty, R, C, L> operator-() const
+		{
+			mat<Ty, R, C, L> result;
+			for (uint32_t i = 0; i < line_count; i++)
+				result.lines[i] = -lines[i];
+			return result;
+		}
+
+		// Assignment operators
+		constexpr mat<Ty, R, C, L>& operator+=(const mat<Ty, R, C, L>& m)
+		{
+			for (uint32_t i = 0; i < line_count; i++)
+				lines[i] += m.lines[i];
+			return *this;
+		}
+		constexpr mat<Ty, R, C, L>& operator-=(const mat<Ty, R, C, L>& m)
+		{
+			for (uint32_t i = 0; i < line_count; i++)
+				lines[i] -= m.lines[i];
+			return *this;
+		}
+		constexpr mat<Ty, R, C, L>& operator*=(const Ty& val)
+		{
+			for (uint32_t i = 0; i < line_count; i++)
+				lines[i] *= val;
+			return *this;
+		}
+		constexpr mat<Ty, R, C, L>& operator/=(const Ty& val)
+		{
+			for (uint32_t i = 0; i < line_count; i++)
+				lines[i] /= val;
+			return *this;
+		}
+		constexpr mat<Ty, R, C, L>& operator*=(const mat<Ty, C, C, L>& m)
+		{
+			return *this = *this * m;
+		}
+
+		// Transpose, 4x4 register backed matrices are transposed in registers
+		constexpr mat<Ty, C, R, L> transpose() const
+		{
+			mat<Ty, C, R, L> result;
+			if constexpr (R == 4 && C == 4 && simd::has_reg4<Ty>)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					using reg = simd::native<Ty, 4>;
+					typename reg::type r0 = lines[0].simd, r1 = lines[1].simd, r2 = lines[2].simd, r3 = lines[3].simd;
+					reg::transpose(r0, r1, r2, r3);
+					result.lines[0] = line_type(r0);
+					result.lines[1] = line_type(r1);
+					result.lines[2] = line_type(r2);
+					result.lines[3] = line_type(r3);
+					return result;
+				}
+			}
+			for (uint32_t r = 0; r < R; r++)
+				for (uint32_t c = 0; c < C; c++)
+					result(c, r) = (*this)(r, c);
+			return result;
+		}
+
+		// Determinant and inverse. det(M) = det(transpose(M)), so both are
+		// computed treating lines as columns and hold for either layout.
+		constexpr Ty determinant() const requires (R == C)
+		{
+			if constexpr (R == 1)
+				return lines[0][0];
+			else if constexpr (R == 2)
+				return lines[0][0] * lines[1][1] - lines[1][0] * lines[0][1];
+			else if constexpr (R == 3)
+				return lines[0].dot(lines[1].cross(lines[2]));
+			else if constexpr (R == 4)
+			{
+				Ty s[6], c[6];
+				minors4(s, c);
+				return s[0] * c[5] - s[1] * c[4] + s[2] * c[3] + s[3] * c[2] - s[4] * c[1] + s[5] * c[0];
+			}
+			else
+			{
+				// Gaussian elimination with partial pivoting
+				Ty m[R][R];
+				for (uint32_t j = 0; j < R; j++)
+					for (uint32_t i = 0; i < R; i++)
+						m[i][j] = lines[j][i];
+				Ty result = Ty(1);
+				for (uint32_t k = 0; k < R; k++)
+				{
+					uint32_t pivot = k;
+					for (uint32_t i = k + 1; i < R; i++)
+						if (detail::abs(m[i][k]) > detail::abs(m[pivot][k]))
+							pivot = i;
+					if (m[pivot][k] == Ty(0))
+						return Ty(0);
+					if (pivot != k)
+					{
+						for (uint32_t j = 0; j < R; j++)
+							std::swap(m[k][j], m[pivot][j]);
+						result = -result;
+					}
+					result *= m[k][k];
+					for (uint32_t i = k + 1; i < R; i++)
+					{
+						Ty f = m[i][k] / m[k][k];
+						for (uint32_t j = k; j < R; j++)
+							m[i][j] -= f * m[k][j];
+					}
+				}
+				return result;
+			}
+		}
+
+		// Inverse of a non-singular matrix, singular matrices give inf/nan
+		constexpr mat<Ty, R, C, L> inverse() const requires (R == C)
+		{
+			mat<Ty, R, C, L> result;
+			if constexpr (R == 1)
+			{
+				result.lines[0][0] = Ty(1) / lines[0][0];
+			}
+			else if constexpr (R == 2)
+			{
+				Ty inv_det = Ty(1) / determinant();
+				result.lines[0] = line_type( lines[1][1], -lines[0][1]) * inv_det;
+				result.lines[1] = line_type(-lines[1][0],  lines[0][0]) * inv_det;
+			}
+			else if constexpr (R == 3)
+			{
+				// Rows of the inverse are the cross products of the columns
+				mat<Ty, R, C, L> rows;
+				rows.lines[0] = lines[1].cross(lines[2]);
+				rows.lines[1] = lines[2].cross(lines[0]);
+				rows.lines[2] = lines[0].cross(lines[1]);
+				result = rows.transpose();
+				result /= lines[0].dot(rows.lines[0]);
+			}
+			else if constexpr (R == 4)
+			{
+				// Cofactors from the 2x2 minors of the upper and lower halves
+				Ty s[6], c[6];
+				minors4(s, c);
+				Ty inv_det = Ty(1) / (s[0] * c[5] - s[1] * c[4] + s[2] * c[3] + s[3] * c[2] - s[4] * c[1] + s[5] * c[0]);
+
+				auto a = [this](uint32_t i, uint32_t j) { return lines[j][i]; };
+				mat<Ty, R, C, L> rows;
+				rows.lines[0] = line_type(
+					 a(1, 1) * c[5] - a(1, 2) * c[4] + a(1, 3) * c[3],
+					-a(0, 1) * c[5] + a(0, 2) * c[4] - a(0, 3) * c[3],
+					 a(3, 1) * s[5] - a(3, 2) * s[4] + a(3, 3) * s[3],
+					-a(2, 1) * s[5] + a(2, 2) * s[4] - a(2, 3) * s[3]
+				);
+				rows.lines[1] = line_type(
+					-a(1, 0) * c[5] + a(1, 2) * c[2] - a(1, 3) * c[1],
+					 a(0, 0) * c[5] - a(0, 2) * c[2] + a(0, 3) * c[1],
+					-a(3, 0) * s[5] + a(3, 2) * s[2] - a(3, 3) * s[1],
+					 a(2, 0) * s[5] - a(2, 2) * s[2] + a(2, 3) * s[1]
+				);
+				rows.lines[2] = line_type(
+					 a(1, 0) * c[4] - a(1, 1) * c[2] + a(1, 3) * c[0],
+					-a(0, 0) * c[4] + a(0, 1) * c[2] - a(0, 3) * c[0],
+					 a(3, 0) * s[4] - a(3, 1) * s[2] + a(3, 3) * s[0],
+					-a(2, 0) * s[4] + a(2, 1) * s[2] - a(2, 3) * s[0]
+				);
+				rows.lines[3] = line_type(
+					-a(1, 0) * c[3] + a(1, 1) * c[1] - a(1, 2) * c[0],
+					 a(0, 0) * c[3] - a(0, 1) * c[1] + a(0, 2) * c[0],
+					-a(3, 0) * s[3] + a(3, 1) * s[1] - a(3, 2) * s[0],
+					 a(2, 0) * s[3] - a(2, 1) * s[1] + a(2, 2) * s[0]
+				);
+				result = rows.transpose() * inv_det;
+			}
+			else
+			{
+				// Gauss-Jordan elimination with partial pivoting
+				Ty m[R][2 * R] {};
+				for (uint32_t j = 0; j < R; j++)
+					for (uint32_t i = 0; i < R; i++)
+						m[i][j] = lines[j][i];
+				for (uint32_t i = 0; i < R; i++)
+					m[i][R + i] = Ty(1);
+				for (uint32_t k = 0; k < R; k++)
+				{
+					uint32_t pivot = k;
+					for (uint32_t i = k + 1; i < R; i++)
+						if (detail::abs(m[i][k]) > detail::abs(m[pivot][k]))
+							pivot = i;
+					if (pivot != k)
+						for (uint32_t j = 0; j < 2 * R; j++)
+							std::swap(m[k][j], m[pivot][j]);
+					Ty inv = Ty(1) / m[k][k];
+					for (uint32_t j = 0; j < 2 * R; j++)
+						m[k][j] *= inv;
+					for (uint32_t i = 0; i < R; i++)
+					{
+						if (i == k)
+							continue;
+						Ty f = m[i][k];
+						for (uint32_t j = 0; j < 2 * R; j++)
+							m[i][j] -= f * m[k][j];
+					}
+				}
+				for (uint32_t j = 0; j < R; j++)
+					for (uint32_t i = 0; i < R; i++)
+						result.lines[j][i] = m[i][R + j];
+			}
+			return result;
+		}
+
+	private:
+		// 2x2 minors of rows 0-1 (s) and rows 2-3 (c) of the 4x4 matrix
+		// with lines as columns
+		constexpr void minors4(Ty* s, Ty* c) const requires (R == 4 && C == 4)
+		{
+			auto a = [this](uint32_t i, uint32_t j) { return lines[j][i]; };
+			s[0] = a(0, 0) * a(1, 1) - a(1, 0) * a(0, 1);
+			s[1] = a(0, 0) * a(1, 2) - a(1, 0) * a(0, 2);
+			s[2] = a(0, 0) * a(1, 3) - a(1, 0) * a(0, 3);
+			s[3] = a(0, 1) * a(1, 2) - a(1, 1) * a(0, 2);
+			s[4] = a(0, 1) * a(1, 3) - a(1, 1) * a(0, 3);
+			s[5] = a(0, 2) * a(1, 3) - a(1, 2) * a(0, 3);
+			c[0] = a(2, 0) * a(3, 1) - a(3, 0) * a(2, 1);
+			c[1] = a(2, 0) * a(3, 2) - a(3, 0) * a(2, 2);
+			c[2] = a(2, 0) * a(3, 3) - a(3, 0) * a(2, 3);
+			c[3] = a(2, 1) * a(3, 2) - a(3, 1) * a(2, 2);
+			c[4] = a(2, 1) * a(3, 3) - a(3, 1) * a(2, 3);
+			c[5] = a(2, 2) * a(3, 3) - a(3, 2) * a(2, 3);
+		}
+
+	};
+
+
+	/* ##################### For All matrices ###################### */
+
+	// Addition/Subtraction of matrices
+	template<typename Ty, uint32_t R, uint32_t C, layout L>
+	constexpr mat<Ty, R, C, L> operator+(const mat<Ty, R, C, L>& a, const mat<Ty, R, C, L>& b)
+	{
+		mat<Ty, R, C, L> copy = a;
+		return copy += b;
+	}
+	template<typename Ty, uint32_t R, uint32_t C, layout L>
+	constexpr mat<Ty, R, C, L> operator-(const mat<Ty, R, C, L>& a, const mat<Ty, R, C, L>& b)
+	{
+		mat<Ty, R, C, L> copy = a;
+		return copy -= b;
+	}
+
+	// Multiplying/Dividing matrix with scalar
+	template<typename Ty, uint32_t R, uint32_t C, layout L>
+	constexpr mat<Ty, R, C, L> operator*(const mat<Ty, R, C, L>& m, const Ty& val)
+	{
+		mat<Ty, R, C, L> copy = m;
+		return copy *= val;
+	}
+	template<typename Ty, uint32_t R, uint32_t C, layout L>
+	constexpr mat<Ty, R, C, L> operator*(const Ty& val, const mat<Ty, R, C, L>& m)
+	{
+		mat<Ty, R, C, L> copy = m;
+		return copy *= val;
+	}
+	template<typename Ty, uint32_t R, uint32_t C, layout L>
+	constexpr mat<Ty, R, C, L> operator/(const mat<Ty, R, C, L>& m, const Ty& val)
+	{
+		mat<Ty, R, C, L> copy = m;
+		return copy /= val;
+	}
+
+	// Matrix product, every result line is a sum of scaled lines
+	template<typename Ty, uint32_t R, uint32_t K, uint32_t C, layout L>
+	constexpr mat<Ty, R, C, L> operator*(const mat<Ty, R, K, L>& a, const mat<Ty, K, C, L>& b)
+	{
+		mat<Ty, R, C, L> result;
+		if constexpr (L == layout::column_major)
+		{
+			// Column j of a * b is a * (column j of b)
+			for (uint32_t j = 0; j < C; j++)
+			{
+				vec<Ty, R> sum = a.lines[0] * b.lines[j][0];
+				for (uint32_t k = 1; k < K; k++)
+					sum += a.lines[k] * b.lines[j][k];
+				result.lines[j] = sum;
+			}
+		}
+		else
+		{
+			// Row i of a * b is (row i of a) * b
+			for (uint32_t i = 0; i < R; i++)
+			{
+				vec<Ty, C> sum = b.lines[0] * a.lines[i][0];
+				for (uint32_t k = 1; k < K; k++)
+					sum += b.lines[k] * a.lines[i][k];
+				result.lines[i] = sum;
+			}
+		}
+		return result;
+	}
+
+	// Transforming column vectors, m * v
+	template<typename Ty, uint32_t R, uint32_t C, layout L>
+	constexpr vec<Ty, R> operator*(const mat<Ty, R, C, L>& m, const vec<Ty, C>& v)
+	{
+		if constexpr (L == layout::column_major)
+		{
+			vec<Ty, R> result = m.lines[0] * v[0];
+			for (uint32_t c = 1; c < C; c++)
+				result += m.lines[c] * v[c];
+			return result;
+		}
+		else
+		{
+			vec<Ty, R> result;
+			for (uint32_t r = 0; r < R; r++)
+				result[r] = m.lines[r].dot(v);
+			return result;
+		}
+	}
+	// Transforming row vectors, v * m
+	template<typename Ty, uint32_t R, uint32_t C, layout L>
+	constexpr vec<Ty, C> operator*(const vec<Ty, R>& v, const mat<Ty, R, C, L>& m)
+	{
+		return m.transpose() * v;
+	}
+
+	// Comparison
+	template<typename Ty, uint32_t R, uint32_t C, layout L>
+	constexpr bool operator==(const mat<Ty, R, C, L>& a, const mat<Ty, R, C, L>& b)
+	{
+		for (uint32_t r = 0; r < R; r++)
+			for (uint32_t c = 0; c < C; c++)
+				if (a(r, c) != b(r, c))
+					return false;
+		return true;
+	}
+
+	template<typename Ty, uint32_t R, uint32_t C, layout L>
+	constexpr mat<Ty, C, R, L> transpose(const mat<Ty, R, C, L>& m)
+	{
+		return m.transpose();
+	}
+	template<typename Ty, uint32_t N, layout L>
+	constexpr Ty determinant(const mat<Ty, N, N, L>& m)
+	{
+		return m.determinant();
+	}
+	template<typename Ty, uint32_t N, layout L>
+	constexpr mat<Ty, N, N, L> inverse(const mat<Ty, N, N, L>& m)
+	{
+		return m.inverse();
+	}
+
+
+
+
+	// Definitions for most common matrices
+	using mat2f = mat<float,	2, 2>;
+	using mat2d = mat<double,	2, 2>;
+
+	using mat3f = mat<float,	3, 3>;
+	using mat3d = mat<double,	3, 3>;
+
+	using mat4f = mat<float,	4, 4>;
+	using mat4d = mat<double,	4, 4>;
+
+}
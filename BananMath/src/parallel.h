@@ -0,0 +1,247 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Work-stealing parallel_for.
+//
+// thread_pool::parallel_for splits [0, count) into chunks of grain
+// elements and calls body(begin, end) for each chunk. Every participant
+// (the workers and the calling thread) starts with a contiguous run of
+// chunks and takes them from the front; once its run is empty it steals
+// the back half of another participant's run. Calls made from inside a
+// body run inline on the current thread. Bodies must not throw.
+//
+// Anything with a matching parallel_for member satisfies executor and can
+// be passed to the batch kernels in place of the global pool.
+
+namespace Banan
+{
+
+	template<typename E>
+	concept executor = requires(E& e, std::size_t n, void (*body)(std::size_t, std::size_t))
+	{
+		e.parallel_for(n, n, body);
+	};
+
+	class thread_pool
+	{
+	private:
+		// Chunk indices [begin, end) still owned by one participant
+		struct alignas(64) slot
+		{
+			std::mutex lock;
+			std::size_t begin = 0;
+			std::size_t end = 0;
+		};
+
+		struct job
+		{
+			void (*invoke)(const void*, std::size_t, std::size_t);
+			const void* body;
+			std::size_t count;
+			std::size_t grain;
+		};
+
+	public:
+		// Constructors
+		explicit thread_pool(uint32_t threads = std::max(std::thread::hardware_concurrency(), 1u))
+			: m_slots(std::make_unique<slot[]>(std::max(threads, 1u)))
+			, m_size(std::max(threads, 1u))
+		{
+			// The calling thread takes part, so one thread less is spawned
+			for (uint32_t i = 1; i < m_size; i++)
+				m_workers.emplace_back([this, i] { worker_loop(i); });
+		}
+		~thread_pool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stop = true;
+			}
+			m_wake.notify_all();
+			for (std::thread& worker : m_workers)
+				worker.join();
+		}
+		thread_pool(const thread_pool&) = delete;
+		thread_pool& operator=(const thread_pool&) = delete;
+
+		// Shared pool with one thread per hardware thread
+		static thread_pool& global()
+		{
+			static thread_pool s_pool;
+			return s_pool;
+		}
+
+		// Number of threads taking part in parallel_for, including the caller
+		uint32_t size() const
+		{
+			return m_size;
+		}
+
+		template<typename Body>
+		void parallel_for(std::size_t count, std::size_t grain, const Body& body)
+		{
+			grain = std::max<std::size_t>(grain, 1);
+			const std::size_t chunks = (count + grain - 1) / grain;
+			if (chunks == 0)
+				return;
+
+			if (chunks == 1 || m_size == 1 || s_inside)
+			{
+				body(std::size_t(0), count);
+				return;
+			}
+
+			// One job runs at a time, concurrent callers queue up here
+			std::lock_guard<std::mutex> submit(m_submit);
+
+			// Hand every participant an equal run of chunks
+			for (uint32_t i = 0; i < m_size; i++)
+			{
+				m_slots[i].begin = chunks * i / m_size;
+				m_slots[i].end = chunks * (i + 1) / m_size;
+			}
+			m_remaining.store(chunks, std::memory_order_relaxed);
+
+			job current { &invoke<Body>, &body, count, grain };
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_job = &current;
+				m_generation++;
+			}
+			m_wake.notify_all();
+
+			work(0, current);
+
+			while (m_remaining.load(std::memory_order_acquire) != 0)
+				std::this_thread::yield();
+
+			// Late workers must not pick up the finished job
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_job = nullptr;
+			}
+			while (m_active.load(std::memory_order_acquire) != 0)
+				std::this_thread::yield();
+		}
+
+	private:
+		template<typename Body>
+		static void invoke(const void* body, std::size_t begin, std::size_t end)
+		{
+			(*static_cast<const Body*>(body))(begin, end);
+		}
+
+		void worker_loop(uint32_t index)
+		{
+			uint64_t seen = 0;
+			for (;;)
+			{
+				const job* current;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_wake.wait(lock, [&] { return m_stop || (m_job && m_generation != seen); });
+					if (m_stop)
+						return;
+					seen = m_generation;
+					current = m_job;
+					m_active.fetch_add(1, std::memory_order_relaxed);
+				}
+				work(index, *current);
+				m_active.fetch_sub(1, std::memory_order_release);
+			}
+		}
+
+		void work(uint32_t index, const job& current)
+		{
+			s_inside = true;
+			std::size_t chunk;
+			while (pop(index, chunk) || steal(index, chunk))
+			{
+				const std::size_t begin = chunk * current.grain;
+				const std::size_t end = std::min(begin + current.grain, current.count);
+				current.invoke(current.body, begin, end);
+				m_remaining.fetch_sub(1, std::memory_order_release);
+			}
+			s_inside = false;
+		}
+
+		// Take the next chunk of our own run
+		bool pop(uint32_t index, std::size_t& chunk)
+		{
+			slot& own = m_slots[index];
+			std::lock_guard<std::mutex> lock(own.lock);
+			if (own.begin == own.end)
+				return false;
+			chunk = own.begin++;
+			return true;
+		}
+
+		// Move the back half of another run into ours and take its first chunk
+		bool steal(uint32_t index, std::size_t& chunk)
+		{
+			for (uint32_t offset = 1; offset < m_size; offset++)
+			{
+				slot& victim = m_slots[(index + offset) % m_size];
+				std::size_t begin, end;
+				{
+					std::lock_guard<std::mutex> lock(victim.lock);
+					if (victim.begin == victim.end)
+						continue;
+					const std::size_t mid = victim.begin + (victim.end - victim.begin) / 2;
+					begin = mid;
+					end = victim.end;
+					victim.end = mid;
+				}
+
+				slot& own = m_slots[index];
+				std::lock_guard<std::mutex> lock(own.lock);
+				chunk = begin;
+				own.begin = begin + 1;
+				own.end = end;
+				return true;
+			}
+			return false;
+		}
+
+	private:
+		std::unique_ptr<slot[]> m_slots;
+		uint32_t m_size;
+		std::vector<std::thread> m_workers;
+
+		std::mutex m_submit;
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		const job* m_job = nullptr;
+		uint64_t m_generation = 0;
+		bool m_stop = false;
+
+		std::atomic<std::size_t> m_remaining { 0 };
+		std::atomic<uint32_t> m_active { 0 };
+
+		static inline thread_local bool s_inside = false;
+	};
+
+	// Run body(begin, end) over [0, count) in chunks of grain elements
+	template<typename Body>
+	void parallel_for(std::size_t count, std::size_t grain, const Body& body)
+	{
+		thread_pool::global().parallel_for(count, grain, body);
+	}
+	template<executor E, typename Body>
+	void parallel_for(E& exec, std::size_t count, std::size_t grain, const Body& body)
+	{
+		exec.parallel_for(count, grain, body);
+	}
+
+}
@@ -732,27 +732,58 @@ uint_x4<UInt,UIntX2> operator*(const uint_x4<UInt,UIntX2>& a,
 }
 
 #if PCG_64BIT_SPECIALIZATIONS
-#if defined(_MSC_VER)
+#if defined(_MSC_VER) && defined(_M_X64)
 #pragma intrinsic(_umul128)
 #endif
 
-#if defined(_MSC_VER) || __SIZEOF_INT128__
+/*
+ * Full 128-bit product of two 64-bit values, returns the low half and
+ * stores the high half in *hi.  Uses the compiler's 128-bit integers or
+ * the MSVC intrinsics where there are any, and otherwise a schoolbook
+ * multiply of the 32-bit halves (four 32x32->64 products), which is still
+ * much cheaper than the generic 32-bit limb code above.
+ */
+inline uint64_t mul64x64(uint64_t a, uint64_t b, uint64_t* hi)
+{
+#if __SIZEOF_INT128__
+    __uint128_t r = __uint128_t(a) * __uint128_t(b);
+    *hi = uint64_t(r >> 64);
+    return uint64_t(r);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return _umul128(a, b, hi);
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    *hi = __umulh(a, b);
+    return a * b;
+#else
+    uint64_t a0 = uint32_t(a), a1 = a >> 32;
+    uint64_t b0 = uint32_t(b), b1 = b >> 32;
+    uint64_t a0b0 = a0 * b0, a1b0 = a1 * b0, a0b1 = a0 * b1;
+    uint64_t mid = (a0b0 >> 32) + uint32_t(a1b0) + uint32_t(a0b1);
+    *hi = a1 * b1 + (a1b0 >> 32) + (a0b1 >> 32) + (mid >> 32);
+    return (mid << 32) | uint32_t(a0b0);
+#endif
+}
+
+// Only the low 64 bits of the cross products reach the result.
 template <typename UInt32>
 uint_x4<UInt32,uint64_t> operator*(const uint_x4<UInt32,uint64_t>& a,
 				   const uint_x4<UInt32,uint64_t>& b)
 {
-#if defined(_MSC_VER)
     uint64_t hi;
-    uint64_t lo = _umul128(a.d.v01, b.d.v01, &hi);
-#else
-    __uint128_t r = __uint128_t(a.d.v01) * __uint128_t(b.d.v01);
-    uint64_t lo = uint64_t(r);
-    uint64_t hi = r >> 64;
-#endif
+    uint64_t lo = mul64x64(a.d.v01, b.d.v01, &hi);
     hi += a.d.v23 * b.d.v01 + a.d.v01 * b.d.v23;
     return {hi, lo};
 }
-#endif
+
+template <typename UInt32>
+uint_x4<UInt32,uint64_t> operator*(const uint_x4<UInt32,uint64_t>& a,
+				   uint64_t b01)
+{
+    uint64_t hi;
+    uint64_t lo = mul64x64(a.d.v01, b01, &hi);
+    hi += a.d.v23 * b01;
+    return {hi, lo};
+}
 #endif
 
 
@@ -795,34 +826,36 @@ uint_x4<UInt,UIntX2> operator-(const uint_x4<UInt,UIntX2>& a,
 }
 
 #if PCG_64BIT_SPECIALIZATIONS
+// A single carry (borrow) out of the low half, which compilers turn into
+// add/adc (sub/sbb); MSVC gets the intrinsics.
 template <typename UInt32>
 uint_x4<UInt32,uint64_t> operator+(const uint_x4<UInt32,uint64_t>& a,
 				   const uint_x4<UInt32,uint64_t>& b)
 {
-    uint_x4<UInt32,uint64_t> r = {uint64_t(0u), uint64_t(0u)};
-
-    bool carryin = false;
-    bool carryout;
-    r.d.v01 = addwithcarry(a.d.v01, b.d.v01, carryin, &carryout);
-    carryin = carryout;
-    r.d.v23 = addwithcarry(a.d.v23, b.d.v23, carryin, &carryout);
-
-    return r;
+#if defined(_MSC_VER) && defined(_M_X64)
+    uint64_t lo, hi;
+    _addcarry_u64(_addcarry_u64(0, a.d.v01, b.d.v01, &lo),
+                  a.d.v23, b.d.v23, &hi);
+    return {hi, lo};
+#else
+    uint64_t lo = a.d.v01 + b.d.v01;
+    return {a.d.v23 + b.d.v23 + (lo < a.d.v01), lo};
+#endif
 }
 
 template <typename UInt32>
 uint_x4<UInt32,uint64_t> operator-(const uint_x4<UInt32,uint64_t>& a,
 				   const uint_x4<UInt32,uint64_t>& b)
 {
-    uint_x4<UInt32,uint64_t> r = {uint64_t(0u), uint64_t(0u)};
-
-    bool carryin = false;
-    bool carryout;
-    r.d.v01 = subwithcarry(a.d.v01, b.d.v01, carryin, &carryout);
-    carryin = carryout;
-    r.d.v23 = subwithcarry(a.d.v23, b.d.v23, carryin, &carryout);
-
-    return r;
+#if defined(_MSC_VER) && defined(_M_X64)
+    uint64_t lo, hi;
+    _subborrow_u64(_subborrow_u64(0, a.d.v01, b.d.v01, &lo),
+                   a.d.v23, b.d.v23, &hi);
+    return {hi, lo};
+#else
+    uint64_t lo = a.d.v01 - b.d.v01;
+    return {a.d.v23 - b.d.v23 - (a.d.v01 < b.d.v01), lo};
+#endif
 }
 #endif
 
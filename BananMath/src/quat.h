@@ -0,0 +1,324 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+#include "mat.h"
+#include "simd.h"
+#include "vec.h"
+
+namespace Banan
+{
+
+	// quat<Ty> is a quaternion x*i + y*j + z*k + w stored as a vec<Ty, 4>
+	// (x, y, z, w), so float quaternions (and double with AVX) live in a
+	// simd register and arrays of them have the layout of arrays of vec4.
+	// Rotations expect unit quaternions.
+	template<typename Ty>
+	class quat
+	{
+	private:
+		static constexpr bool in_register = simd::has_reg4<Ty>;
+
+	public:
+		vec<Ty, 4> xyzw;
+
+	public:
+		// Constructors, the default quaternion is the identity rotation
+		constexpr quat()
+			: xyzw(Ty(0), Ty(0), Ty(0), Ty(1))
+		{ }
+		constexpr quat(const Ty& x, const Ty& y, const Ty& z, const Ty& w)
+			: xyzw(x, y, z, w)
+		{ }
+		constexpr explicit quat(const vec<Ty, 4>& xyzw)
+			: xyzw(xyzw)
+		{ }
+		constexpr quat(const vec<Ty, 3>& v, const Ty& w)
+		{
+			if constexpr (in_register)
+			{
+				if (!std::is_constant_evaluated())
+				{
+					using reg = simd::reg4<Ty>;
+					xyzw = vec<Ty, 4>(reg::blend_w(v.simd, reg::broadcast(w)));
+					return;
+				}
+			}
+			xyzw = vec<Ty, 4>(v.x, v.y, v.z, w);
+		}
+
+		static constexpr quat<Ty> identity()
+		{
+			return quat<Ty>();
+		}
+
+		// Rotation of angle radians around a unit axis
+		static quat<Ty> from_axis_angle(const vec<Ty, 3>& axis, Ty angle)
+		{
+			Ty half = angle * Ty(0.5);
+			return quat<Ty>(axis * Ty(std::sin(half)), Ty(std::cos(half)));
+		}
+
+		// Rotation part of a 3x3 or 4x4 matrix, which must be orthonormal.
+		// The largest of w, x, y, z is solved first to keep precision.
+		template<uint32_t N, layout L> requires (N == 3 || N == 4)
+		static constexpr quat<Ty> from_matrix(const mat<Ty, N, N, L>& m)
+		{
+			Ty trace = m(0, 0) + m(1, 1) + m(2, 2);
+			if (trace > Ty(0))
+			{
+				Ty s = detail::sqrt(trace + Ty(1)) * Ty(2);
+				return quat<Ty>((m(2, 1) - m(1, 2)) / s, (m(0, 2) - m(2, 0)) / s, (m(1, 0) - m(0, 1)) / s, s / Ty(4));
+			}
+			if (m(0, 0) > m(1, 1) && m(0, 0) > m(2, 2))
+			{
+				Ty s = detail::sqrt(Ty(1) + m(0, 0) - m(1, 1) - m(2, 2)) * Ty(2);
+				return quat<Ty>(s / Ty(4), (m(0, 1) + m(1, 0)) / s, (m(0, 2) + m(2, 0)) / s, (m(2, 1) - m(1, 2)) / s);
+			}
+			if (m(1, 1) > m(2, 2))
+			{
+				Ty s = detail::sqrt(Ty(1) + m(1, 1) - m(0, 0) - m(2, 2)) * Ty(2);
+				return quat<Ty>((m(0, 1) + m(1, 0)) / s, s / Ty(4), (m(1, 2) + m(2, 1)) / s, (m(0, 2) - m(2, 0)) / s);
+			}
+			Ty s = detail::sqrt(Ty(1) + m(2, 2) - m(0, 0) - m(1, 1)) * Ty(2);
+			return quat<Ty>((m(0, 2) + m(2, 0)) / s, (m(1, 2) + m(2, 1)) / s, s / Ty(4), (m(1, 0) - m(0, 1)) / s);
+		}
+
+		// Element access
+		constexpr vec<Ty, 3> xyz() const
+		{
+			if constexpr (in_register)
+			{
+				if (!std::is_constant_evaluated())
+					return vec<Ty, 3>(xyzw.simd);
+			}
+			return vec<Ty, 3>(xyzw.x, xyzw.y, xyzw.z);
+		}
+		constexpr Ty w() const
+		{
+			return xyzw.w;
+		}
+
+		// Unary operators
+		constexpr quat<Ty> operator+() const
+		{
+			return *this;
+		}
+		constexpr quat<Ty> operator-() const
+		{
+			return quat<Ty>(-xyzw);
+		}
+
+		// Assignment operators
+		constexpr quat<Ty>& operator+=(const quat<Ty>& q)
+		{
+			xyzw += q.xyzw;
+			return *this;
+		}
+		constexpr quat<Ty>& operator-=(const quat<Ty>& q)
+		{
+			xyzw -= q.xyzw;
+			return *this;
+		}
+		constexpr quat<Ty>& operator*=(const Ty& val)
+		{
+			xyzw *= val;
+			return *this;
+		}
+		constexpr quat<Ty>& operator/=(const Ty& val)
+		{
+			xyzw /= val;
+			return *this;
+		}
+		// Composition, (a * b) rotates by b first and then by a
+		constexpr quat<Ty>& operator*=(const quat<Ty>& q)
+		{
+			vec<Ty, 3> a = xyz(), b = q.xyz();
+			Ty aw = w(), bw = q.w();
+			return *this = quat<Ty>(b * aw + a * bw + a.cross(b), aw * bw - a.dot(b));
+		}
+
+		// Other quaternion operators
+		constexpr Ty dot(const quat<Ty>& q) const
+		{
+			return xyzw.dot(q.xyzw);
+		}
+		constexpr Ty magSq() const
+		{
+			return xyzw.magSq();
+		}
+		constexpr Ty mag() const
+		{
+			return xyzw.mag();
+		}
+		constexpr quat<Ty>& normalize()
+		{
+			xyzw.normalize();
+			return *this;
+		}
+		constexpr quat<Ty> conjugate() const
+		{
+			return quat<Ty>(-xyz(), w());
+		}
+		constexpr quat<Ty> inverse() const
+		{
+			quat<Ty> result = conjugate();
+			return result /= magSq();
+		}
+
+		// Rotating vectors, v + 2w(u x v) + 2u x (u x v) with u = xyz()
+		constexpr vec<Ty, 3> rotate(const vec<Ty, 3>& v) const
+		{
+			vec<Ty, 3> u = xyz();
+			vec<Ty, 3> t = u.cross(v) * Ty(2);
+			return v + t * w() + u.cross(t);
+		}
+
+		// Rotation matrices
+		template<layout L = layout::column_major>
+		constexpr mat<Ty, 3, 3, L> to_mat3() const
+		{
+			const Ty x = xyzw.x, y = xyzw.y, z = xyzw.z, w = xyzw.w;
+			const Ty xx = x * x, yy = y * y, zz = z * z;
+			const Ty xy = x * y, xz = x * z, yz = y * z;
+			const Ty wx = w * x, wy = w * y, wz = w * z;
+			return mat<Ty, 3, 3, L>(
+				Ty(1) - Ty(2) * (yy + zz),	Ty(2) * (xy - wz),			Ty(2) * (xz + wy),
+				Ty(2) * (xy + wz),			Ty(1) - Ty(2) * (xx + zz),	Ty(2) * (yz - wx),
+				Ty(2) * (xz - wy),			Ty(2) * (yz + wx),			Ty(1) - Ty(2) * (xx + yy)
+			);
+		}
+		template<layout L = layout::column_major>
+		constexpr mat<Ty, 4, 4, L> to_mat4() const
+		{
+			mat<Ty, 3, 3, L> m = to_mat3<L>();
+			mat<Ty, 4, 4, L> result = mat<Ty, 4, 4, L>::identity();
+			for (uint32_t r = 0; r < 3; r++)
+				for (uint32_t c = 0; c < 3; c++)
+					result(r, c) = m(r, c);
+			return result;
+		}
+
+	};
+
+
+	/* #################### For All quaternions ##################### */
+
+	// Addition/Subtraction of quaternions
+	template<typename Ty>
+	constexpr quat<Ty> operator+(const quat<Ty>& a, const quat<Ty>& b)
+	{
+		quat<Ty> copy = a;
+		return copy += b;
+	}
+	template<typename Ty>
+	constexpr quat<Ty> operator-(const quat<Ty>& a, const quat<Ty>& b)
+	{
+		quat<Ty> copy = a;
+		return copy -= b;
+	}
+
+	// Multiplying/Dividing quaternion with scalar
+	template<typename Ty>
+	constexpr quat<Ty> operator*(const quat<Ty>& q, const Ty& val)
+	{
+		quat<Ty> copy = q;
+		return copy *= val;
+	}
+	template<typename Ty>
+	constexpr quat<Ty> operator*(const Ty& val, const quat<Ty>& q)
+	{
+		quat<Ty> copy = q;
+		return copy *= val;
+	}
+	template<typename Ty>
+	constexpr quat<Ty> operator/(const quat<Ty>& q, const Ty& val)
+	{
+		quat<Ty> copy = q;
+		return copy /= val;
+	}
+
+	// Composition and rotating vectors
+	template<typename Ty>
+	constexpr quat<Ty> operator*(const quat<Ty>& a, const quat<Ty>& b)
+	{
+		quat<Ty> copy = a;
+		return copy *= b;
+	}
+	template<typename Ty>
+	constexpr vec<Ty, 3> operator*(const quat<Ty>& q, const vec<Ty, 3>& v)
+	{
+		return q.rotate(v);
+	}
+
+	// Comparison
+	template<typename Ty>
+	constexpr bool operator==(const quat<Ty>& a, const quat<Ty>& b)
+	{
+		for (uint32_t i = 0; i < 4; i++)
+			if (a.xyzw[i] != b.xyzw[i])
+				return false;
+		return true;
+	}
+
+	template<typename Ty>
+	constexpr Ty dot(const quat<Ty>& a, const quat<Ty>& b)
+	{
+		return a.dot(b);
+	}
+	template<typename Ty>
+	constexpr quat<Ty> unit(const quat<Ty>& q)
+	{
+		quat<Ty> copy = q;
+		return copy.normalize();
+	}
+	template<typename Ty>
+	constexpr quat<Ty> conjugate(const quat<Ty>& q)
+	{
+		return q.conjugate();
+	}
+	template<typename Ty>
+	constexpr quat<Ty> inverse(const quat<Ty>& q)
+	{
+		return q.inverse();
+	}
+
+	// Interpolation between unit quaternions along the shorter arc.
+	// nlerp normalizes the linear interpolation, it follows the same path
+	// as slerp but not at constant angular speed.
+	template<typename Ty>
+	constexpr quat<Ty> nlerp(const quat<Ty>& a, const quat<Ty>& b, Ty t)
+	{
+		quat<Ty> end = a.dot(b) < Ty(0) ? -b : b;
+		return unit(a + (end - a) * t);
+	}
+	template<typename Ty>
+	quat<Ty> slerp(const quat<Ty>& a, const quat<Ty>& b, Ty t)
+	{
+		Ty cos_theta = a.dot(b);
+		quat<Ty> end = b;
+		if (cos_theta < Ty(0))
+		{
+			end = -b;
+			cos_theta = -cos_theta;
+		}
+
+		// sin(theta) vanishes for nearly equal rotations, where nlerp is exact enough
+		if (cos_theta > Ty(0.9995))
+			return unit(a + (end - a) * t);
+
+		Ty theta = Ty(std::acos(cos_theta));
+		Ty inv_sin = Ty(1) / Ty(std::sin(theta));
+		return a * Ty(std::sin((Ty(1) - t) * theta) * inv_sin) + end * Ty(std::sin(t * theta) * inv_sin);
+	}
+
+
+
+
+	// Definitions for most common quaternions
+	using quatf = quat<float>;
+	using quatd = quat<double>;
+
+}
@@ -2,37 +2,1211 @@
 
 #include "pcg/pcg_random.hpp"
 #include "cxx/ziggurat.hpp"
+#include "simd.h"
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <span>
 #include <type_traits>
 
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+// Every thread draws from its own engine, created on the thread's first
+// draw and seeded from the shared base seed and the thread's index. A
+// thread takes its index from seed_thread(index), so threads numbered by
+// the program draw reproducible sequences for a fixed base seed. Threads
+// that never call it, including those of thread_pool, get the next free
+// index on their first draw. That order depends on scheduling, so their
+// sequences are not reproducible across runs. Parallel code that must be
+// should tie engines to pieces of work with random_streams instead.
+//
+// All functions also take an explicit engine as first argument, for code
+// that manages its own engines:
+//
+//	default_engine engine(seed);
+//	vec3f dir = vec3f::random(engine);
+//
+// Engines producing full 32 or 64 bit words skip the std distributions.
+// A 64 bit engine gives a double its 53 random bits in one step where a
+// 32 bit engine takes two, double values drawn without an explicit engine
+// come from the thread's default_engine64.
+
 namespace Banan
 {
-	static pcg32_fast s_pcg32_fast;
 
-	static void seed_generator()
+	using default_engine = pcg32_fast;
+	using default_engine64 = pcg64_fast;
+
+	template<typename E>
+	concept random_engine = std::uniform_random_bit_generator<std::remove_cvref_t<E>>;
+
+	// Engines that can write many 32 bit outputs at once, like pcg32_lanes
+	template<typename E>
+	concept block_engine = random_engine<E> && requires(E& engine, std::span<uint32_t> out)
+	{
+		engine.fill(out);
+	};
+
+	namespace detail
+	{
+		inline std::atomic<uint64_t> s_base_seed { 0 };
+		inline std::atomic<uint64_t> s_thread_count { 0 };
+
+		// splitmix64 finalizer, spreads nearby seeds over the whole state
+		inline uint64_t mix_seed(uint64_t x)
+		{
+			x += 0x9E3779B97F4A7C15;
+			x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9;
+			x = (x ^ (x >> 27)) * 0x94D049BB133111EB;
+			return x ^ (x >> 31);
+		}
+
+		inline uint64_t thread_seed(uint64_t base, uint64_t thread)
+		{
+			return mix_seed(base ^ mix_seed(thread));
+		}
+
+		// Engines whose output covers every value of a 32 or 64 bit word
+		template<typename Engine>
+		constexpr bool has_bits32 = Engine::min() == 0 && Engine::max() == std::numeric_limits<uint32_t>::max();
+		template<typename Engine>
+		constexpr bool has_bits64 = Engine::min() == 0 && Engine::max() == std::numeric_limits<uint64_t>::max();
+		template<typename Engine>
+		constexpr bool has_bits = has_bits32<Engine> || has_bits64<Engine>;
+
+		template<typename Engine> requires has_bits<Engine>
+		uint32_t bits32(Engine& engine)
+		{
+			if constexpr (has_bits32<Engine>)
+				return uint32_t(engine());
+			else
+				return uint32_t(engine() >> 32);
+		}
+		template<typename Engine> requires has_bits<Engine>
+		uint64_t bits64(Engine& engine)
+		{
+			if constexpr (has_bits64<Engine>)
+				return uint64_t(engine());
+			else
+			{
+				uint64_t high = engine();
+				return (high << 32) | uint32_t(engine());
+			}
+		}
+
+		// Raw words a block at a time from block engines and two per step
+		// from 64 bit engines. A 64 bit output keeps its byte order, so
+		// pairs of words read back as uint64_t are whole outputs.
+		template<typename Engine> requires has_bits<Engine>
+		void fill_bits(Engine& engine, std::span<uint32_t> out)
+		{
+			if constexpr (block_engine<Engine>)
+				engine.fill(out);
+			else if constexpr (has_bits64<Engine>)
+			{
+				std::size_t i = 0;
+				for (; i + 2 <= out.size(); i += 2)
+				{
+					const uint64_t word = uint64_t(engine());
+					std::memcpy(out.data() + i, &word, sizeof(word));
+				}
+				if (i < out.size())
+					out[i] = bits32(engine);
+			}
+			else
+			{
+				for (uint32_t& word : out)
+					word = uint32_t(engine());
+			}
+		}
+
+		// [0, 1) from the top mantissa bits: 1.m has an exponent of zero,
+		// subtracting 1 leaves a uniform value on a 2^-23 grid
+		inline float unit_float(uint32_t bits)
+		{
+			return std::bit_cast<float>(0x3F800000u | (bits >> 9)) - 1.0f;
+		}
+		// [0, 1) on a 2^-53 grid, the top 53 bits fit a double exactly
+		inline double unit_double(uint64_t bits)
+		{
+			return double(int64_t(bits >> 11)) * 0x1.0p-53;
+		}
+
+		// High half of the 128 bit product, the same on every toolchain
+		inline uint64_t mul_high(uint64_t a, uint64_t b, uint64_t& low)
+		{
+#if defined(__SIZEOF_INT128__)
+			__uint128_t m = (__uint128_t)a * b;
+			low = uint64_t(m);
+			return uint64_t(m >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+			uint64_t high;
+			low = _umul128(a, b, &high);
+			return high;
+#else
+			const uint64_t a_lo = uint32_t(a), a_hi = a >> 32;
+			const uint64_t b_lo = uint32_t(b), b_hi = b >> 32;
+			const uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi;
+			const uint64_t cross = (lo_lo >> 32) + uint32_t(hi_lo) + uint32_t(lo_hi);
+			low = (cross << 32) | uint32_t(lo_lo);
+			return a_hi * b_hi + (hi_lo >> 32) + (lo_hi >> 32) + (cross >> 32);
+#endif
+		}
+
+		// Lemire's multiply-shift: x * n / 2^32 is uniform on [0, n) once
+		// products whose low half falls below 2^32 mod n are rejected. The
+		// low half is at least n for all but n / 2^32 of the draws, so the
+		// modulo is only computed in that rare case. n must not be 0.
+		template<typename Engine>
+		uint32_t bounded32(Engine& engine, uint32_t n)
+		{
+			uint64_t m = uint64_t(bits32(engine)) * n;
+			if (uint32_t(m) < n)
+			{
+				const uint32_t threshold = uint32_t(-n) % n;
+				while (uint32_t(m) < threshold)
+					m = uint64_t(bits32(engine)) * n;
+			}
+			return uint32_t(m >> 32);
+		}
+		template<typename Engine>
+		uint64_t bounded64(Engine& engine, uint64_t n)
+		{
+			uint64_t low;
+			uint64_t high = mul_high(bits64(engine), n, low);
+			if (low < n)
+			{
+				const uint64_t threshold = uint64_t(-n) % n;
+				while (low < threshold)
+					high = mul_high(bits64(engine), n, low);
+			}
+			return high;
+		}
+
+		// Value in [min, max] through the narrowest sampler covering the range
+		template<typename T, typename Engine>
+		T bounded(Engine& engine, T min, T max)
+		{
+			using U = std::make_unsigned_t<T>;
+			const uint64_t range = uint64_t(U(U(max) - U(min)));
+			if constexpr (sizeof(T) == 8)
+			{
+				if (range == std::numeric_limits<uint64_t>::max())
+					return T(bits64(engine));
+				if (range > std::numeric_limits<uint32_t>::max())
+					return T(U(min) + U(bounded64(engine, range + 1)));
+			}
+			if (range == std::numeric_limits<uint32_t>::max())
+				return T(U(min) + U(bits32(engine)));
+			return T(U(min) + U(bounded32(engine, uint32_t(range + 1))));
+		}
+	}
+
+	namespace detail
+	{
+		// Index of the calling thread. Threads without one from seed_thread
+		// count down from the top of the range in order of first draw, so
+		// they never meet the small indices given to seed_thread.
+		struct thread_slot
+		{
+			bool assigned = false;
+			uint64_t index = 0;
+		};
+		inline thread_slot& thread_state()
+		{
+			thread_local thread_slot slot;
+			return slot;
+		}
+		inline uint64_t thread_index()
+		{
+			thread_slot& slot = thread_state();
+			if (!slot.assigned)
+			{
+				slot.index = ~s_thread_count.fetch_add(1, std::memory_order_relaxed);
+				slot.assigned = true;
+			}
+			return slot.index;
+		}
+
+		// Seed of the thread's default_engine64, apart from its default_engine seed
+		inline uint64_t thread_seed64(uint64_t base, uint64_t thread)
+		{
+			return mix_seed(thread_seed(base, thread));
+		}
+	}
+
+	// Engines of the calling thread
+	inline default_engine& thread_generator()
+	{
+		thread_local default_engine engine(detail::thread_seed(detail::s_base_seed.load(std::memory_order_relaxed), detail::thread_index()));
+		return engine;
+	}
+	inline default_engine64& thread_generator64()
+	{
+		thread_local default_engine64 engine(detail::thread_seed64(detail::s_base_seed.load(std::memory_order_relaxed), detail::thread_index()));
+		return engine;
+	}
+
+	// Engine of the calling thread that values of type T are drawn from
+	template<typename T>
+	auto& thread_generator_for()
+	{
+		if constexpr (std::is_floating_point_v<T> && sizeof(T) == 8)
+			return thread_generator64();
+		else
+			return thread_generator();
+	}
+
+	// Sets the base seed and reseeds the calling thread's engines. Threads
+	// that have already drawn keep their engines, seed before starting
+	// worker threads.
+	inline void seed_generator(uint64_t seed)
+	{
+		detail::s_base_seed.store(seed, std::memory_order_relaxed);
+		thread_generator().seed(detail::thread_seed(seed, detail::thread_index()));
+		thread_generator64().seed(detail::thread_seed64(seed, detail::thread_index()));
+	}
+	inline void seed_generator()
+	{
+		std::random_device device;
+		seed_generator((uint64_t(device()) << 32) | device());
+	}
+
+	// Gives the calling thread the index its engines are seeded from and
+	// reseeds them from the current base seed. Threads given the same
+	// index draw the same sequences, so indices should be unique, and a
+	// thread is only reproducible if it calls this before drawing:
+	//
+	//	seed_generator(seed);
+	//	for (uint32_t i = 0; i < count; i++)
+	//		workers.emplace_back([i] { seed_thread(i); work(i); });
+	inline void seed_thread(uint64_t index)
 	{
-		s_pcg32_fast.seed(pcg_extras::seed_seq_from<std::random_device>());
+		detail::thread_slot& slot = detail::thread_state();
+		slot.index = index;
+		slot.assigned = true;
+		const uint64_t base = detail::s_base_seed.load(std::memory_order_relaxed);
+		thread_generator().seed(detail::thread_seed(base, index));
+		thread_generator64().seed(detail::thread_seed64(base, index));
 	}
 
+	// Independent engines derived from one master seed. Tying each engine
+	// to a fixed piece of work (a tile, a sample batch, ...) instead of a
+	// thread makes parallel results independent of thread count and
+	// scheduling:
+	//
+	//	random_streams streams(seed);
+	//	parallel_for(tiles, 1, [&](std::size_t begin, std::size_t end) {
+	//		for (std::size_t i = begin; i < end; i++) {
+	//			stream_engine engine = streams.stream(i);
+	//			render_tile(i, engine);
+	//		}
+	//	});
+	using stream_engine = pcg32;
+
+	class random_streams
+	{
+	public:
+		explicit random_streams(uint64_t seed)
+			: m_seed(seed)
+		{ }
+
+		uint64_t seed() const
+		{
+			return m_seed;
+		}
+
+		// Engine on its own PCG stream (increment), 2^63 streams of period
+		// 2^64 each. The start state is mixed with the index as well, since
+		// streams from equal states are correlated.
+		stream_engine stream(uint64_t index) const
+		{
+			return stream_engine(detail::thread_seed(m_seed, index), index);
+		}
+
+		// Engine at index * block_size draws into the master stream. Blocks
+		// do not overlap as long as no engine draws more than block_size
+		// values. Creation costs O(log(index * block_size)) steps.
+		stream_engine block(uint64_t index, uint64_t block_size) const
+		{
+			stream_engine engine(detail::mix_seed(m_seed));
+			engine.advance(index * block_size);
+			return engine;
+		}
+
+	private:
+		uint64_t m_seed;
+	};
+
+	// Integers in [min, max]. Engines producing full 32 or 64 bit words use
+	// detail::bounded instead of std::uniform_int_distribution, whose
+	// results differ between standard libraries.
+	template<typename T, random_engine Engine>
+	typename std::enable_if<std::is_integral<T>::value, T>::type get_random_uniform(Engine& engine, T min = T(0), T max = T(1))
+	{
+		if constexpr (detail::has_bits<std::remove_cvref_t<Engine>> && sizeof(T) <= 8)
+			return detail::bounded<T>(engine, min, max);
+		else
+		{
+			std::uniform_int_distribution dist(min, max);
+			return dist(engine);
+		}
+	}
 	template<typename T>
 	typename std::enable_if<std::is_integral<T>::value, T>::type get_random_uniform(T min = T(0), T max = T(1))
 	{
-		std::uniform_int_distribution dist(min, max);
-		return dist(s_pcg32_fast);
+		return get_random_uniform<T>(thread_generator(), min, max);
 	}
 
+	// Floating point values in [min, max), from 23 random bits for float
+	// and 53 for double when the engine produces full words
+	template<typename T, random_engine Engine>
+	typename std::enable_if<std::is_floating_point<T>::value, T>::type get_random_uniform(Engine& engine, T min = T(0), T max = T(1))
+	{
+		if constexpr (detail::has_bits<std::remove_cvref_t<Engine>> && sizeof(T) == 4)
+			return min + (max - min) * T(detail::unit_float(detail::bits32(engine)));
+		else if constexpr (detail::has_bits<std::remove_cvref_t<Engine>> && sizeof(T) == 8)
+			return min + (max - min) * T(detail::unit_double(detail::bits64(engine)));
+		else
+		{
+			std::uniform_real_distribution dist(min, max);
+			return dist(engine);
+		}
+	}
 	template<typename T>
 	typename std::enable_if<std::is_floating_point<T>::value, T>::type get_random_uniform(T min = T(0), T max = T(1))
 	{
-		std::uniform_real_distribution dist(min, max);
-		return dist(s_pcg32_fast);
+		return get_random_uniform<T>(thread_generator_for<T>(), min, max);
 	}
 
-	template<typename T>
+	// Fills out with uniform values, in [min, max) for floating point and
+	// [min, max] for integers. Engines producing full 32 or 64 bit words
+	// skip the std distributions: floats are built from the raw bits and
+	// integer ranges use one multiply per value with a rejection threshold
+	// computed once per call.
+	template<typename T, random_engine Engine> requires std::is_floating_point_v<T>
+	void fill_uniform(Engine& engine, std::span<T> out, T min = T(0), T max = T(1))
+	{
+		using E = std::remove_cvref_t<Engine>;
+		const T scale = max - min;
+		if constexpr (!detail::has_bits<E> || (sizeof(T) != 4 && sizeof(T) != 8))
+		{
+			std::uniform_real_distribution<T> dist(min, max);
+			for (T& value : out)
+				value = dist(engine);
+		}
+		else if constexpr ((block_engine<E> || detail::has_bits64<E>) && sizeof(T) == 4)
+		{
+			// Raw bits a block at a time, then converted in a separate loop
+			alignas(64) uint32_t bits[256];
+			for (std::size_t base = 0; base < out.size(); base += 256)
+			{
+				const std::size_t count = std::min<std::size_t>(256, out.size() - base);
+				detail::fill_bits(engine, std::span<uint32_t>(bits, count));
+
+				using native = simd::native_widest<float>;
+				std::size_t i = 0;
+				for (; i + native::lanes <= count; i += native::lanes)
+					native::storeu(out.data() + base + i, native::add(native::broadcast(min), native::mul(native::broadcast(scale), native::unit_from_bits(bits + i))));
+				for (; i < count; i++)
+					out[base + i] = min + scale * T(detail::unit_float(bits[i]));
+			}
+		}
+		else if constexpr (block_engine<E>)
+		{
+			alignas(64) uint32_t bits[256];
+			for (std::size_t base = 0; base < out.size(); base += 128)
+			{
+				const std::size_t count = std::min<std::size_t>(128, out.size() - base);
+				engine.fill(std::span<uint32_t>(bits, 2 * count));
+				for (std::size_t i = 0; i < count; i++)
+					out[base + i] = min + scale * T(detail::unit_double((uint64_t(bits[2 * i]) << 32) | bits[2 * i + 1]));
+			}
+		}
+		else if constexpr (sizeof(T) == 4)
+		{
+			for (T& value : out)
+				value = min + scale * T(detail::unit_float(detail::bits32(engine)));
+		}
+		else
+		{
+			for (T& value : out)
+				value = min + scale * T(detail::unit_double(detail::bits64(engine)));
+		}
+	}
+
+	template<typename T, random_engine Engine> requires std::is_integral_v<T>
+	void fill_uniform(Engine& engine, std::span<T> out, T min = T(0), T max = T(1))
+	{
+		using E = std::remove_cvref_t<Engine>;
+		using U = std::make_unsigned_t<T>;
+		const uint64_t range = uint64_t(U(U(max) - U(min)));
+
+		if constexpr (!detail::has_bits<E> || sizeof(T) > 8)
+		{
+			std::uniform_int_distribution<T> dist(min, max);
+			for (T& value : out)
+				value = dist(engine);
+		}
+		else if (range == std::numeric_limits<uint64_t>::max())
+		{
+			for (T& value : out)
+				value = T(detail::bits64(engine));
+		}
+		else if (range == std::numeric_limits<uint32_t>::max())
+		{
+			for (T& value : out)
+				value = T(U(min) + U(detail::bits32(engine)));
+		}
+		else if (range < std::numeric_limits<uint32_t>::max())
+		{
+			// detail::bounded32 with the rejection threshold computed once,
+			// it rejects the same draws
+			const uint32_t n = uint32_t(range + 1);
+			const uint32_t threshold = uint32_t(-n) % n;
+			for (T& value : out)
+			{
+				uint64_t m = uint64_t(detail::bits32(engine)) * n;
+				while (uint32_t(m) < threshold)
+					m = uint64_t(detail::bits32(engine)) * n;
+				value = T(U(min) + U(m >> 32));
+			}
+		}
+		else
+		{
+			// Same in 64 bits
+			const uint64_t n = range + 1;
+			const uint64_t threshold = uint64_t(-n) % n;
+			for (T& value : out)
+			{
+				uint64_t low;
+				uint64_t high = detail::mul_high(detail::bits64(engine), n, low);
+				while (low < threshold)
+					high = detail::mul_high(detail::bits64(engine), n, low);
+				value = T(U(min) + U(high));
+			}
+		}
+	}
+
+	template<typename T> requires std::is_arithmetic_v<T>
+	void fill_uniform(std::span<T> out, T min = T(0), T max = T(1))
+	{
+		fill_uniform<T>(thread_generator_for<T>(), out, min, max);
+	}
+
+	// Layer count of the ziggurat tables used by the normal and exponential
+	// samplers below, any power of two up to 1024 (2048 for the
+	// exponential) can be passed instead
+	inline constexpr uint32_t ziggurat_layers = 256;
+
+	namespace detail
+	{
+		// Shapes of the ziggurats in cxx/ziggurat.hpp: the table, the density
+		// and the sampler for the tail beyond the base layer. The normal is
+		// symmetric, its sign is drawn separately.
+		template<typename T, uint32_t Layers>
+		struct normal_shape
+		{
+			using value_type = T;
+			using table = cxx::ziggurat_detail::normal_ziggurat<T, Layers>;
+			static constexpr uint32_t layers = Layers;
+			static constexpr bool symmetric = true;
+
+			static T density(T x)
+			{
+				return cxx::ziggurat_detail::gaussian(x);
+			}
+			// uniform() returns values in (0, 1], keeping the logarithms finite
+			template<typename Uniform>
+			static T tail(Uniform&& uniform)
+			{
+				const T edge = table::edges[1];
+				T x, y;
+				do
+				{
+					x = -T(std::log(uniform())) / edge;
+					y = -T(std::log(uniform()));
+				} while (T(2) * y < x * x);
+				return edge + x;
+			}
+		};
+		template<typename T, uint32_t Layers>
+		struct exponential_shape
+		{
+			using value_type = T;
+			using table = cxx::ziggurat_detail::exponential_ziggurat<T, Layers>;
+			static constexpr uint32_t layers = Layers;
+			static constexpr bool symmetric = false;
+
+			static T density(T x)
+			{
+				return cxx::ziggurat_detail::exponential(x);
+			}
+			// Memoryless, the tail is the distribution shifted by the edge
+			template<typename Uniform>
+			static T tail(Uniform&& uniform)
+			{
+				return table::edges[1] - T(std::log(uniform()));
+			}
+		};
+
+		// Ziggurat sampling from one random word (32 bits for float, 64 for
+		// double): the low bits pick the layer, the next bit is the sign of
+		// symmetric shapes and the bits above give the position in the
+		// layer, all 24 or 21-23 of them for float and the top 53 for double
+		template<typename T>
+		using ziggurat_word = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+
+		template<typename Shape>
+		struct ziggurat_bits
+		{
+			static_assert(std::has_single_bit(Shape::layers));
+			static constexpr uint32_t layer = uint32_t(std::countr_zero(Shape::layers));
+			static constexpr uint32_t uniform_shift = layer + (Shape::symmetric ? 1 : 0);
+			static_assert(uniform_shift <= 11, "the layer and sign bits must leave 53 bits for double");
+			// Scale of the shifted 32 bit word to [0, 1)
+			static constexpr float float_scale = 1.0f / float(uint64_t(1) << (32 - uniform_shift));
+		};
+
+		// Candidate of the word, true if it lies inside the layer's
+		// rectangle and is accepted without further draws
+		template<typename Shape, typename T = typename Shape::value_type>
+		bool ziggurat_candidate(ziggurat_word<T> word, T& value)
+		{
+			using layout = ziggurat_bits<Shape>;
+			const T* edges = Shape::table::edges.data();
+			const uint32_t layer = uint32_t(word & (Shape::layers - 1));
+			T x;
+			if constexpr (sizeof(T) == 4)
+				x = T(word >> layout::uniform_shift) * layout::float_scale * edges[layer];
+			else
+				x = unit_double(word) * edges[layer];
+			value = x;
+			if constexpr (Shape::symmetric)
+			{
+				// Sign bit moved into place, a branch on it would miss half the time
+				const ziggurat_word<T> sign = (word >> layout::layer & 1) << (sizeof(T) * 8 - 1);
+				value = std::bit_cast<T>(std::bit_cast<ziggurat_word<T>>(x) ^ sign);
+			}
+			return x < edges[layer + 1];
+		}
+
+		// Rare part of the ziggurat for a rejected candidate: the tail
+		// beyond the base layer, or the wedge above the layer's rectangle,
+		// tested against the table's densities at the layer edges. Keeps
+		// the sign of value, false if the wedge rejects it.
+		template<typename Shape, typename Engine, typename T = typename Shape::value_type>
+		bool ziggurat_fallback(Engine& engine, uint32_t layer, T& value)
+		{
+			const T* densities = Shape::table::densities.data();
+			auto uniform = [&engine]()
+			{
+				if constexpr (sizeof(T) == 4)
+					return unit_float(bits32(engine));
+				else
+					return unit_double(bits64(engine));
+			};
+
+			if (layer == 0)
+			{
+				value = std::copysign(Shape::tail([&]() { return T(1) - uniform(); }), value);
+				return true;
+			}
+
+			const T low = densities[layer], high = densities[layer + 1];
+			return low + (high - low) * uniform() < Shape::density(std::abs(value));
+		}
+
+		template<typename Shape, typename Engine, typename T = typename Shape::value_type>
+		T sample_ziggurat(Engine& engine)
+		{
+			for (;;)
+			{
+				ziggurat_word<T> word;
+				if constexpr (sizeof(T) == 4)
+					word = bits32(engine);
+				else
+					word = bits64(engine);
+				T value;
+				if (ziggurat_candidate<Shape>(word, value)) [[likely]]
+					return value;
+				if (ziggurat_fallback<Shape>(engine, uint32_t(word & (Shape::layers - 1)), value))
+					return value;
+			}
+		}
+
+		// Candidates of width words at once, the edges are gathered from the
+		// table. Returns the mask of lanes accepted by the rectangle test.
+		// Without gathers the lanes are no faster than sample_ziggurat,
+		// width 0 skips them.
+		template<typename Shape, typename T = typename Shape::value_type>
+		struct ziggurat_lanes
+		{
+			static constexpr uint32_t width = 0;
+		};
+#if defined(BANAN_AVX512)
+		template<typename Shape>
+		struct ziggurat_lanes<Shape, float>
+		{
+			static constexpr uint32_t width = 16;
+
+			static uint32_t candidates(const uint32_t* bits, float* out)
+			{
+				using layout = ziggurat_bits<Shape>;
+				const float* edges = Shape::table::edges.data();
+				__m512i b = _mm512_loadu_si512(bits);
+				__m512i layer = _mm512_and_si512(b, _mm512_set1_epi32(Shape::layers - 1));
+				__m512 unit = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_srli_epi32(b, layout::uniform_shift)), _mm512_set1_ps(layout::float_scale));
+				__m512 x = _mm512_mul_ps(unit, _mm512_i32gather_ps(layer, edges, 4));
+				__mmask16 accepted = _mm512_cmp_ps_mask(x, _mm512_i32gather_ps(layer, edges + 1, 4), _CMP_LT_OQ);
+				if constexpr (Shape::symmetric)
+				{
+					__m512i sign = _mm512_slli_epi32(_mm512_and_si512(b, _mm512_set1_epi32(Shape::layers)), 31 - layout::layer);
+					x = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(x), sign));
+				}
+				_mm512_storeu_ps(out, x);
+				return accepted;
+			}
+		};
+		template<typename Shape>
+		struct ziggurat_lanes<Shape, double>
+		{
+			static constexpr uint32_t width = 8;
+
+			static uint32_t candidates(const uint32_t* bits, double* out)
+			{
+				using layout = ziggurat_bits<Shape>;
+				const double* edges = Shape::table::edges.data();
+				__m512i b = _mm512_loadu_si512(bits);
+				__m512i layer = _mm512_and_si512(b, _mm512_set1_epi64(Shape::layers - 1));
+				// unit_double: 52 bits through the exponent, plus 2^-53 for bit 11
+				__m512d unit = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(_mm512_srli_epi64(b, 12), _mm512_set1_epi64(0x3FF0000000000000))), _mm512_set1_pd(1.0));
+				unit = _mm512_mask_add_pd(unit, _mm512_test_epi64_mask(b, _mm512_set1_epi64(1 << 11)), unit, _mm512_set1_pd(0x1.0p-53));
+				__m512d x = _mm512_mul_pd(unit, _mm512_i64gather_pd(layer, edges, 8));
+				__mmask8 accepted = _mm512_cmp_pd_mask(x, _mm512_i64gather_pd(layer, edges + 1, 8), _CMP_LT_OQ);
+				if constexpr (Shape::symmetric)
+				{
+					__m512i sign = _mm512_slli_epi64(_mm512_and_si512(b, _mm512_set1_epi64(Shape::layers)), 63 - layout::layer);
+					x = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(x), sign));
+				}
+				_mm512_storeu_pd(out, x);
+				return accepted;
+			}
+		};
+#elif defined(BANAN_AVX2)
+		template<typename Shape>
+		struct ziggurat_lanes<Shape, float>
+		{
+			static constexpr uint32_t width = 8;
+
+			static uint32_t candidates(const uint32_t* bits, float* out)
+			{
+				using layout = ziggurat_bits<Shape>;
+				const float* edges = Shape::table::edges.data();
+				__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits));
+				__m256i layer = _mm256_and_si256(b, _mm256_set1_epi32(Shape::layers - 1));
+				__m256 unit = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(b, layout::uniform_shift)), _mm256_set1_ps(layout::float_scale));
+				__m256 x = _mm256_mul_ps(unit, _mm256_i32gather_ps(edges, layer, 4));
+				int accepted = _mm256_movemask_ps(_mm256_cmp_ps(x, _mm256_i32gather_ps(edges + 1, layer, 4), _CMP_LT_OQ));
+				if constexpr (Shape::symmetric)
+				{
+					__m256i sign = _mm256_slli_epi32(_mm256_and_si256(b, _mm256_set1_epi32(Shape::layers)), 31 - layout::layer);
+					x = _mm256_xor_ps(x, _mm256_castsi256_ps(sign));
+				}
+				_mm256_storeu_ps(out, x);
+				return uint32_t(accepted);
+			}
+		};
+		template<typename Shape>
+		struct ziggurat_lanes<Shape, double>
+		{
+			static constexpr uint32_t width = 4;
+
+			static uint32_t candidates(const uint32_t* bits, double* out)
+			{
+				using layout = ziggurat_bits<Shape>;
+				const double* edges = Shape::table::edges.data();
+				__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits));
+				__m256i layer = _mm256_and_si256(b, _mm256_set1_epi64x(Shape::layers - 1));
+				// unit_double: 52 bits through the exponent, plus 2^-53 for bit 11
+				__m256d unit = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(b, 12), _mm256_set1_epi64x(0x3FF0000000000000))), _mm256_set1_pd(1.0));
+				const __m256i low_bit = _mm256_set1_epi64x(1 << 11);
+				unit = _mm256_add_pd(unit, _mm256_and_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(b, low_bit), low_bit)), _mm256_set1_pd(0x1.0p-53)));
+				__m256d x = _mm256_mul_pd(unit, _mm256_i64gather_pd(edges, layer, 8));
+				int accepted = _mm256_movemask_pd(_mm256_cmp_pd(x, _mm256_i64gather_pd(edges + 1, layer, 8), _CMP_LT_OQ));
+				if constexpr (Shape::symmetric)
+				{
+					__m256i sign = _mm256_slli_epi64(_mm256_and_si256(b, _mm256_set1_epi64x(Shape::layers)), 63 - layout::layer);
+					x = _mm256_xor_pd(x, _mm256_castsi256_pd(sign));
+				}
+				_mm256_storeu_pd(out, x);
+				return uint32_t(accepted);
+			}
+		};
+#endif
+
+		// Moves the values of the kept lanes to the front, returns their count
+		template<uint32_t Width, typename T>
+		uint32_t compact_lanes(T* values, uint32_t kept)
+		{
+#if defined(BANAN_AVX512)
+			if constexpr (std::is_same_v<T, float> && Width == 16)
+			{
+				_mm512_mask_compressstoreu_ps(values, __mmask16(kept), _mm512_loadu_ps(values));
+				return uint32_t(std::popcount(kept));
+			}
+			if constexpr (std::is_same_v<T, double> && Width == 8)
+			{
+				_mm512_mask_compressstoreu_pd(values, __mmask8(kept), _mm512_loadu_pd(values));
+				return uint32_t(std::popcount(kept));
+			}
+#endif
+			uint32_t count = 0;
+			for (uint32_t i = 0; i < Width; i++)
+			{
+				values[count] = values[i];
+				count += kept >> i & 1;
+			}
+			return count;
+		}
+
+		// Fills out with values of the standard shape. Whole groups of simd
+		// lanes go through the rectangle test at once and are stored
+		// directly, only the rejected lanes (about 3% for both shapes) take
+		// the scalar wedge and tail paths, after which the group is compacted.
+		template<typename Shape, typename Engine, typename T = typename Shape::value_type>
+		void fill_ziggurat(Engine& engine, std::span<T> out)
+		{
+			using lanes = ziggurat_lanes<Shape>;
+			std::size_t n = 0;
+			if constexpr (lanes::width > 0)
+			{
+				constexpr uint32_t words = sizeof(T) / 4;
+				constexpr uint32_t group = lanes::width * words;
+				constexpr uint32_t all = uint32_t(~uint64_t(0) >> (64 - lanes::width));
+
+				alignas(64) uint32_t bits[256];
+				while (out.size() - n >= lanes::width)
+				{
+					fill_bits(engine, std::span<uint32_t>(bits, 256));
+
+					for (uint32_t g = 0; g < 256 && out.size() - n >= lanes::width; g += group)
+					{
+						T* dst = out.data() + n;
+						uint32_t accepted = lanes::candidates(bits + g, dst);
+						if (accepted == all)
+						{
+							n += lanes::width;
+							continue;
+						}
+
+						for (uint32_t rejected = ~accepted & all; rejected != 0; rejected &= rejected - 1)
+						{
+							const uint32_t i = uint32_t(std::countr_zero(rejected));
+							if (ziggurat_fallback<Shape>(engine, bits[g + i * words] & (Shape::layers - 1), dst[i]))
+								accepted |= 1u << i;
+						}
+						n += compact_lanes<lanes::width>(dst, accepted);
+					}
+				}
+			}
+			for (; n < out.size(); n++)
+				out[n] = sample_ziggurat<Shape>(engine);
+		}
+
+		// out = offset + scale * out
+		template<typename T>
+		void scale_values(std::span<T> out, T offset, T scale)
+		{
+			using native = simd::native_widest<T>;
+			std::size_t i = 0;
+			for (; i + native::lanes <= out.size(); i += native::lanes)
+				native::storeu(out.data() + i, native::add(native::broadcast(offset), native::mul(native::broadcast(scale), native::loadu(out.data() + i))));
+			for (; i < out.size(); i++)
+				out[i] = offset + scale * out[i];
+		}
+	}
+
+	// Normal and exponential values. Engines producing full 32 or 64 bit
+	// words take one word per value (32 bits for float, 64 for double)
+	// through the ziggurat of detail::sample_ziggurat, others go through
+	// the distributions of cxx/ziggurat.hpp.
+	template<typename T, uint32_t Layers = ziggurat_layers, random_engine Engine>
+	typename std::enable_if<std::is_floating_point<T>::value, T>::type get_random_normal(Engine& engine, T mean, T std)
+	{
+		if constexpr (detail::has_bits<std::remove_cvref_t<Engine>> && (sizeof(T) == 4 || sizeof(T) == 8))
+			return mean + std * detail::sample_ziggurat<detail::normal_shape<T, Layers>>(engine);
+		else
+		{
+			cxx::ziggurat_normal_distribution<T, Layers> dist(mean, std);
+			return dist(engine);
+		}
+	}
+	template<typename T, uint32_t Layers = ziggurat_layers>
 	typename std::enable_if<std::is_floating_point<T>::value, T>::type get_random_normal(T mean, T std)
 	{
-		cxx::ziggurat_normal_distribution dist(mean, std);
-		return dist(s_pcg32_fast);
+		return get_random_normal<T, Layers>(thread_generator_for<T>(), mean, std);
+	}
+
+	template<typename T, uint32_t Layers = ziggurat_layers, random_engine Engine>
+	typename std::enable_if<std::is_floating_point<T>::value, T>::type get_random_exponential(Engine& engine, T lambda)
+	{
+		if constexpr (detail::has_bits<std::remove_cvref_t<Engine>> && (sizeof(T) == 4 || sizeof(T) == 8))
+			return detail::sample_ziggurat<detail::exponential_shape<T, Layers>>(engine) / lambda;
+		else
+		{
+			cxx::ziggurat_exponential_distribution<T, Layers> dist(lambda);
+			return dist(engine);
+		}
+	}
+	template<typename T, uint32_t Layers = ziggurat_layers>
+	typename std::enable_if<std::is_floating_point<T>::value, T>::type get_random_exponential(T lambda)
+	{
+		return get_random_exponential<T, Layers>(thread_generator_for<T>(), lambda);
+	}
+
+	// Fills out with normal or exponential values through the simd
+	// ziggurat of detail::fill_ziggurat, which needs gathers (AVX2). Other
+	// builds draw the values one by one. The values may differ from repeated
+	// get_random_normal / get_random_exponential calls on the same engine.
+	template<typename T, uint32_t Layers = ziggurat_layers, random_engine Engine> requires std::is_floating_point_v<T>
+	void fill_normal(Engine& engine, std::span<T> out, T mean = T(0), T stddev = T(1))
+	{
+		using E = std::remove_cvref_t<Engine>;
+		if constexpr (!detail::has_bits<E> || (sizeof(T) != 4 && sizeof(T) != 8))
+		{
+			cxx::ziggurat_normal_distribution<T, Layers> dist(mean, stddev);
+			for (T& value : out)
+				value = dist(engine);
+		}
+		else
+		{
+			detail::fill_ziggurat<detail::normal_shape<T, Layers>>(engine, out);
+			if (mean != T(0) || stddev != T(1))
+				detail::scale_values(out, mean, stddev);
+		}
+	}
+	template<typename T, uint32_t Layers = ziggurat_layers> requires std::is_floating_point_v<T>
+	void fill_normal(std::span<T> out, T mean = T(0), T stddev = T(1))
+	{
+		fill_normal<T, Layers>(thread_generator_for<T>(), out, mean, stddev);
+	}
+
+	template<typename T, uint32_t Layers = ziggurat_layers, random_engine Engine> requires std::is_floating_point_v<T>
+	void fill_exponential(Engine& engine, std::span<T> out, T lambda = T(1))
+	{
+		using E = std::remove_cvref_t<Engine>;
+		if constexpr (!detail::has_bits<E> || (sizeof(T) != 4 && sizeof(T) != 8))
+		{
+			cxx::ziggurat_exponential_distribution<T, Layers> dist(lambda);
+			for (T& value : out)
+				value = dist(engine);
+		}
+		else
+		{
+			detail::fill_ziggurat<detail::exponential_shape<T, Layers>>(engine, out);
+			if (lambda != T(1))
+				detail::scale_values(out, T(0), T(1) / lambda);
+		}
+	}
+	template<typename T, uint32_t Layers = ziggurat_layers> requires std::is_floating_point_v<T>
+	void fill_exponential(std::span<T> out, T lambda = T(1))
+	{
+		fill_exponential<T, Layers>(thread_generator_for<T>(), out, lambda);
+	}
+
+	namespace detail
+	{
+		// Marsaglia and Tsang's method for Gamma(shape >= 1): d * (1 + c * x)^3
+		// of a standard normal x is accepted against a uniform u. About 95%
+		// (shape 1) to over 99% (large shapes) of the pairs are accepted,
+		// nearly all of them by the squeeze before the logarithms.
+		template<typename T>
+		struct gamma_params
+		{
+			T d, c;
+
+			explicit gamma_params(T shape)
+				: d(shape - T(1) / T(3)), c(T(1) / std::sqrt(T(9) * (shape - T(1) / T(3))))
+			{ }
+
+			bool accept(T x, T u, T& value) const
+			{
+				T v = T(1) + c * x;
+				if (v <= T(0))
+					return false;
+				v = v * v * v;
+				value = d * v;
+				const T x2 = x * x;
+				return u < T(1) - T(0.0331) * x2 * x2 || std::log(u) < T(0.5) * x2 + d * (T(1) - v + std::log(v));
+			}
+
+			template<typename Engine>
+			T sample(Engine& engine) const
+			{
+				T value;
+				for (;;)
+				{
+					const T x = get_random_normal<T>(engine, T(0), T(1));
+					const T u = get_random_uniform<T>(engine);
+					if (accept(x, u, value))
+						return value;
+				}
+			}
+		};
+	}
+
+	namespace detail
+	{
+		// log of a Gamma(shape) value. Shapes below 1 boost Gamma(shape + 1)
+		// by u^(1 / shape), which underflows to 0 for small shapes, so the
+		// boost is added as log(u) / shape instead.
+		template<typename T, typename Engine>
+		T log_gamma(Engine& engine, T shape)
+		{
+			assert(shape > T(0) && "gamma shape must be positive");
+			if (shape < T(1))
+				return std::log(gamma_params<T>(shape + T(1)).sample(engine)) + std::log(get_random_uniform<T>(engine)) / shape;
+			return std::log(gamma_params<T>(shape).sample(engine));
+		}
+
+		// Same for an array, the normals and uniforms are drawn a block at a
+		// time through fill_normal and fill_uniform, only rejected pairs are
+		// redrawn one by one. With Log the values are logarithms.
+		template<bool Log, typename T, typename Engine>
+		void fill_gamma(Engine& engine, std::span<T> out, T shape)
+		{
+			assert(shape > T(0) && "gamma shape must be positive");
+			const bool boost = shape < T(1);
+			const gamma_params<T> params(boost ? shape + T(1) : shape);
+			alignas(64) T normals[256], uniforms[256];
+			for (std::size_t base = 0; base < out.size(); base += 256)
+			{
+				const std::size_t count = std::min<std::size_t>(256, out.size() - base);
+				T* dst = out.data() + base;
+				fill_normal<T>(engine, std::span<T>(normals, count));
+				fill_uniform<T>(engine, std::span<T>(uniforms, count));
+				for (std::size_t i = 0; i < count; i++)
+					if (!params.accept(normals[i], uniforms[i], dst[i]))
+						dst[i] = params.sample(engine);
+
+				if (boost)
+				{
+					fill_uniform<T>(engine, std::span<T>(uniforms, count));
+					for (std::size_t i = 0; i < count; i++)
+						dst[i] = std::log(dst[i]) + std::log(uniforms[i]) / shape;
+					if constexpr (!Log)
+						for (std::size_t i = 0; i < count; i++)
+							dst[i] = std::exp(dst[i]);
+				}
+				else if constexpr (Log)
+				{
+					for (std::size_t i = 0; i < count; i++)
+						dst[i] = std::log(dst[i]);
+				}
+			}
+		}
+
+		// x / (x + y) of two log values, shifted by their maximum so the
+		// larger one is 1 and the sum does not underflow
+		template<typename T>
+		T log_ratio(T log_x, T log_y)
+		{
+			const T top = std::max(log_x, log_y);
+			const T x = std::exp(log_x - top);
+			return x / (x + std::exp(log_y - top));
+		}
+	}
+
+	// Gamma values of the given shape (k) and scale (theta), with mean
+	// shape * scale. Shapes below 1 draw Gamma(shape + 1) * u^(1 / shape),
+	// values below the smallest positive T come out as 0. The shape must
+	// be positive.
+	template<typename T, random_engine Engine>
+	typename std::enable_if<std::is_floating_point<T>::value, T>::type get_random_gamma(Engine& engine, T shape, T scale = T(1))
+	{
+		assert(shape > T(0) && "gamma shape must be positive");
+		if (shape < T(1))
+			return scale * std::exp(detail::log_gamma<T>(engine, shape));
+		return scale * detail::gamma_params<T>(shape).sample(engine);
+	}
+	template<typename T>
+	typename std::enable_if<std::is_floating_point<T>::value, T>::type get_random_gamma(T shape, T scale = T(1))
+	{
+		return get_random_gamma<T>(thread_generator_for<T>(), shape, scale);
+	}
+
+	// Beta(a, b) values in [0, 1], X / (X + Y) of X ~ Gamma(a), Y ~ Gamma(b).
+	// Shapes below 1 divide in log space, where X and Y cannot both
+	// underflow.
+	template<typename T, random_engine Engine>
+	typename std::enable_if<std::is_floating_point<T>::value, T>::type get_random_beta(Engine& engine, T a, T b)
+	{
+		if (a < T(1) || b < T(1))
+		{
+			const T log_x = detail::log_gamma<T>(engine, a);
+			return detail::log_ratio(log_x, detail::log_gamma<T>(engine, b));
+		}
+		const T x = get_random_gamma<T>(engine, a);
+		const T y = get_random_gamma<T>(engine, b);
+		return x / (x + y);
+	}
+	template<typename T>
+	typename std::enable_if<std::is_floating_point<T>::value, T>::type get_random_beta(T a, T b)
+	{
+		return get_random_beta<T>(thread_generator_for<T>(), a, b);
+	}
+
+	// Fills out with Gamma or Beta values. The normals and uniforms are
+	// drawn a block at a time through fill_normal and fill_uniform, only
+	// rejected pairs are redrawn one by one.
+	template<typename T, random_engine Engine> requires std::is_floating_point_v<T>
+	void fill_gamma(Engine& engine, std::span<T> out, T shape, T scale = T(1))
+	{
+		detail::fill_gamma<false>(engine, out, shape);
+		if (scale != T(1))
+			detail::scale_values(out, T(0), scale);
+	}
+	template<typename T> requires std::is_floating_point_v<T>
+	void fill_gamma(std::span<T> out, T shape, T scale = T(1))
+	{
+		fill_gamma<T>(thread_generator_for<T>(), out, shape, scale);
+	}
+
+	template<typename T, random_engine Engine> requires std::is_floating_point_v<T>
+	void fill_beta(Engine& engine, std::span<T> out, T a, T b)
+	{
+		const bool log_space = a < T(1) || b < T(1);
+		if (log_space)
+			detail::fill_gamma<true>(engine, out, a);
+		else
+			detail::fill_gamma<false>(engine, out, a);
+		alignas(64) T y[256];
+		for (std::size_t base = 0; base < out.size(); base += 256)
+		{
+			const std::size_t count = std::min<std::size_t>(256, out.size() - base);
+			if (log_space)
+			{
+				detail::fill_gamma<true>(engine, std::span<T>(y, count), b);
+				for (std::size_t i = 0; i < count; i++)
+					out[base + i] = detail::log_ratio(out[base + i], y[i]);
+			}
+			else
+			{
+				detail::fill_gamma<false>(engine, std::span<T>(y, count), b);
+				for (std::size_t i = 0; i < count; i++)
+					out[base + i] /= out[base + i] + y[i];
+			}
+		}
+	}
+	template<typename T> requires std::is_floating_point_v<T>
+	void fill_beta(std::span<T> out, T a, T b)
+	{
+		fill_beta<T>(thread_generator_for<T>(), out, a, b);
+	}
+
+	namespace detail
+	{
+		// One Dirichlet draw into at(0) ... at(k - 1). With any alpha below 1
+		// the Gamma values are drawn as logarithms and shifted by their
+		// maximum before exp, so the largest is 1 and the sum cannot be 0.
+		template<typename T, typename Engine, typename At>
+		void get_random_dirichlet(Engine& engine, std::span<const T> alpha, const At& at)
+		{
+			const bool log_space = std::any_of(alpha.begin(), alpha.end(), [](T a) { return a < T(1); });
+			T top = -std::numeric_limits<T>::infinity();
+			for (std::size_t k = 0; k < alpha.size(); k++)
+			{
+				at(k) = log_space ? log_gamma<T>(engine, alpha[k]) : get_random_gamma<T>(engine, alpha[k]);
+				top = std::max(top, at(k));
+			}
+			T sum = T(0);
+			for (std::size_t k = 0; k < alpha.size(); k++)
+			{
+				if (log_space)
+					at(k) = std::exp(at(k) - top);
+				sum += at(k);
+			}
+			const T scale = T(1) / sum;
+			for (std::size_t k = 0; k < alpha.size(); k++)
+				at(k) *= scale;
+		}
+
+		// count Dirichlet draws, at(i, k) is component k of draw i. The
+		// Gamma values of a block of draws are filled one component at a
+		// time, in log space as above when any alpha is below 1.
+		template<typename T, typename Engine, typename At>
+		void fill_dirichlet(Engine& engine, std::size_t count, std::span<const T> alpha, const At& at)
+		{
+			const bool log_space = std::any_of(alpha.begin(), alpha.end(), [](T a) { return a < T(1); });
+			alignas(64) T gamma[256], top[256], sum[256];
+			for (std::size_t base = 0; base < count; base += 256)
+			{
+				const std::size_t n = std::min<std::size_t>(256, count - base);
+				std::fill_n(top, n, -std::numeric_limits<T>::infinity());
+				std::fill_n(sum, n, T(0));
+				for (std::size_t k = 0; k < alpha.size(); k++)
+				{
+					if (log_space)
+						fill_gamma<true>(engine, std::span<T>(gamma, n), alpha[k]);
+					else
+						fill_gamma<false>(engine, std::span<T>(gamma, n), alpha[k]);
+					for (std::size_t i = 0; i < n; i++)
+					{
+						top[i] = std::max(top[i], gamma[i]);
+						at(base + i, k) = gamma[i];
+					}
+				}
+				for (std::size_t k = 0; k < alpha.size(); k++)
+					for (std::size_t i = 0; i < n; i++)
+					{
+						T& value = at(base + i, k);
+						if (log_space)
+							value = std::exp(value - top[i]);
+						sum[i] += value;
+					}
+				for (std::size_t i = 0; i < n; i++)
+					sum[i] = T(1) / sum[i];
+				for (std::size_t k = 0; k < alpha.size(); k++)
+					for (std::size_t i = 0; i < n; i++)
+						at(base + i, k) *= sum[i];
+			}
+		}
+	}
+
+	// Dirichlet(alpha) draws of alpha.size() components each, positive
+	// and adding up to 1. out holds out.size() / alpha.size() draws one
+	// after the other, a single draw when the sizes are equal, and its size
+	// must be a multiple of alpha.size(). vec.h has the same for
+	// vec<Ty, Size>.
+	template<typename T, random_engine Engine> requires std::is_floating_point_v<T>
+	void fill_dirichlet(Engine& engine, std::span<T> out, std::type_identity_t<std::span<const T>> alpha)
+	{
+		const std::size_t k = alpha.size();
+		if (k == 0)
+			return;
+		assert(out.size() % k == 0 && "fill_dirichlet needs whole draws");
+		if (out.size() == k)
+		{
+			detail::get_random_dirichlet<T>(engine, alpha, [&](std::size_t c) -> T& { return out[c]; });
+			return;
+		}
+		detail::fill_dirichlet<T>(engine, out.size() / k, alpha, [&](std::size_t i, std::size_t c) -> T& { return out[i * k + c]; });
+	}
+	template<typename T> requires std::is_floating_point_v<T>
+	void fill_dirichlet(std::span<T> out, std::type_identity_t<std::span<const T>> alpha)
+	{
+		fill_dirichlet<T>(thread_generator_for<T>(), out, alpha);
 	}
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+
+#include "random.h"
+#include "simd.h"
+
+// pcg32_lanes<Lanes> runs Lanes independent pcg32 generators side by side
+// and produces their outputs a block (one value per lane) at a time. The
+// 64 bit LCG steps of the lanes do not depend on each other, so they run
+// in simd registers (4 lanes per AVX2 register, 8 per AVX-512 register)
+// or at least overlap in the pipeline, instead of one serial step per
+// value as in pcg32.
+//
+// Lane i produces exactly the sequence of random_streams(seed).stream(
+// first_stream + i), the engine returns the lanes interleaved: lane 0,
+// lane 1, ..., lane Lanes - 1, lane 0, ...
+//
+// The engine satisfies random_engine, so it works with every function in
+// random.h. fill() writes whole blocks straight into the caller's buffer.
+
+namespace Banan
+{
+
+	template<uint32_t Lanes>
+	class pcg32_lanes
+	{
+	public:
+		using result_type = uint32_t;
+		static constexpr uint32_t lanes = Lanes;
+
+	private:
+		static constexpr uint64_t multiplier = 6364136223846793005ull;
+
+	public:
+		// Constructors
+		explicit pcg32_lanes(uint64_t seed = 0, uint64_t first_stream = 0)
+		{
+			this->seed(seed, first_stream);
+		}
+
+		void seed(uint64_t seed, uint64_t first_stream = 0)
+		{
+			// Same seeding as stream_engine(state, stream)
+			for (uint32_t i = 0; i < Lanes; i++)
+			{
+				const uint64_t stream = first_stream + i;
+				m_inc[i] = (stream << 1) | 1;
+				m_state[i] = (detail::thread_seed(seed, stream) + m_inc[i]) * multiplier + m_inc[i];
+			}
+			m_next = Lanes;
+		}
+
+		static constexpr result_type min()
+		{
+			return 0;
+		}
+		static constexpr result_type max()
+		{
+			return std::numeric_limits<uint32_t>::max();
+		}
+
+		result_type operator()()
+		{
+			if (m_next == Lanes)
+			{
+				generate(m_buffer, 1);
+				m_next = 0;
+			}
+			return m_buffer[m_next++];
+		}
+
+		// Next out.size() values of the sequence
+		void fill(std::span<uint32_t> out)
+		{
+			std::size_t i = 0;
+			for (; i < out.size() && m_next < Lanes; i++)
+				out[i] = m_buffer[m_next++];
+			const std::size_t blocks = (out.size() - i) / Lanes;
+			generate(out.data() + i, blocks);
+			for (i += blocks * Lanes; i < out.size(); i++)
+				out[i] = (*this)();
+		}
+
+		void discard(unsigned long long count)
+		{
+			for (; count > 0; count--)
+				(*this)();
+		}
+
+	private:
+#if defined(BANAN_AVX512)
+		struct reg
+		{
+			static constexpr uint32_t width = 8;
+			using type = __m512i;
+
+			static type load(const uint64_t* src)			{ return _mm512_load_si512(src); }
+			static void store(uint64_t* dst, type a)		{ _mm512_store_si512(dst, a); }
+
+			// pcg32 output of state into out, returns the next state
+			static type step(type state, type inc, uint32_t* out)
+			{
+				type xorshifted = _mm512_and_si512(_mm512_srli_epi64(_mm512_xor_si512(_mm512_srli_epi64(state, 18), state), 27), _mm512_set1_epi64(0xFFFFFFFF));
+				type rot = _mm512_srli_epi64(state, 59);
+				type result = _mm512_or_si512(_mm512_srlv_epi64(xorshifted, rot), _mm512_sllv_epi64(xorshifted, _mm512_sub_epi64(_mm512_set1_epi64(32), rot)));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm512_cvtepi64_epi32(result));
+
+				// Low 64 bits of state * multiplier from 32 x 32 bit products
+				const type lo = _mm512_set1_epi64(multiplier & 0xFFFFFFFF);
+				const type hi = _mm512_set1_epi64(multiplier >> 32);
+				type cross = _mm512_add_epi64(_mm512_mul_epu32(_mm512_srli_epi64(state, 32), lo), _mm512_mul_epu32(state, hi));
+				return _mm512_add_epi64(_mm512_add_epi64(_mm512_mul_epu32(state, lo), _mm512_slli_epi64(cross, 32)), inc);
+			}
+		};
+#elif defined(BANAN_AVX2)
+		struct reg
+		{
+			static constexpr uint32_t width = 4;
+			using type = __m256i;
+
+			static type load(const uint64_t* src)			{ return _mm256_load_si256(reinterpret_cast<const __m256i*>(src)); }
+			static void store(uint64_t* dst, type a)		{ _mm256_store_si256(reinterpret_cast<__m256i*>(dst), a); }
+
+			// pcg32 output of state into out, returns the next state
+			static type step(type state, type inc, uint32_t* out)
+			{
+				type xorshifted = _mm256_and_si256(_mm256_srli_epi64(_mm256_xor_si256(_mm256_srli_epi64(state, 18), state), 27), _mm256_set1_epi64x(0xFFFFFFFF));
+				type rot = _mm256_srli_epi64(state, 59);
+				type result = _mm256_or_si256(_mm256_srlv_epi64(xorshifted, rot), _mm256_sllv_epi64(xorshifted, _mm256_sub_epi64(_mm256_set1_epi64x(32), rot)));
+				// Low halves of the 64 bit lanes are the outputs
+				result = _mm256_permutevar8x32_epi32(result, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(result));
+
+				// Low 64 bits of state * multiplier from 32 x 32 bit products
+				const type lo = _mm256_set1_epi64x(multiplier & 0xFFFFFFFF);
+				const type hi = _mm256_set1_epi64x(multiplier >> 32);
+				type cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(state, 32), lo), _mm256_mul_epu32(state, hi));
+				return _mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epu32(state, lo), _mm256_slli_epi64(cross, 32)), inc);
+			}
+		};
+#else
+		struct reg
+		{
+			static constexpr uint32_t width = 0;
+		};
+#endif
+
+		// Lanes held in registers, the rest run as scalars
+		static constexpr uint32_t reg_count = reg::width ? Lanes / reg::width : 0;
+		static constexpr uint32_t scalar_first = reg_count * reg::width;
+
+		// blocks rows of one output per lane. The states are kept in locals
+		// for the whole run so the steps of the lanes overlap.
+		void generate(uint32_t* out, std::size_t blocks)
+		{
+			uint64_t state[Lanes], inc[Lanes];
+			for (uint32_t i = scalar_first; i < Lanes; i++)
+			{
+				state[i] = m_state[i];
+				inc[i] = m_inc[i];
+			}
+
+			if constexpr (reg_count > 0)
+			{
+				typename reg::type vstate[reg_count], vinc[reg_count];
+				for (uint32_t r = 0; r < reg_count; r++)
+				{
+					vstate[r] = reg::load(m_state + r * reg::width);
+					vinc[r] = reg::load(m_inc + r * reg::width);
+				}
+				for (std::size_t b = 0; b < blocks; b++)
+				{
+					uint32_t* row = out + b * Lanes;
+					for (uint32_t r = 0; r < reg_count; r++)
+						vstate[r] = reg::step(vstate[r], vinc[r], row + r * reg::width);
+					step_scalars(state, inc, row);
+				}
+				for (uint32_t r = 0; r < reg_count; r++)
+					reg::store(m_state + r * reg::width, vstate[r]);
+			}
+			else
+			{
+				for (std::size_t b = 0; b < blocks; b++)
+					step_scalars(state, inc, out + b * Lanes);
+			}
+
+			for (uint32_t i = scalar_first; i < Lanes; i++)
+				m_state[i] = state[i];
+		}
+
+		// Steps the scalar lanes, expanded at compile time so the states
+		// stay in registers
+		static void step_scalars(uint64_t* state, const uint64_t* inc, uint32_t* row)
+		{
+			[&]<uint32_t... I>(std::integer_sequence<uint32_t, I...>)
+			{
+				((row[scalar_first + I] = step(state[scalar_first + I], inc[scalar_first + I])), ...);
+			}(std::make_integer_sequence<uint32_t, Lanes - scalar_first>());
+		}
+
+		// pcg32's xsh_rr output of the current state followed by an LCG step
+		static uint32_t step(uint64_t& state, uint64_t inc)
+		{
+			const uint32_t xorshifted = uint32_t(((state >> 18) ^ state) >> 27);
+			const uint32_t rot = uint32_t(state >> 59);
+			state = state * multiplier + inc;
+			return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+		}
+
+	private:
+		alignas(64) uint64_t m_state[Lanes];
+		alignas(64) uint64_t m_inc[Lanes];
+		alignas(64) uint32_t m_buffer[Lanes];
+		uint32_t m_next;
+	};
+
+	// Lane count filling the widest available registers twice, two
+	// independent dependency chains hide the multiply latency
+#if defined(BANAN_AVX512)
+	using pcg32_simd = pcg32_lanes<16>;
+#elif defined(BANAN_AVX2)
+	using pcg32_simd = pcg32_lanes<8>;
+#else
+	using pcg32_simd = pcg32_lanes<4>;
+#endif
+
+}
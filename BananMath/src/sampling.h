@@ -0,0 +1,507 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <span>
+#include <type_traits>
+
+#include "random.h"
+#include "simd.h"
+#include "vec.h"
+#include "vec_packet.h"
+
+// Direction sampling around a normal for path tracing: uniform and cosine
+// weighted hemispheres, cones (lights seen under a solid angle) and the
+// half vectors of the GGX and Beckmann microfacet distributions.
+//
+//	vec3f wi = random_cosine_hemisphere(engine, n);
+//	float pdf = cosine_hemisphere_pdf(dot(wi, n));
+//
+// Every sampler comes for one vector, for a vec_packet of normals and for
+// spans of normals (fill_*), with and without an engine. The pdfs are per
+// unit solid angle and take either scalars or packets.
+//
+// The directions are built in the frame of the normal from the concentric
+// disc map of vec.h: the radius of the disc point fixes the angle to the
+// normal and its direction on the unit circle gives the azimuth, so no
+// sample takes a branch or a trig call. The frame itself comes from the
+// normal alone (Duff et al., Building an Orthonormal Basis, Revisited).
+// Normals must be unit length.
+
+namespace Banan
+{
+
+	namespace detail
+	{
+		// Maps (x, y, z) in the frame where n is +z to world space
+		template<typename N, typename Ty>
+		void to_normal_frame(typename N::type nx, typename N::type ny, typename N::type nz, typename N::type& x, typename N::type& y, typename N::type& z)
+		{
+			using T = typename N::type;
+			const T sign = N::mask_or(N::broadcast(Ty(1)), N::mask_and(nz, N::broadcast(Ty(-0.0))));
+			const T a = N::div(N::broadcast(Ty(-1)), N::add(sign, nz));
+			const T b = N::mul(N::mul(nx, ny), a);
+
+			// Tangent (1 + sign nx^2 a, sign b, -sign nx), bitangent (b, sign + ny^2 a, -ny)
+			const T tx = N::add(N::broadcast(Ty(1)), N::mul(N::mul(sign, N::mul(nx, nx)), a));
+			const T ty = N::mul(sign, b);
+			const T tz = N::neg(N::mul(sign, nx));
+			const T by = N::add(sign, N::mul(N::mul(ny, ny), a));
+
+			const T wx = N::add(N::add(N::mul(x, tx), N::mul(y, b)), N::mul(z, nx));
+			const T wy = N::add(N::add(N::mul(x, ty), N::mul(y, by)), N::mul(z, ny));
+			const T wz = N::add(N::sub(N::mul(x, tz), N::mul(y, ny)), N::mul(z, nz));
+			x = wx;
+			y = wy;
+			z = wz;
+		}
+
+		// Local frame kernels, (a, b) is uniform on [-1, 1)^2, e is a unit
+		// exponential value (used by Beckmann only) and p the parameter of
+		// the distribution. The disc point of (a, b) has its squared radius
+		// uniform on [0, 1), which is inverted into the cosine to the normal.
+
+		// Uniform in the cone around +z with p = cos_max, the height
+		// 1 - r^2 (1 - p) is uniform on [cos_max, 1]. p = 0 is the
+		// hemisphere.
+		struct cone_kernel
+		{
+			static constexpr bool exponential = false;
+			template<typename N, typename Ty>
+			static void sample(typename N::type a, typename N::type b, typename N::type, typename N::type p, typename N::type& x, typename N::type& y, typename N::type& z)
+			{
+				using T = typename N::type;
+				T radius;
+				concentric<N, Ty>(a, b, x, y, radius);
+				const T q = N::mul(N::mul(radius, radius), N::sub(N::broadcast(Ty(1)), p));
+				const T sin_theta = N::sqrt(N::max(N::mul(q, N::sub(N::broadcast(Ty(2)), q)), N::broadcast(Ty(0))));
+				x = N::mul(x, sin_theta);
+				y = N::mul(y, sin_theta);
+				z = N::sub(N::broadcast(Ty(1)), q);
+			}
+		};
+
+		// Cosine weighted, the disc point lifted onto the hemisphere (Malley)
+		struct cosine_kernel
+		{
+			static constexpr bool exponential = false;
+			template<typename N, typename Ty>
+			static void sample(typename N::type a, typename N::type b, typename N::type, typename N::type, typename N::type& x, typename N::type& y, typename N::type& z)
+			{
+				using T = typename N::type;
+				T radius;
+				concentric<N, Ty>(a, b, x, y, radius);
+				x = N::mul(x, radius);
+				y = N::mul(y, radius);
+				z = N::sqrt(N::max(N::sub(N::broadcast(Ty(1)), N::mul(radius, radius)), N::broadcast(Ty(0))));
+			}
+		};
+
+		// GGX half vector with p = alpha, D(h) cos(h) inverted:
+		// cos^2 = (1 - u) / (1 + (alpha^2 - 1) u), sin^2 = alpha^2 u / (...)
+		struct ggx_kernel
+		{
+			static constexpr bool exponential = false;
+			template<typename N, typename Ty>
+			static void sample(typename N::type a, typename N::type b, typename N::type, typename N::type p, typename N::type& x, typename N::type& y, typename N::type& z)
+			{
+				using T = typename N::type;
+				T radius;
+				concentric<N, Ty>(a, b, x, y, radius);
+				const T u = N::mul(radius, radius);
+				const T alpha2 = N::mul(p, p);
+				const T inv = N::div(N::broadcast(Ty(1)), N::add(N::broadcast(Ty(1)), N::mul(N::sub(alpha2, N::broadcast(Ty(1))), u)));
+				const T sin_theta = N::sqrt(N::mul(N::mul(alpha2, u), inv));
+				x = N::mul(x, sin_theta);
+				y = N::mul(y, sin_theta);
+				z = N::sqrt(N::mul(N::sub(N::broadcast(Ty(1)), u), inv));
+			}
+		};
+
+		// Beckmann half vector with p = alpha, tan^2 = alpha^2 e for a unit
+		// exponential e, which stands in for -log(1 - u)
+		struct beckmann_kernel
+		{
+			static constexpr bool exponential = true;
+			template<typename N, typename Ty>
+			static void sample(typename N::type a, typename N::type b, typename N::type e, typename N::type p, typename N::type& x, typename N::type& y, typename N::type& z)
+			{
+				using T = typename N::type;
+				T radius;
+				concentric<N, Ty>(a, b, x, y, radius);
+				const T tan2 = N::mul(N::mul(p, p), e);
+				const T inv = N::div(N::broadcast(Ty(1)), N::add(N::broadcast(Ty(1)), tan2));
+				const T sin_theta = N::sqrt(N::mul(tan2, inv));
+				x = N::mul(x, sin_theta);
+				y = N::mul(y, sin_theta);
+				z = N::sqrt(inv);
+			}
+		};
+
+		// Draws the inputs of kernel for one direction around n
+		template<typename Kernel, typename Ty, random_engine Engine>
+		vec<Ty, 3> sample_direction(Engine& engine, const vec<Ty, 3>& n, Ty p)
+		{
+			using N = simd::native<Ty, 1>;
+			const Ty a = get_random_uniform<Ty>(engine, Ty(-1), Ty(1));
+			const Ty b = get_random_uniform<Ty>(engine, Ty(-1), Ty(1));
+			Ty e = Ty(0);
+			if constexpr (Kernel::exponential)
+				e = get_random_exponential<Ty>(engine, Ty(1));
+
+			Ty x, y, z;
+			Kernel::template sample<N, Ty>(a, b, e, p, x, y, z);
+			to_normal_frame<N, Ty>(n.x, n.y, n.z, x, y, z);
+			return vec<Ty, 3>(x, y, z);
+		}
+
+		// Same for every lane of a packet, register by register
+		template<typename Kernel, typename Ty, uint32_t Width, random_engine Engine>
+		vec_packet<Ty, 3, Width> sample_direction(Engine& engine, const vec_packet<Ty, 3, Width>& n, const packet<Ty, Width>& p)
+		{
+			using N = simd::native_for<Ty, Width>;
+			packet<Ty, Width> a, b, e(Ty(0));
+			fill_uniform<Ty>(engine, std::span<Ty>(a.lanes), Ty(-1), Ty(1));
+			fill_uniform<Ty>(engine, std::span<Ty>(b.lanes), Ty(-1), Ty(1));
+			// A packet is too short to pay for the setup of fill_exponential
+			if constexpr (Kernel::exponential)
+				for (Ty& value : e.lanes)
+					value = get_random_exponential<Ty>(engine, Ty(1));
+
+			vec_packet<Ty, 3, Width> result;
+			for (uint32_t i = 0; i < Width / N::lanes; i++)
+			{
+				auto& x = result.x.regs[i];
+				auto& y = result.y.regs[i];
+				auto& z = result.z.regs[i];
+				Kernel::template sample<N, Ty>(a.regs[i], b.regs[i], e.regs[i], p.regs[i], x, y, z);
+				to_normal_frame<N, Ty>(n.x.regs[i], n.y.regs[i], n.z.regs[i], x, y, z);
+			}
+			return result;
+		}
+
+		// Inputs convert from any span or container, the element type is
+		// deduced from the output span
+		template<typename Ty>
+		using normal_input = std::type_identity_t<std::span<const vec<Ty, 3>>>;
+		template<typename Ty>
+		using parameter_input = std::type_identity_t<std::span<const Ty>>;
+
+		// One direction per normal, a block at a time. The parameter is
+		// params[i] per direction, or p for all when params is empty. The
+		// widest native register runs the kernel, native<Ty, 1> the tail.
+		template<typename Kernel, typename Ty, random_engine Engine>
+		void fill_directions(Engine& engine, std::span<const vec<Ty, 3>> normals, std::span<const Ty> params, Ty p, std::span<vec<Ty, 3>> out)
+		{
+			using native = simd::native_widest<Ty>;
+			using scalar = simd::native<Ty, 1>;
+			constexpr std::size_t block = 256;
+			alignas(64) Ty a[block], b[block], e[block], param[block];
+			alignas(64) Ty x[block], y[block], z[block];
+			assert(normals.size() >= out.size() && "fill_directions has fewer normals than outputs");
+			assert((params.empty() || params.size() >= out.size()) && "fill_directions has fewer parameters than outputs");
+
+			const auto run = [&]<typename N>(N, std::size_t i)
+			{
+				typename N::type lx, ly, lz;
+				const typename N::type ei = Kernel::exponential ? N::load(e + i) : N::broadcast(Ty(0));
+				Kernel::template sample<N, Ty>(N::load(a + i), N::load(b + i), ei, N::load(param + i), lx, ly, lz);
+				to_normal_frame<N, Ty>(N::load(x + i), N::load(y + i), N::load(z + i), lx, ly, lz);
+				N::store(x + i, lx);
+				N::store(y + i, ly);
+				N::store(z + i, lz);
+			};
+
+			for (std::size_t base = 0; base < out.size(); base += block)
+			{
+				const std::size_t count = std::min(block, out.size() - base);
+				fill_uniform<Ty>(engine, std::span<Ty>(a, count), Ty(-1), Ty(1));
+				fill_uniform<Ty>(engine, std::span<Ty>(b, count), Ty(-1), Ty(1));
+				if constexpr (Kernel::exponential)
+					fill_exponential<Ty>(engine, std::span<Ty>(e, count));
+				if (params.empty())
+					std::fill(param, param + count, p);
+				else
+					std::copy(params.begin() + base, params.begin() + base + count, param);
+
+				// Normals in, directions out in the same SoA arrays
+				for (std::size_t i = 0; i < count; i++)
+				{
+					x[i] = normals[base + i].x;
+					y[i] = normals[base + i].y;
+					z[i] = normals[base + i].z;
+				}
+
+				std::size_t i = 0;
+				for (; i + native::lanes <= count; i += native::lanes)
+					run(native(), i);
+				for (; i < count; i++)
+					run(scalar(), i);
+
+				for (i = 0; i < count; i++)
+					out[base + i] = vec<Ty, 3>(x[i], y[i], z[i]);
+			}
+		}
+
+		// Lane-wise helpers so the pdfs take scalars and packets alike
+		template<typename Ty>
+		struct lane_of
+		{
+			using type = Ty;
+		};
+		template<typename Ty, uint32_t Width>
+		struct lane_of<packet<Ty, Width>>
+		{
+			using type = Ty;
+		};
+		template<typename Ty>
+		Ty select(bool mask, Ty a, Ty b)
+		{
+			return mask ? a : b;
+		}
+		template<typename Ty>
+		Ty exp(Ty x)
+		{
+			return std::exp(x);
+		}
+		template<typename Ty, uint32_t Width>
+		packet<Ty, Width> exp(packet<Ty, Width> p)
+		{
+			for (uint32_t i = 0; i < Width; i++)
+				p.lanes[i] = std::exp(p.lanes[i]);
+			return p;
+		}
+	}
+
+	/* ########################## Pdfs ########################### */
+
+	// Densities per unit solid angle of the samplers below, for scalars or
+	// packets. cos_theta is the cosine between the direction and the normal.
+	template<typename Ty>
+	constexpr Ty hemisphere_pdf()
+	{
+		return Ty(0.5) * std::numbers::inv_pi_v<Ty>;
+	}
+	template<typename T>
+	T cosine_hemisphere_pdf(const T& cos_theta)
+	{
+		using Ty = typename detail::lane_of<T>::type;
+		using std::max;
+		return max(cos_theta, T(Ty(0))) * T(std::numbers::inv_pi_v<Ty>);
+	}
+	template<typename T>
+	T cone_pdf(const T& cos_max)
+	{
+		using Ty = typename detail::lane_of<T>::type;
+		return T(Ty(0.5) * std::numbers::inv_pi_v<Ty>) / (T(Ty(1)) - cos_max);
+	}
+
+	// Densities of the half vector h, D(h) cos_theta with cos_theta the
+	// cosine between h and the normal. Directions reflected about h have
+	// the density pdf / (4 |dot(wo, h)|).
+	template<typename T>
+	T ggx_pdf(const T& cos_theta, const T& alpha)
+	{
+		using Ty = typename detail::lane_of<T>::type;
+		using std::max;
+		const T c = max(cos_theta, T(Ty(0)));
+		const T alpha2 = alpha * alpha;
+		const T d = (alpha2 - T(Ty(1))) * c * c + T(Ty(1));
+		return alpha2 * c * T(std::numbers::inv_pi_v<Ty>) / (d * d);
+	}
+	template<typename T>
+	T beckmann_pdf(const T& cos_theta, const T& alpha)
+	{
+		using Ty = typename detail::lane_of<T>::type;
+		using detail::select;
+		const T cos2 = cos_theta * cos_theta;
+		const T alpha2 = alpha * alpha;
+		const T pdf = detail::exp((cos2 - T(Ty(1))) / (alpha2 * cos2)) * T(std::numbers::inv_pi_v<Ty>) / (alpha2 * cos2 * cos_theta);
+		return select(cos_theta > T(Ty(0)), pdf, T(Ty(0)));
+	}
+
+	/* ####################### Hemispheres ####################### */
+
+	// Uniform over the hemisphere around n
+	template<typename Ty, random_engine Engine>
+	vec<Ty, 3> random_hemisphere(Engine& engine, const vec<Ty, 3>& n)
+	{
+		return detail::sample_direction<detail::cone_kernel>(engine, n, Ty(0));
+	}
+	template<typename Ty>
+	vec<Ty, 3> random_hemisphere(const vec<Ty, 3>& n)
+	{
+		return random_hemisphere(thread_generator_for<Ty>(), n);
+	}
+	template<typename Ty, uint32_t Width, random_engine Engine>
+	vec_packet<Ty, 3, Width> random_hemisphere(Engine& engine, const vec_packet<Ty, 3, Width>& n)
+	{
+		return detail::sample_direction<detail::cone_kernel>(engine, n, packet<Ty, Width>(Ty(0)));
+	}
+	template<typename Ty, uint32_t Width>
+	vec_packet<Ty, 3, Width> random_hemisphere(const vec_packet<Ty, 3, Width>& n)
+	{
+		return random_hemisphere(thread_generator_for<Ty>(), n);
+	}
+	template<typename Ty, random_engine Engine>
+	void fill_hemisphere(Engine& engine, detail::normal_input<Ty> normals, std::span<vec<Ty, 3>> out)
+	{
+		detail::fill_directions<detail::cone_kernel>(engine, normals, {}, Ty(0), out);
+	}
+	template<typename Ty>
+	void fill_hemisphere(detail::normal_input<Ty> normals, std::span<vec<Ty, 3>> out)
+	{
+		fill_hemisphere(thread_generator_for<Ty>(), normals, out);
+	}
+
+	// Cosine weighted over the hemisphere around n
+	template<typename Ty, random_engine Engine>
+	vec<Ty, 3> random_cosine_hemisphere(Engine& engine, const vec<Ty, 3>& n)
+	{
+		return detail::sample_direction<detail::cosine_kernel>(engine, n, Ty(0));
+	}
+	template<typename Ty>
+	vec<Ty, 3> random_cosine_hemisphere(const vec<Ty, 3>& n)
+	{
+		return random_cosine_hemisphere(thread_generator_for<Ty>(), n);
+	}
+	template<typename Ty, uint32_t Width, random_engine Engine>
+	vec_packet<Ty, 3, Width> random_cosine_hemisphere(Engine& engine, const vec_packet<Ty, 3, Width>& n)
+	{
+		return detail::sample_direction<detail::cosine_kernel>(engine, n, packet<Ty, Width>(Ty(0)));
+	}
+	template<typename Ty, uint32_t Width>
+	vec_packet<Ty, 3, Width> random_cosine_hemisphere(const vec_packet<Ty, 3, Width>& n)
+	{
+		return random_cosine_hemisphere(thread_generator_for<Ty>(), n);
+	}
+	template<typename Ty, random_engine Engine>
+	void fill_cosine_hemisphere(Engine& engine, detail::normal_input<Ty> normals, std::span<vec<Ty, 3>> out)
+	{
+		detail::fill_directions<detail::cosine_kernel>(engine, normals, {}, Ty(0), out);
+	}
+	template<typename Ty>
+	void fill_cosine_hemisphere(detail::normal_input<Ty> normals, std::span<vec<Ty, 3>> out)
+	{
+		fill_cosine_hemisphere(thread_generator_for<Ty>(), normals, out);
+	}
+
+	/* ########################## Cones ########################## */
+
+	// Uniform over the directions within acos(cos_max) of axis, e.g. a
+	// sphere light of radius r at distance d is seen under
+	// cos_max = sqrt(1 - r^2 / d^2)
+	template<typename Ty, random_engine Engine>
+	vec<Ty, 3> random_cone(Engine& engine, const vec<Ty, 3>& axis, std::type_identity_t<Ty> cos_max)
+	{
+		return detail::sample_direction<detail::cone_kernel>(engine, axis, Ty(cos_max));
+	}
+	template<typename Ty>
+	vec<Ty, 3> random_cone(const vec<Ty, 3>& axis, std::type_identity_t<Ty> cos_max)
+	{
+		return random_cone(thread_generator_for<Ty>(), axis, cos_max);
+	}
+	template<typename Ty, uint32_t Width, random_engine Engine>
+	vec_packet<Ty, 3, Width> random_cone(Engine& engine, const vec_packet<Ty, 3, Width>& axis, const std::type_identity_t<packet<Ty, Width>>& cos_max)
+	{
+		return detail::sample_direction<detail::cone_kernel>(engine, axis, cos_max);
+	}
+	template<typename Ty, uint32_t Width>
+	vec_packet<Ty, 3, Width> random_cone(const vec_packet<Ty, 3, Width>& axis, const std::type_identity_t<packet<Ty, Width>>& cos_max)
+	{
+		return random_cone(thread_generator_for<Ty>(), axis, cos_max);
+	}
+	template<typename Ty, random_engine Engine>
+	void fill_cone(Engine& engine, detail::normal_input<Ty> axes, std::type_identity_t<Ty> cos_max, std::span<vec<Ty, 3>> out)
+	{
+		detail::fill_directions<detail::cone_kernel>(engine, axes, {}, Ty(cos_max), out);
+	}
+	template<typename Ty>
+	void fill_cone(detail::normal_input<Ty> axes, std::type_identity_t<Ty> cos_max, std::span<vec<Ty, 3>> out)
+	{
+		fill_cone(thread_generator_for<Ty>(), axes, cos_max, out);
+	}
+
+	// One cone per direction, cos_max[i] around axes[i]
+	template<typename Ty, random_engine Engine>
+	void fill_cone(Engine& engine, detail::normal_input<Ty> axes, detail::parameter_input<Ty> cos_max, std::span<vec<Ty, 3>> out)
+	{
+		detail::fill_directions<detail::cone_kernel>(engine, axes, cos_max, Ty(0), out);
+	}
+	template<typename Ty>
+	void fill_cone(detail::normal_input<Ty> axes, detail::parameter_input<Ty> cos_max, std::span<vec<Ty, 3>> out)
+	{
+		fill_cone(thread_generator_for<Ty>(), axes, cos_max, out);
+	}
+
+	/* ####################### Microfacets ####################### */
+
+	// Half vectors around n distributed as D(h) cos_theta for the GGX
+	// (Trowbridge-Reitz) and Beckmann distributions of roughness alpha
+	template<typename Ty, random_engine Engine>
+	vec<Ty, 3> random_ggx_half(Engine& engine, const vec<Ty, 3>& n, std::type_identity_t<Ty> alpha)
+	{
+		return detail::sample_direction<detail::ggx_kernel>(engine, n, alpha);
+	}
+	template<typename Ty>
+	vec<Ty, 3> random_ggx_half(const vec<Ty, 3>& n, std::type_identity_t<Ty> alpha)
+	{
+		return random_ggx_half(thread_generator_for<Ty>(), n, alpha);
+	}
+	template<typename Ty, uint32_t Width, random_engine Engine>
+	vec_packet<Ty, 3, Width> random_ggx_half(Engine& engine, const vec_packet<Ty, 3, Width>& n, const std::type_identity_t<packet<Ty, Width>>& alpha)
+	{
+		return detail::sample_direction<detail::ggx_kernel>(engine, n, alpha);
+	}
+	template<typename Ty, uint32_t Width>
+	vec_packet<Ty, 3, Width> random_ggx_half(const vec_packet<Ty, 3, Width>& n, const std::type_identity_t<packet<Ty, Width>>& alpha)
+	{
+		return random_ggx_half(thread_generator_for<Ty>(), n, alpha);
+	}
+	template<typename Ty, random_engine Engine>
+	void fill_ggx_half(Engine& engine, detail::normal_input<Ty> normals, std::type_identity_t<Ty> alpha, std::span<vec<Ty, 3>> out)
+	{
+		detail::fill_directions<detail::ggx_kernel>(engine, normals, {}, alpha, out);
+	}
+	template<typename Ty>
+	void fill_ggx_half(detail::normal_input<Ty> normals, std::type_identity_t<Ty> alpha, std::span<vec<Ty, 3>> out)
+	{
+		fill_ggx_half(thread_generator_for<Ty>(), normals, alpha, out);
+	}
+
+	template<typename Ty, random_engine Engine>
+	vec<Ty, 3> random_beckmann_half(Engine& engine, const vec<Ty, 3>& n, std::type_identity_t<Ty> alpha)
+	{
+		return detail::sample_direction<detail::beckmann_kernel>(engine, n, alpha);
+	}
+	template<typename Ty>
+	vec<Ty, 3> random_beckmann_half(const vec<Ty, 3>& n, std::type_identity_t<Ty> alpha)
+	{
+		return random_beckmann_half(thread_generator_for<Ty>(), n, alpha);
+	}
+	template<typename Ty, uint32_t Width, random_engine Engine>
+	vec_packet<Ty, 3, Width> random_beckmann_half(Engine& engine, const vec_packet<Ty, 3, Width>& n, const std::type_identity_t<packet<Ty, Width>>& alpha)
+	{
+		return detail::sample_direction<detail::beckmann_kernel>(engine, n, alpha);
+	}
+	template<typename Ty, uint32_t Width>
+	vec_packet<Ty, 3, Width> random_beckmann_half(const vec_packet<Ty, 3, Width>& n, const std::type_identity_t<packet<Ty, Width>>& alpha)
+	{
+		return random_beckmann_half(thread_generator_for<Ty>(), n, alpha);
+	}
+	template<typename Ty, random_engine Engine>
+	void fill_beckmann_half(Engine& engine, detail::normal_input<Ty> normals, std::type_identity_t<Ty> alpha, std::span<vec<Ty, 3>> out)
+	{
+		detail::fill_directions<detail::beckmann_kernel>(engine, normals, {}, alpha, out);
+	}
+	template<typename Ty>
+	void fill_beckmann_half(detail::normal_input<Ty> normals, std::type_identity_t<Ty> alpha, std::span<vec<Ty, 3>> out)
+	{
+		fill_beckmann_half(thread_generator_for<Ty>(), normals, alpha, out);
+	}
+
+}
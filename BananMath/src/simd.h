@@ -0,0 +1,541 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// Instruction set detection. Define BANAN_NO_SIMD to force the scalar paths.
+#if !defined(BANAN_NO_SIMD)
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define BANAN_SSE 1
+	#endif
+	#if defined(__AVX__)
+		#define BANAN_AVX 1
+	#endif
+	#if defined(__AVX2__)
+		#define BANAN_AVX2 1
+	#endif
+	#if defined(__AVX512F__)
+		#define BANAN_AVX512 1
+	#endif
+	#if defined(__SSE4_1__) || defined(__AVX__)
+		#define BANAN_SSE41 1
+	#endif
+#endif
+
+#if defined(BANAN_SSE)
+	#include <immintrin.h>
+#endif
+
+namespace Banan::simd
+{
+
+	// reg4<Ty> describes a native register holding 4 lanes of Ty.
+	// Types without such register have enabled == false and use the scalar code.
+	template<typename Ty>
+	struct reg4
+	{
+		static constexpr bool enabled = false;
+	};
+
+#if defined(BANAN_SSE)
+	template<>
+	struct reg4<float>
+	{
+		static constexpr bool enabled = true;
+		using type = __m128;
+
+		static type zero()										{ return _mm_setzero_ps(); }
+		static type set(float x, float y, float z, float w)		{ return _mm_setr_ps(x, y, z, w); }
+		static type broadcast(float v)							{ return _mm_set1_ps(v); }
+
+		static type add(type a, type b)							{ return _mm_add_ps(a, b); }
+		static type sub(type a, type b)							{ return _mm_sub_ps(a, b); }
+		static type mul(type a, type b)							{ return _mm_mul_ps(a, b); }
+		static type div(type a, type b)							{ return _mm_div_ps(a, b); }
+		static type min(type a, type b)							{ return _mm_min_ps(a, b); }
+		static type neg(type a)									{ return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+		static type abs(type a)									{ return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+		static type sqrt(type a)								{ return _mm_sqrt_ps(a); }
+		// Hardware estimate (12 bits) refined by one Newton-Raphson step
+		static type rsqrt(type a)
+		{
+			type y = _mm_rsqrt_ps(a);
+			type half_a_yy = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), a), _mm_mul_ps(y, y));
+			return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), half_a_yy));
+		}
+
+		// Sum of all lanes broadcast to every lane
+		static type hsum(type a)
+		{
+			type t = _mm_add_ps(a, _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_add_ps(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 0, 3, 2)));
+		}
+		static float first(type a)								{ return _mm_cvtss_f32(a); }
+		// Non-temporal store, dst must be 16 byte aligned
+		static void stream(float* dst, type a)					{ _mm_stream_ps(dst, a); }
+
+		// (x, y, z, w) -> (y, z, x, w)
+		static type yzxw(type a)								{ return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)); }
+		// (a.x, a.y, a.z, b.w)
+		static type blend_w(type a, type b)
+		{
+#if defined(BANAN_SSE41)
+			return _mm_blend_ps(a, b, 0b1000);
+#else
+			type mask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+			return _mm_or_ps(_mm_andnot_ps(mask, a), _mm_and_ps(mask, b));
+#endif
+		}
+	};
+#endif
+
+#if defined(BANAN_AVX)
+	template<>
+	struct reg4<double>
+	{
+		static constexpr bool enabled = true;
+		using type = __m256d;
+
+		static type zero()										{ return _mm256_setzero_pd(); }
+		static type set(double x, double y, double z, double w)	{ return _mm256_setr_pd(x, y, z, w); }
+		static type broadcast(double v)							{ return _mm256_set1_pd(v); }
+
+		static type add(type a, type b)							{ return _mm256_add_pd(a, b); }
+		static type sub(type a, type b)							{ return _mm256_sub_pd(a, b); }
+		static type mul(type a, type b)							{ return _mm256_mul_pd(a, b); }
+		static type div(type a, type b)							{ return _mm256_div_pd(a, b); }
+		static type min(type a, type b)							{ return _mm256_min_pd(a, b); }
+		static type neg(type a)									{ return _mm256_xor_pd(a, _mm256_set1_pd(-0.0)); }
+		static type abs(type a)									{ return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+		static type sqrt(type a)								{ return _mm256_sqrt_pd(a); }
+		static type rsqrt(type a)								{ return _mm256_div_pd(_mm256_set1_pd(1.0), _mm256_sqrt_pd(a)); }
+
+		// Sum of all lanes broadcast to every lane
+		static type hsum(type a)
+		{
+			type t = _mm256_add_pd(a, _mm256_permute_pd(a, 0b0101));
+			return _mm256_add_pd(t, _mm256_permute2f128_pd(t, t, 0x01));
+		}
+		static double first(type a)								{ return _mm256_cvtsd_f64(a); }
+		// Non-temporal store, dst must be 32 byte aligned
+		static void stream(double* dst, type a)					{ _mm256_stream_pd(dst, a); }
+
+		// (x, y, z, w) -> (y, z, x, w)
+		static type yzxw(type a)
+		{
+#if defined(BANAN_AVX2)
+			return _mm256_permute4x64_pd(a, _MM_SHUFFLE(3, 0, 2, 1));
+#else
+			type swap	= _mm256_permute2f128_pd(a, a, 0x01);		// z w x y
+			type r		= _mm256_permute_pd(a, 0b0101);				// y x w z
+			r = _mm256_blend_pd(r, _mm256_permute_pd(swap, 0b0101), 0b0010);	// y z w z
+			r = _mm256_blend_pd(r, swap, 0b0100);					// y z x z
+			return _mm256_blend_pd(r, a, 0b1000);					// y z x w
+#endif
+		}
+		// (a.x, a.y, a.z, b.w)
+		static type blend_w(type a, type b)						{ return _mm256_blend_pd(a, b, 0b1000); }
+	};
+#endif
+
+	template<typename Ty>
+	concept has_reg4 = reg4<Ty>::enabled;
+
+	// Orders preceding non-temporal stores before any later store
+	inline void stream_fence()
+	{
+#if defined(BANAN_SSE)
+		_mm_sfence();
+#endif
+	}
+
+	// native<Ty, Lanes> describes a register holding Lanes x Ty, used for
+	// lane-wise packet processing. Comparisons return a mask in the same
+	// register type with every bit of a lane set when true. native<Ty, 1>
+	// is the portable scalar fallback and is always enabled.
+	template<typename Ty, uint32_t Lanes>
+	struct native
+	{
+		static constexpr bool enabled = false;
+	};
+
+	template<typename Ty>
+	struct native<Ty, 1>
+	{
+		static constexpr bool enabled = true;
+		static constexpr uint32_t lanes = 1;
+		using type = Ty;
+		using bits = std::conditional_t<sizeof(Ty) == 8, uint64_t, uint32_t>;
+
+		static type load(const Ty* src)							{ return *src; }
+		static void store(Ty* dst, type a)						{ *dst = a; }
+		static type loadu(const Ty* src)						{ return *src; }
+		static void storeu(Ty* dst, type a)						{ *dst = a; }
+		static type broadcast(Ty v)								{ return v; }
+
+		static type add(type a, type b)							{ return a + b; }
+		static type sub(type a, type b)							{ return a - b; }
+		static type mul(type a, type b)							{ return a * b; }
+		static type div(type a, type b)							{ return a / b; }
+		static type min(type a, type b)							{ return a < b ? a : b; }
+		static type max(type a, type b)							{ return a > b ? a : b; }
+		static type neg(type a)									{ return -a; }
+		static type abs(type a)									{ return a < Ty(0) ? -a : a; }
+		static type sqrt(type a)								{ return Ty(std::sqrt(a)); }
+		static type rsqrt(type a)								{ return Ty(1) / Ty(std::sqrt(a)); }
+		static Ty reduce_add(type a)							{ return a; }
+		// Uniform [0, 1) from the top mantissa bits of raw random bits
+		static type unit_from_bits(const bits* src)
+		{
+			constexpr uint32_t shift = sizeof(Ty) * 8 - std::numeric_limits<Ty>::digits + 1;
+			return std::bit_cast<Ty>(bits(std::bit_cast<bits>(Ty(1)) | (*src >> shift))) - Ty(1);
+		}
+
+		static type mask(bool b)								{ return std::bit_cast<Ty>(b ? ~bits(0) : bits(0)); }
+		static type cmp_eq(type a, type b)						{ return mask(a == b); }
+		static type cmp_lt(type a, type b)						{ return mask(a < b); }
+		static type cmp_le(type a, type b)						{ return mask(a <= b); }
+		static type mask_and(type a, type b)					{ return std::bit_cast<Ty>(bits(std::bit_cast<bits>(a) & std::bit_cast<bits>(b))); }
+		static type mask_or(type a, type b)						{ return std::bit_cast<Ty>(bits(std::bit_cast<bits>(a) | std::bit_cast<bits>(b))); }
+		static type mask_not(type a)							{ return std::bit_cast<Ty>(bits(~std::bit_cast<bits>(a))); }
+		static type blend(type m, type a, type b)				{ return std::bit_cast<bits>(m) ? a : b; }
+		static uint32_t movemask(type m)						{ return std::bit_cast<bits>(m) ? 1 : 0; }
+	};
+
+#if defined(BANAN_SSE)
+	template<>
+	struct native<float, 4>
+	{
+		static constexpr bool enabled = true;
+		static constexpr uint32_t lanes = 4;
+		using type = __m128;
+
+		static type load(const float* src)						{ return _mm_load_ps(src); }
+		static void store(float* dst, type a)					{ _mm_store_ps(dst, a); }
+		static type loadu(const float* src)						{ return _mm_loadu_ps(src); }
+		static void storeu(float* dst, type a)					{ _mm_storeu_ps(dst, a); }
+		static type broadcast(float v)							{ return _mm_set1_ps(v); }
+
+		static type add(type a, type b)							{ return _mm_add_ps(a, b); }
+		static type sub(type a, type b)							{ return _mm_sub_ps(a, b); }
+		static type mul(type a, type b)							{ return _mm_mul_ps(a, b); }
+		static type div(type a, type b)							{ return _mm_div_ps(a, b); }
+		static type min(type a, type b)							{ return _mm_min_ps(a, b); }
+		static type max(type a, type b)							{ return _mm_max_ps(a, b); }
+		static type neg(type a)									{ return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+		static type abs(type a)									{ return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+		static type sqrt(type a)								{ return _mm_sqrt_ps(a); }
+		// Hardware estimate (12 bits) refined by one Newton-Raphson step
+		static type rsqrt(type a)
+		{
+			type y = _mm_rsqrt_ps(a);
+			type half_a_yy = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), a), _mm_mul_ps(y, y));
+			return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), half_a_yy));
+		}
+		static float reduce_add(type a)
+		{
+			a = _mm_add_ps(a, _mm_movehl_ps(a, a));
+			return _mm_cvtss_f32(_mm_add_ss(a, _mm_shuffle_ps(a, a, 1)));
+		}
+		// Uniform [0, 1) from the top mantissa bits of raw random bits
+		static type unit_from_bits(const uint32_t* src)
+		{
+			__m128i b = _mm_or_si128(_mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), 9), _mm_set1_epi32(0x3F800000));
+			return _mm_sub_ps(_mm_castsi128_ps(b), _mm_set1_ps(1.0f));
+		}
+
+		// 4x4 transpose, rows become columns
+		static void transpose(type& r0, type& r1, type& r2, type& r3)
+		{
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		}
+
+		static type cmp_eq(type a, type b)						{ return _mm_cmpeq_ps(a, b); }
+		static type cmp_lt(type a, type b)						{ return _mm_cmplt_ps(a, b); }
+		static type cmp_le(type a, type b)						{ return _mm_cmple_ps(a, b); }
+		static type mask_and(type a, type b)					{ return _mm_and_ps(a, b); }
+		static type mask_or(type a, type b)						{ return _mm_or_ps(a, b); }
+		static type mask_not(type a)							{ return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+		static type blend(type m, type a, type b)
+		{
+#if defined(BANAN_SSE41)
+			return _mm_blendv_ps(b, a, m);
+#else
+			return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+#endif
+		}
+		static uint32_t movemask(type m)						{ return uint32_t(_mm_movemask_ps(m)); }
+	};
+
+	template<>
+	struct native<double, 2>
+	{
+		static constexpr bool enabled = true;
+		static constexpr uint32_t lanes = 2;
+		using type = __m128d;
+
+		static type load(const double* src)						{ return _mm_load_pd(src); }
+		static void store(double* dst, type a)					{ _mm_store_pd(dst, a); }
+		static type loadu(const double* src)						{ return _mm_loadu_pd(src); }
+		static void storeu(double* dst, type a)					{ _mm_storeu_pd(dst, a); }
+		static type broadcast(double v)							{ return _mm_set1_pd(v); }
+
+		static type add(type a, type b)							{ return _mm_add_pd(a, b); }
+		static type sub(type a, type b)							{ return _mm_sub_pd(a, b); }
+		static type mul(type a, type b)							{ return _mm_mul_pd(a, b); }
+		static type div(type a, type b)							{ return _mm_div_pd(a, b); }
+		static type min(type a, type b)							{ return _mm_min_pd(a, b); }
+		static type max(type a, type b)							{ return _mm_max_pd(a, b); }
+		static type neg(type a)									{ return _mm_xor_pd(a, _mm_set1_pd(-0.0)); }
+		static type abs(type a)									{ return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+		static type sqrt(type a)								{ return _mm_sqrt_pd(a); }
+		static type rsqrt(type a)								{ return _mm_div_pd(_mm_set1_pd(1.0), _mm_sqrt_pd(a)); }
+		static double reduce_add(type a)
+		{
+			return _mm_cvtsd_f64(_mm_add_sd(a, _mm_unpackhi_pd(a, a)));
+		}
+
+		static type cmp_eq(type a, type b)						{ return _mm_cmpeq_pd(a, b); }
+		static type cmp_lt(type a, type b)						{ return _mm_cmplt_pd(a, b); }
+		static type cmp_le(type a, type b)						{ return _mm_cmple_pd(a, b); }
+		static type mask_and(type a, type b)					{ return _mm_and_pd(a, b); }
+		static type mask_or(type a, type b)						{ return _mm_or_pd(a, b); }
+		static type mask_not(type a)							{ return _mm_xor_pd(a, _mm_castsi128_pd(_mm_set1_epi32(-1))); }
+		static type blend(type m, type a, type b)
+		{
+#if defined(BANAN_SSE41)
+			return _mm_blendv_pd(b, a, m);
+#else
+			return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));
+#endif
+		}
+		static uint32_t movemask(type m)						{ return uint32_t(_mm_movemask_pd(m)); }
+	};
+#endif
+
+#if defined(BANAN_AVX)
+	template<>
+	struct native<float, 8>
+	{
+		static constexpr bool enabled = true;
+		static constexpr uint32_t lanes = 8;
+		using type = __m256;
+
+		static type load(const float* src)						{ return _mm256_load_ps(src); }
+		static void store(float* dst, type a)					{ _mm256_store_ps(dst, a); }
+		static type loadu(const float* src)						{ return _mm256_loadu_ps(src); }
+		static void storeu(float* dst, type a)					{ _mm256_storeu_ps(dst, a); }
+		static type broadcast(float v)							{ return _mm256_set1_ps(v); }
+
+		static type add(type a, type b)							{ return _mm256_add_ps(a, b); }
+		static type sub(type a, type b)							{ return _mm256_sub_ps(a, b); }
+		static type mul(type a, type b)							{ return _mm256_mul_ps(a, b); }
+		static type div(type a, type b)							{ return _mm256_div_ps(a, b); }
+		static type min(type a, type b)							{ return _mm256_min_ps(a, b); }
+		static type max(type a, type b)							{ return _mm256_max_ps(a, b); }
+		static type neg(type a)									{ return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+		static type abs(type a)									{ return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+		static type sqrt(type a)								{ return _mm256_sqrt_ps(a); }
+		// Hardware estimate (12 bits) refined by one Newton-Raphson step
+		static type rsqrt(type a)
+		{
+			type y = _mm256_rsqrt_ps(a);
+			type half_a_yy = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), a), _mm256_mul_ps(y, y));
+			return _mm256_mul_ps(y, _mm256_sub_ps(_mm256_set1_ps(1.5f), half_a_yy));
+		}
+		static float reduce_add(type a)
+		{
+			return native<float, 4>::reduce_add(_mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1)));
+		}
+		// Uniform [0, 1) from the top mantissa bits of raw random bits
+		static type unit_from_bits(const uint32_t* src)
+		{
+#if defined(BANAN_AVX2)
+			__m256i b = _mm256_or_si256(_mm256_srli_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)), 9), _mm256_set1_epi32(0x3F800000));
+			return _mm256_sub_ps(_mm256_castsi256_ps(b), _mm256_set1_ps(1.0f));
+#else
+			return _mm256_set_m128(native<float, 4>::unit_from_bits(src + 4), native<float, 4>::unit_from_bits(src));
+#endif
+		}
+
+		static type cmp_eq(type a, type b)						{ return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+		static type cmp_lt(type a, type b)						{ return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		static type cmp_le(type a, type b)						{ return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+		static type mask_and(type a, type b)					{ return _mm256_and_ps(a, b); }
+		static type mask_or(type a, type b)						{ return _mm256_or_ps(a, b); }
+		static type mask_not(type a)							{ return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+		static type blend(type m, type a, type b)				{ return _mm256_blendv_ps(b, a, m); }
+		static uint32_t movemask(type m)						{ return uint32_t(_mm256_movemask_ps(m)); }
+	};
+
+	template<>
+	struct native<double, 4>
+	{
+		static constexpr bool enabled = true;
+		static constexpr uint32_t lanes = 4;
+		using type = __m256d;
+
+		static type load(const double* src)						{ return _mm256_load_pd(src); }
+		static void store(double* dst, type a)					{ _mm256_store_pd(dst, a); }
+		static type loadu(const double* src)						{ return _mm256_loadu_pd(src); }
+		static void storeu(double* dst, type a)					{ _mm256_storeu_pd(dst, a); }
+		static type broadcast(double v)							{ return _mm256_set1_pd(v); }
+
+		static type add(type a, type b)							{ return _mm256_add_pd(a, b); }
+		static type sub(type a, type b)							{ return _mm256_sub_pd(a, b); }
+		static type mul(type a, type b)							{ return _mm256_mul_pd(a, b); }
+		static type div(type a, type b)							{ return _mm256_div_pd(a, b); }
+		static type min(type a, type b)							{ return _mm256_min_pd(a, b); }
+		static type max(type a, type b)							{ return _mm256_max_pd(a, b); }
+		static type neg(type a)									{ return _mm256_xor_pd(a, _mm256_set1_pd(-0.0)); }
+		static type abs(type a)									{ return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+		static type sqrt(type a)								{ return _mm256_sqrt_pd(a); }
+		static type rsqrt(type a)								{ return _mm256_div_pd(_mm256_set1_pd(1.0), _mm256_sqrt_pd(a)); }
+		static double reduce_add(type a)
+		{
+			return native<double, 2>::reduce_add(_mm_add_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1)));
+		}
+
+		// 4x4 transpose, rows become columns
+		static void transpose(type& r0, type& r1, type& r2, type& r3)
+		{
+			type t0 = _mm256_unpacklo_pd(r0, r1);
+			type t1 = _mm256_unpackhi_pd(r0, r1);
+			type t2 = _mm256_unpacklo_pd(r2, r3);
+			type t3 = _mm256_unpackhi_pd(r2, r3);
+			r0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+			r1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+			r2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+			r3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+		}
+
+		static type cmp_eq(type a, type b)						{ return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+		static type cmp_lt(type a, type b)						{ return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+		static type cmp_le(type a, type b)						{ return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+		static type mask_and(type a, type b)					{ return _mm256_and_pd(a, b); }
+		static type mask_or(type a, type b)						{ return _mm256_or_pd(a, b); }
+		static type mask_not(type a)							{ return _mm256_xor_pd(a, _mm256_castsi256_pd(_mm256_set1_epi32(-1))); }
+		static type blend(type m, type a, type b)				{ return _mm256_blendv_pd(b, a, m); }
+		static uint32_t movemask(type m)						{ return uint32_t(_mm256_movemask_pd(m)); }
+	};
+#endif
+
+#if defined(BANAN_AVX512)
+	template<>
+	struct native<float, 16>
+	{
+		static constexpr bool enabled = true;
+		static constexpr uint32_t lanes = 16;
+		using type = __m512;
+
+		static type load(const float* src)						{ return _mm512_load_ps(src); }
+		static void store(float* dst, type a)					{ _mm512_store_ps(dst, a); }
+		static type loadu(const float* src)						{ return _mm512_loadu_ps(src); }
+		static void storeu(float* dst, type a)					{ _mm512_storeu_ps(dst, a); }
+		static type broadcast(float v)							{ return _mm512_set1_ps(v); }
+
+		static type add(type a, type b)							{ return _mm512_add_ps(a, b); }
+		static type sub(type a, type b)							{ return _mm512_sub_ps(a, b); }
+		static type mul(type a, type b)							{ return _mm512_mul_ps(a, b); }
+		static type div(type a, type b)							{ return _mm512_div_ps(a, b); }
+		static type min(type a, type b)							{ return _mm512_min_ps(a, b); }
+		static type max(type a, type b)							{ return _mm512_max_ps(a, b); }
+		static type neg(type a)									{ return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_set1_epi32(INT32_MIN))); }
+		static type abs(type a)									{ return _mm512_abs_ps(a); }
+		static type sqrt(type a)								{ return _mm512_sqrt_ps(a); }
+		// Hardware estimate (14 bits) refined by one Newton-Raphson step
+		static type rsqrt(type a)
+		{
+			type y = _mm512_rsqrt14_ps(a);
+			type half_a_yy = _mm512_mul_ps(_mm512_mul_ps(_mm512_set1_ps(0.5f), a), _mm512_mul_ps(y, y));
+			return _mm512_mul_ps(y, _mm512_sub_ps(_mm512_set1_ps(1.5f), half_a_yy));
+		}
+		static float reduce_add(type a)							{ return _mm512_reduce_add_ps(a); }
+		// Uniform [0, 1) from the top mantissa bits of raw random bits
+		static type unit_from_bits(const uint32_t* src)
+		{
+			__m512i b = _mm512_or_si512(_mm512_srli_epi32(_mm512_loadu_si512(src), 9), _mm512_set1_epi32(0x3F800000));
+			return _mm512_sub_ps(_mm512_castsi512_ps(b), _mm512_set1_ps(1.0f));
+		}
+
+		// AVX-512 compares produce k-masks, expand them to full lanes
+		static type from_kmask(__mmask16 k)						{ return _mm512_castsi512_ps(_mm512_maskz_set1_epi32(k, -1)); }
+		static __mmask16 to_kmask(type m)						{ return _mm512_test_epi32_mask(_mm512_castps_si512(m), _mm512_castps_si512(m)); }
+
+		static type cmp_eq(type a, type b)						{ return from_kmask(_mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ)); }
+		static type cmp_lt(type a, type b)						{ return from_kmask(_mm512_cmp_ps_mask(a, b, _CMP_LT_OQ)); }
+		static type cmp_le(type a, type b)						{ return from_kmask(_mm512_cmp_ps_mask(a, b, _CMP_LE_OQ)); }
+		static type mask_and(type a, type b)					{ return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a), _mm512_castps_si512(b))); }
+		static type mask_or(type a, type b)						{ return _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(a), _mm512_castps_si512(b))); }
+		static type mask_not(type a)							{ return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_set1_epi32(-1))); }
+		static type blend(type m, type a, type b)				{ return _mm512_mask_blend_ps(to_kmask(m), b, a); }
+		static uint32_t movemask(type m)						{ return uint32_t(to_kmask(m)); }
+	};
+
+	template<>
+	struct native<double, 8>
+	{
+		static constexpr bool enabled = true;
+		static constexpr uint32_t lanes = 8;
+		using type = __m512d;
+
+		static type load(const double* src)						{ return _mm512_load_pd(src); }
+		static void store(double* dst, type a)					{ _mm512_store_pd(dst, a); }
+		static type loadu(const double* src)						{ return _mm512_loadu_pd(src); }
+		static void storeu(double* dst, type a)					{ _mm512_storeu_pd(dst, a); }
+		static type broadcast(double v)							{ return _mm512_set1_pd(v); }
+
+		static type add(type a, type b)							{ return _mm512_add_pd(a, b); }
+		static type sub(type a, type b)							{ return _mm512_sub_pd(a, b); }
+		static type mul(type a, type b)							{ return _mm512_mul_pd(a, b); }
+		static type div(type a, type b)							{ return _mm512_div_pd(a, b); }
+		static type min(type a, type b)							{ return _mm512_min_pd(a, b); }
+		static type max(type a, type b)							{ return _mm512_max_pd(a, b); }
+		static type neg(type a)									{ return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(a), _mm512_set1_epi64(INT64_MIN))); }
+		static type abs(type a)									{ return _mm512_abs_pd(a); }
+		static type sqrt(type a)								{ return _mm512_sqrt_pd(a); }
+		static type rsqrt(type a)								{ return _mm512_div_pd(_mm512_set1_pd(1.0), _mm512_sqrt_pd(a)); }
+		static double reduce_add(type a)						{ return _mm512_reduce_add_pd(a); }
+
+		// AVX-512 compares produce k-masks, expand them to full lanes
+		static type from_kmask(__mmask8 k)						{ return _mm512_castsi512_pd(_mm512_maskz_set1_epi64(k, -1)); }
+		static __mmask8 to_kmask(type m)						{ return _mm512_test_epi64_mask(_mm512_castpd_si512(m), _mm512_castpd_si512(m)); }
+
+		static type cmp_eq(type a, type b)						{ return from_kmask(_mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ)); }
+		static type cmp_lt(type a, type b)						{ return from_kmask(_mm512_cmp_pd_mask(a, b, _CMP_LT_OQ)); }
+		static type cmp_le(type a, type b)						{ return from_kmask(_mm512_cmp_pd_mask(a, b, _CMP_LE_OQ)); }
+		static type mask_and(type a, type b)					{ return _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(a), _mm512_castpd_si512(b))); }
+		static type mask_or(type a, type b)						{ return _mm512_castsi512_pd(_mm512_or_si512(_mm512_castpd_si512(a), _mm512_castpd_si512(b))); }
+		static type mask_not(type a)							{ return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(a), _mm512_set1_epi64(-1))); }
+		static type blend(type m, type a, type b)				{ return _mm512_mask_blend_pd(to_kmask(m), b, a); }
+		static uint32_t movemask(type m)						{ return uint32_t(to_kmask(m)); }
+	};
+#endif
+
+	// Widest enabled native register whose lane count divides Width
+	template<typename Ty, uint32_t Width>
+	constexpr uint32_t widest_lanes()
+	{
+		if constexpr (Width % 16 == 0 && native<Ty, 16>::enabled)
+			return 16;
+		else if constexpr (Width % 8 == 0 && native<Ty, 8>::enabled)
+			return 8;
+		else if constexpr (Width % 4 == 0 && native<Ty, 4>::enabled)
+			return 4;
+		else if constexpr (Width % 2 == 0 && native<Ty, 2>::enabled)
+			return 2;
+		else
+			return 1;
+	}
+
+	template<typename Ty, uint32_t Width>
+	using native_for = native<Ty, widest_lanes<Ty, Width>()>;
+
+	// Widest enabled native register for Ty
+	template<typename Ty>
+	using native_widest = native<Ty, widest_lanes<Ty, 16>()>;
+
+}
@@ -1,9 +1,17 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cassert>
 #include <cmath>
 #include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
 
 #include "random.h"
+#include "simd.h"
 
 namespace Banan
 {
@@ -11,6 +19,298 @@ namespace Banan
 	template<typename Ty, uint32_t Size>
 	class vec;
 
+	namespace detail
+	{
+		// abs usable in constant expressions
+		template<typename Ty>
+		constexpr Ty abs(Ty x)
+		{
+			return x < Ty(0) ? -x : x;
+		}
+
+		// sqrt usable in constant expressions, std::sqrt at runtime.
+		// The constant path runs Newton's method in double and is within
+		// one ulp of std::sqrt.
+		template<typename Ty>
+		constexpr Ty sqrt(Ty x)
+		{
+			if (!std::is_constant_evaluated())
+				return Ty(std::sqrt(x));
+			if constexpr (!std::is_floating_point_v<Ty>)
+				return Ty(detail::sqrt<double>(double(x)));
+			else
+			{
+				if (x != x || x == Ty(0) || x == std::numeric_limits<Ty>::infinity())
+					return x;
+				if (x < Ty(0))
+					return std::numeric_limits<Ty>::quiet_NaN();
+
+				// Start above the root so the iteration decreases monotonically
+				double value = double(x);
+				double guess = value > 1.0 ? value : 1.0;
+				for (;;)
+				{
+					double next = 0.5 * (guess + value / guess);
+					if (next >= guess)
+						return Ty(guess);
+					guess = next;
+				}
+			}
+		}
+
+		// Approximate 1 / sqrt(x). For float on SSE this is the hardware
+		// estimate refined by one Newton-Raphson step, with relative error
+		// below 5e-7 (a few ulp). The estimate treats subnormals as zero, so
+		// those and other types use 1 / std::sqrt(x).
+		template<typename Ty>
+		constexpr Ty rsqrt(Ty x)
+		{
+			if (std::is_constant_evaluated())
+				return Ty(1) / detail::sqrt(x);
+#if defined(BANAN_SSE)
+			if constexpr (std::is_same_v<Ty, float>)
+				if (x >= std::numeric_limits<float>::min())
+					return _mm_cvtss_f32(simd::reg4<float>::rsqrt(_mm_set_ss(x)));
+#endif
+			return Ty(1) / Ty(std::sqrt(x));
+		}
+
+		// Tag for constructing a register backed vec3 from a register whose
+		// 4th lane is known to be zero, skipping the blend that clears it
+		struct padded_t
+		{
+			explicit padded_t() = default;
+		};
+		inline constexpr padded_t padded {};
+
+		// Generic vector kernels. Up to vec_unroll_limit elements the
+		// operation is expanded at compile time into straight-line code,
+		// above it the elements are processed in chunks of the widest native
+		// register followed by a scalar tail.
+		inline constexpr uint32_t vec_unroll_limit = 16;
+
+		struct op_add
+		{
+			template<typename Ty>
+			static constexpr Ty scalar(Ty a, Ty b) { return a + b; }
+			template<typename N>
+			static typename N::type simd(typename N::type a, typename N::type b) { return N::add(a, b); }
+		};
+		struct op_sub
+		{
+			template<typename Ty>
+			static constexpr Ty scalar(Ty a, Ty b) { return a - b; }
+			template<typename N>
+			static typename N::type simd(typename N::type a, typename N::type b) { return N::sub(a, b); }
+		};
+		struct op_mul
+		{
+			template<typename Ty>
+			static constexpr Ty scalar(Ty a, Ty b) { return a * b; }
+			template<typename N>
+			static typename N::type simd(typename N::type a, typename N::type b) { return N::mul(a, b); }
+		};
+		struct op_div
+		{
+			template<typename Ty>
+			static constexpr Ty scalar(Ty a, Ty b) { return a / b; }
+			template<typename N>
+			static typename N::type simd(typename N::type a, typename N::type b) { return N::div(a, b); }
+		};
+
+		// dst[i] = Op(dst[i], src[i])
+		template<typename Op, uint32_t Size, typename Ty>
+		constexpr void vec_apply(Ty* dst, const Ty* src)
+		{
+			if constexpr (Size <= vec_unroll_limit)
+			{
+				[&]<uint32_t... I>(std::integer_sequence<uint32_t, I...>)
+				{
+					((dst[I] = Op::scalar(dst[I], src[I])), ...);
+				}(std::make_integer_sequence<uint32_t, Size>());
+			}
+			else
+			{
+				uint32_t i = 0;
+				if (!std::is_constant_evaluated())
+				{
+					using native = simd::native_widest<Ty>;
+					for (; i + native::lanes <= Size; i += native::lanes)
+						native::storeu(dst + i, Op::template simd<native>(native::loadu(dst + i), native::loadu(src + i)));
+				}
+				for (; i < Size; i++)
+					dst[i] = Op::scalar(dst[i], src[i]);
+			}
+		}
+
+		// dst[i] = Op(dst[i], val)
+		template<typename Op, uint32_t Size, typename Ty>
+		constexpr void vec_apply_scalar(Ty* dst, Ty val)
+		{
+			if constexpr (Size <= vec_unroll_limit)
+			{
+				[&]<uint32_t... I>(std::integer_sequence<uint32_t, I...>)
+				{
+					((dst[I] = Op::scalar(dst[I], val)), ...);
+				}(std::make_integer_sequence<uint32_t, Size>());
+			}
+			else
+			{
+				uint32_t i = 0;
+				if (!std::is_constant_evaluated())
+				{
+					using native = simd::native_widest<Ty>;
+					typename native::type v = native::broadcast(val);
+					for (; i + native::lanes <= Size; i += native::lanes)
+						native::storeu(dst + i, Op::template simd<native>(native::loadu(dst + i), v));
+				}
+				for (; i < Size; i++)
+					dst[i] = Op::scalar(dst[i], val);
+			}
+		}
+
+		// Sum of a[i] * b[i]
+		template<uint32_t Size, typename Ty>
+		constexpr Ty vec_dot(const Ty* a, const Ty* b)
+		{
+			if constexpr (Size <= vec_unroll_limit)
+			{
+				return [&]<uint32_t... I>(std::integer_sequence<uint32_t, I...>)
+				{
+					return ((a[I] * b[I]) + ...);
+				}(std::make_integer_sequence<uint32_t, Size>());
+			}
+			else
+			{
+				Ty result = Ty(0);
+				uint32_t i = 0;
+				if (!std::is_constant_evaluated())
+				{
+					using native = simd::native_widest<Ty>;
+					if constexpr (native::lanes > 1)
+					{
+						typename native::type sum = native::broadcast(Ty(0));
+						for (; i + native::lanes <= Size; i += native::lanes)
+							sum = native::add(sum, native::mul(native::loadu(a + i), native::loadu(b + i)));
+						result = native::reduce_add(sum);
+					}
+				}
+				for (; i < Size; i++)
+					result += a[i] * b[i];
+				return result;
+			}
+		}
+
+		// Point sampling kernels. N is a simd::native register description,
+		// native<Ty, 1> for single points, and every input is uniform on
+		// [-1, 1). They run without branches, rejection or trig calls.
+
+		// Taylor series of sin and cos on [-pi/4, pi/4], sin(x) = x * sum of
+		// sin[k] * x^2k and cos(x) = sum of cos[k] * x^2k. The terms kept
+		// stay within an ulp of Ty.
+		template<typename Ty, uint32_t Terms>
+		constexpr std::array<Ty, Terms> taylor_coefficients(uint32_t first)
+		{
+			// (-1)^k / (first + 2k)!
+			std::array<Ty, Terms> result {};
+			double factorial = 1;
+			for (uint32_t n = 1; n <= first; n++)
+				factorial *= double(n);
+			for (uint32_t k = 0; k < Terms; k++)
+			{
+				result[k] = Ty((k % 2 ? -1.0 : 1.0) / factorial);
+				factorial *= double(first + 2 * k + 1) * double(first + 2 * k + 2);
+			}
+			return result;
+		}
+		template<typename Ty>
+		struct sincos_series
+		{
+			static constexpr uint32_t terms = sizeof(Ty) == 4 ? 5 : 9;
+			static constexpr std::array<Ty, terms> sin = taylor_coefficients<Ty, terms>(1);
+			static constexpr std::array<Ty, terms> cos = taylor_coefficients<Ty, terms>(0);
+		};
+		template<typename N, typename Ty>
+		void sincos_octant(typename N::type x, typename N::type& s, typename N::type& c)
+		{
+			using series = sincos_series<Ty>;
+			const typename N::type x2 = N::mul(x, x);
+			s = N::broadcast(series::sin[series::terms - 1]);
+			c = N::broadcast(series::cos[series::terms - 1]);
+			for (uint32_t k = series::terms - 1; k-- > 0;)
+			{
+				s = N::add(N::broadcast(series::sin[k]), N::mul(s, x2));
+				c = N::add(N::broadcast(series::cos[k]), N::mul(c, x2));
+			}
+			s = N::mul(s, x);
+		}
+
+		// Shirley and Chiu's concentric map of the square onto the disc,
+		// split into a direction (x, y) on the unit circle and the radius
+		// max(|a|, |b|). The angle is uniform and independent of the radius,
+		// whose density is 2r. Measuring the angle from the diagonal of the
+		// quadrant of (a, b) keeps it in [-pi/4, pi/4] without swapping the
+		// axes, so no lane takes a branch.
+		template<typename N, typename Ty>
+		void concentric(typename N::type a, typename N::type b, typename N::type& x, typename N::type& y, typename N::type& radius)
+		{
+			using T = typename N::type;
+			const T abs_a = N::abs(a);
+			const T abs_b = N::abs(b);
+			radius = N::max(abs_a, abs_b);
+
+			// The centre maps to the diagonal
+			const T angle = N::div(N::mul(N::broadcast(Ty(0.78539816339744830962)), N::sub(abs_b, abs_a)),
+				N::max(radius, N::broadcast(std::numeric_limits<Ty>::min())));
+			T s, c;
+			sincos_octant<N, Ty>(angle, s, c);
+
+			// Rotate by pi/4 onto the quadrant and copy the signs of a and b
+			const T half_sqrt2 = N::broadcast(Ty(0.70710678118654752440));
+			const T sign = N::broadcast(Ty(-0.0));
+			x = N::mask_or(N::abs(N::mul(N::sub(c, s), half_sqrt2)), N::mask_and(a, sign));
+			y = N::mask_or(N::abs(N::mul(N::add(c, s), half_sqrt2)), N::mask_and(b, sign));
+		}
+
+		// Uniform point in the unit disc
+		template<typename N, typename Ty>
+		void disc_point(typename N::type a, typename N::type b, typename N::type& x, typename N::type& y)
+		{
+			typename N::type radius;
+			concentric<N, Ty>(a, b, x, y, radius);
+			x = N::mul(x, radius);
+			y = N::mul(y, radius);
+		}
+
+		// Uniform point on the unit sphere, Archimedes: the height h is
+		// uniform and the ring at h has radius sqrt(1 - h^2).
+		template<typename N, typename Ty>
+		void sphere_point(typename N::type a, typename N::type b, typename N::type h, typename N::type& x, typename N::type& y, typename N::type& z)
+		{
+			typename N::type radius;
+			concentric<N, Ty>(a, b, x, y, radius);
+			const typename N::type ring = N::sqrt(N::sub(N::broadcast(Ty(1)), N::mul(h, h)));
+			x = N::mul(x, ring);
+			y = N::mul(y, ring);
+			z = h;
+		}
+
+		// Uniform point in the unit ball, a point on the sphere scaled by
+		// max(|a|, |b|, |c|). The maximum of three uniforms on [0, 1) is
+		// distributed as the cube root of one, with density 3r^2.
+		template<typename N, typename Ty>
+		void ball_point(typename N::type a, typename N::type b, typename N::type c, typename N::type h, typename N::type& x, typename N::type& y, typename N::type& z)
+		{
+			typename N::type radius;
+			concentric<N, Ty>(a, b, x, y, radius);
+			radius = N::max(radius, N::abs(c));
+			const typename N::type ring = N::mul(radius, N::sqrt(N::sub(N::broadcast(Ty(1)), N::mul(h, h))));
+			x = N::mul(x, ring);
+			y = N::mul(y, ring);
+			z = N::mul(h, radius);
+		}
+	}
+
 	/* #################### 2d Vector Definiton #################### */
 	
 	template<typename Ty>
@@ -25,49 +325,59 @@ namespace Banan
 
 	public:
 		// Constructors
-		vec<Ty, 2>()
+		constexpr vec()
 			: x(Ty(0)), y(Ty(0))
 		{ }
-		vec<Ty, 2>(const Ty& x, const Ty& y)
+		constexpr vec(const Ty& x, const Ty& y)
 			: x(x), y(y)
 		{ }
+		constexpr vec(const vec<Ty, 2>& v) = default;
+
+		// Element access
+		constexpr Ty& operator[](uint32_t i)
+		{
+			if (std::is_constant_evaluated())
+				return i == 0 ? x : y;
+			return value[i];
+		}
+		constexpr const Ty& operator[](uint32_t i) const
+		{
+			if (std::is_constant_evaluated())
+				return i == 0 ? x : y;
+			return value[i];
+		}
 
 		// Unary operators
-		vec<Ty, 2> operator+() const
+		constexpr vec<Ty, 2> operator+() const
 		{
 			return vec<Ty, 2>(x, y);
 		}
-		vec<Ty, 2> operator-() const
+		constexpr vec<Ty, 2> operator-() const
 		{
 			return vec<Ty, 2>(-x, -y);
 		}
 
 		// Assignment operators
-		vec<Ty, 2>& operator =(const vec<Ty, 2>& v)
-		{
-			x = v.x;
-			y = v.y;
-			return *this;
-		}
-		vec<Ty, 2>& operator+=(const vec<Ty, 2>& v)
+		constexpr vec<Ty, 2>& operator =(const vec<Ty, 2>& v) = default;
+		constexpr vec<Ty, 2>& operator+=(const vec<Ty, 2>& v)
 		{
 			x += v.x;
 			y += v.y;
 			return *this;
 		}
-		vec<Ty, 2>& operator-=(const vec<Ty, 2>& v)
+		constexpr vec<Ty, 2>& operator-=(const vec<Ty, 2>& v)
 		{
 			x -= v.x;
 			y -= v.y;
 			return *this;
 		}
-		vec<Ty, 2>& operator*=(const Ty& val)
+		constexpr vec<Ty, 2>& operator*=(const Ty& val)
 		{
 			x *= val;
 			y *= val;
 			return *this;
 		}
-		vec<Ty, 2>& operator/=(const Ty& val)
+		constexpr vec<Ty, 2>& operator/=(const Ty& val)
 		{
 			x /= val;
 			y /= val;
@@ -75,45 +385,69 @@ namespace Banan
 		}
 
 		// Other vector operators
-		Ty dot(const vec<Ty, 2>& v)	const
+		constexpr Ty dot(const vec<Ty, 2>& v)	const
 		{
 			return x * v.x + y * v.y;
 		}
-		Ty magSq()					const
+		constexpr Ty magSq()					const
 		{
 			return x * x + y * y;
 		}
-		Ty mag()					const
+		constexpr Ty mag()						const
 		{
-			return std::sqrt(magSq());
+			return detail::sqrt(magSq());
 		}
-		vec<Ty, 2>& normalize()
+		constexpr vec<Ty, 2>& normalize()
 		{
 			return *this /= mag();
 		}
+		constexpr vec<Ty, 2>& normalize_fast()
+		{
+			const Ty len_sq = magSq();
+			if (len_sq == Ty(0))
+				return *this;
+			return *this *= detail::rsqrt(len_sq);
+		}
 
-		// Random vectors
+		// Random vectors, from the calling thread's engine if none is given,
+		// braced initialization draws the components in order
+		template<random_engine Engine>
+		static vec<Ty, 2> random(Engine& engine, Ty min, Ty max)
+		{
+			return vec<Ty, 2> {
+				get_random_uniform<Ty>(engine, min, max),
+				get_random_uniform<Ty>(engine, min, max)
+			};
+		}
+		template<random_engine Engine>
+		static vec<Ty, 2> random(Engine& engine)
+		{
+			vec<Ty, 2> res {
+				get_random_normal<Ty>(engine, Ty(0), Ty(1)),
+				get_random_normal<Ty>(engine, Ty(0), Ty(1))
+			};
+			return res.normalize();
+		}
+		template<random_engine Engine>
+		static vec<Ty, 2> random_in_unit_disc(Engine& engine)
+		{
+			const Ty a = get_random_uniform<Ty>(engine, Ty(-1), Ty(1));
+			const Ty b = get_random_uniform<Ty>(engine, Ty(-1), Ty(1));
+			Ty x, y;
+			detail::disc_point<simd::native<Ty, 1>, Ty>(a, b, x, y);
+			return vec<Ty, 2>(x, y);
+		}
 		static vec<Ty, 2> random(Ty min, Ty max)
 		{
-			return vec<Ty, 2>(
-				get_random_uniform<Ty>(min, max),
-				get_random_uniform<Ty>(min, max)
-			);
+			return random(thread_generator_for<Ty>(), min, max);
 		}
 		static vec<Ty, 2> random()
 		{
-			vec<Ty, 2> res(
-				get_random_normal<Ty>(Ty(0), Ty(1)),
-				get_random_normal<Ty>(Ty(0), Ty(1))
-			);
-			return res.normalize();
+			return random(thread_generator_for<Ty>());
 		}
 		static vec<Ty, 2> random_in_unit_disc()
 		{
-			vec<Ty, 2> res = random(Ty(-1), Ty(1));
-			while(res.magSq() > 1.0)
-				res = random(Ty(-1), Ty(1));
-			return res;
+			return random_in_unit_disc(thread_generator_for<Ty>());
 		}
 
 	};
@@ -133,53 +467,62 @@ namespace Banan
 
 	public:
 		// Constructors
-		vec<Ty, 3>()
+		constexpr vec()
 			: x(Ty(0)), y(Ty(0)), z(Ty(0))
 		{ }
-		vec<Ty, 3>(const Ty& x, const Ty& y, const Ty& z)
+		constexpr vec(const Ty& x, const Ty& y, const Ty& z)
 			: x(x), y(y), z(z)
 		{ }
+		constexpr vec(const vec<Ty, 3>& v) = default;
+
+		// Element access
+		constexpr Ty& operator[](uint32_t i)
+		{
+			if (std::is_constant_evaluated())
+				return i == 0 ? x : i == 1 ? y : z;
+			return values[i];
+		}
+		constexpr const Ty& operator[](uint32_t i) const
+		{
+			if (std::is_constant_evaluated())
+				return i == 0 ? x : i == 1 ? y : z;
+			return values[i];
+		}
 
 		// Unary operators
-		vec<Ty, 3> operator+() const
+		constexpr vec<Ty, 3> operator+() const
 		{
 			return vec<Ty, 3>(x, y, z);
 		}
-		vec<Ty, 3> operator-() const
+		constexpr vec<Ty, 3> operator-() const
 		{
 			return vec<Ty, 3>(-x, -y, -z);
 		}
 
 		// Assignment operators
-		vec<Ty, 3>& operator =(const vec<Ty, 3>& v)
-		{
-			x = v.x;
-			y = v.y;
-			z = v.z;
-			return *this;
-		}
-		vec<Ty, 3>& operator+=(const vec<Ty, 3>& v)
+		constexpr vec<Ty, 3>& operator =(const vec<Ty, 3>& v) = default;
+		constexpr vec<Ty, 3>& operator+=(const vec<Ty, 3>& v)
 		{
 			x += v.x;
 			y += v.y;
 			z += v.z;
 			return *this;
 		}
-		vec<Ty, 3>& operator-=(const vec<Ty, 3>& v)
+		constexpr vec<Ty, 3>& operator-=(const vec<Ty, 3>& v)
 		{
 			x -= v.x;
 			y -= v.y;
 			z -= v.z;
 			return *this;
 		}
-		vec<Ty, 3>& operator*=(const Ty& val)
+		constexpr vec<Ty, 3>& operator*=(const Ty& val)
 		{
 			x *= val;
 			y *= val;
 			z *= val;
 			return *this;
 		}
-		vec<Ty, 3>& operator/=(const Ty& val)
+		constexpr vec<Ty, 3>& operator/=(const Ty& val)
 		{
 			x /= val;
 			y /= val;
@@ -188,27 +531,33 @@ namespace Banan
 		}
 
 		// Other vector operators
-		Ty dot(const vec<Ty, 3>& v)	const
+		constexpr Ty dot(const vec<Ty, 3>& v)	const
 		{
 			return x * v.x + y * v.y + z * v.z;
 		}
-		Ty magSq()					const
+		constexpr Ty magSq()					const
 		{
 			return x * x + y * y + z * z;
 		}
-		Ty mag()					const
+		constexpr Ty mag()						const
 		{
-			return std::sqrt(magSq());
+			return detail::sqrt(magSq());
 		}
-		vec<Ty, 3>& normalize()
+		constexpr vec<Ty, 3>& normalize()
 		{
 			if (magSq() == 0.0)
 				return *this;
 			return *this /= mag();
 		}
+		constexpr vec<Ty, 3>& normalize_fast()
+		{
+			if (magSq() == 0.0)
+				return *this;
+			return *this *= detail::rsqrt(magSq());
+		}
 
 		// Cross product
-		vec<Ty, 3> cross(const vec<Ty, 3>& v) const
+		constexpr vec<Ty, 3> cross(const vec<Ty, 3>& v) const
 		{
 			return vec<Ty, 3>(
 				y * v.z - z * v.y,
@@ -217,30 +566,49 @@ namespace Banan
 			);
 		}
 
-		// Random vectors
+		// Random vectors, from the calling thread's engine if none is given,
+		// braced initialization draws the components in order
+		template<random_engine Engine>
+		static vec<Ty, 3> random(Engine& engine, Ty min, Ty max)
+		{
+			return vec<Ty, 3> {
+				get_random_uniform<Ty>(engine, min, max),
+				get_random_uniform<Ty>(engine, min, max),
+				get_random_uniform<Ty>(engine, min, max)
+			};
+		}
+		template<random_engine Engine>
+		static vec<Ty, 3> random(Engine& engine)
+		{
+			vec<Ty, 3> res {
+				get_random_normal<Ty>(engine, Ty(0), Ty(1)),
+				get_random_normal<Ty>(engine, Ty(0), Ty(1)),
+				get_random_normal<Ty>(engine, Ty(0), Ty(1))
+			};
+			return res.normalize();
+		}
+		template<random_engine Engine>
+		static vec<Ty, 3> random_in_unit_sphere(Engine& engine)
+		{
+			const Ty a = get_random_uniform<Ty>(engine, Ty(-1), Ty(1));
+			const Ty b = get_random_uniform<Ty>(engine, Ty(-1), Ty(1));
+			const Ty c = get_random_uniform<Ty>(engine, Ty(-1), Ty(1));
+			const Ty h = get_random_uniform<Ty>(engine, Ty(-1), Ty(1));
+			Ty x, y, z;
+			detail::ball_point<simd::native<Ty, 1>, Ty>(a, b, c, h, x, y, z);
+			return vec<Ty, 3>(x, y, z);
+		}
 		static vec<Ty, 3> random(Ty min, Ty max)
 		{
-			return vec<Ty, 3>(
-				get_random_uniform<Ty>(min, max),
-				get_random_uniform<Ty>(min, max),
-				get_random_uniform<Ty>(min, max)
-			);
+			return random(thread_generator_for<Ty>(), min, max);
 		}
 		static vec<Ty, 3> random()
 		{
-			vec<Ty, 3> vec(
-				get_random_normal<Ty>(Ty(0), Ty(1)),
-				get_random_normal<Ty>(Ty(0), Ty(1)),
-				get_random_normal<Ty>(Ty(0), Ty(1))
-			);
-			return vec.normalize();
+			return random(thread_generator_for<Ty>());
 		}
 		static vec<Ty, 3> random_in_unit_sphere()
 		{
-			vec<Ty, 3> res = vec<Ty, 3>::random(Ty(-1), Ty(1));
-			while (res.magSq() > 1.0)
-				res = vec<Ty, 3>::random(Ty(-1), Ty(1));
-			return res;
+			return random_in_unit_sphere(thread_generator_for<Ty>());
 		}
 
 	};
@@ -260,33 +628,41 @@ namespace Banan
 
 	public:
 		// Constructors
-		vec<Ty, 4>()
+		constexpr vec()
 			: x(Ty(0)), y(Ty(0)), z(Ty(0)), w(Ty(0))
 		{ }
-		vec<Ty, 4>(const Ty& x, const Ty& y, const Ty& z, const Ty& w)
+		constexpr vec(const Ty& x, const Ty& y, const Ty& z, const Ty& w)
 			: x(x), y(y), z(z), w(w)
 		{ }
+		constexpr vec(const vec<Ty, 4>& v) = default;
+
+		// Element access
+		constexpr Ty& operator[](uint32_t i)
+		{
+			if (std::is_constant_evaluated())
+				return i == 0 ? x : i == 1 ? y : i == 2 ? z : w;
+			return values[i];
+		}
+		constexpr const Ty& operator[](uint32_t i) const
+		{
+			if (std::is_constant_evaluated())
+				return i == 0 ? x : i == 1 ? y : i == 2 ? z : w;
+			return values[i];
+		}
 
 		// Unary operators
-		vec<Ty, 4> operator+() const
+		constexpr vec<Ty, 4> operator+() const
 		{
 			return vec<Ty, 4>(x, y, z, w);
 		}
-		vec<Ty, 4> operator-() const
+		constexpr vec<Ty, 4> operator-() const
 		{
 			return vec<Ty, 4>(-x, -y, -z, -w);
 		}
 
 		// Assignment operators
-		vec<Ty, 4>& operator =(const vec<Ty, 4>& v)
-		{
-			x = v.x;
-			y = v.y;
-			z = v.z;
-			w = v.w;
-			return *this;
-		}
-		vec<Ty, 4>& operator+=(const vec<Ty, 4>& v)
+		constexpr vec<Ty, 4>& operator =(const vec<Ty, 4>& v) = default;
+		constexpr vec<Ty, 4>& operator+=(const vec<Ty, 4>& v)
 		{
 			x += v.x;
 			y += v.y;
@@ -294,7 +670,7 @@ namespace Banan
 			w += v.w;
 			return *this;
 		}
-		vec<Ty, 4>& operator-=(const vec<Ty, 4>& v)
+		constexpr vec<Ty, 4>& operator-=(const vec<Ty, 4>& v)
 		{
 			x -= v.x;
 			y -= v.y;
@@ -302,7 +678,7 @@ namespace Banan
 			w -= v.w;
 			return *this;
 		}
-		vec<Ty, 4>& operator*=(const Ty& val)
+		constexpr vec<Ty, 4>& operator*=(const Ty& val)
 		{
 			x *= val;
 			y *= val;
@@ -310,7 +686,7 @@ namespace Banan
 			w *= val;
 			return *this;
 		}
-		vec<Ty, 4>& operator/=(const Ty& val)
+		constexpr vec<Ty, 4>& operator/=(const Ty& val)
 		{
 			x /= val;
 			y /= val;
@@ -320,49 +696,516 @@ namespace Banan
 		}
 
 		// Other vector operators
-		Ty dot(const vec<Ty, 4>& v) const
+		constexpr Ty dot(const vec<Ty, 4>& v) const
 		{
 			return x * v.x + y * v.y + z * v.z + w * v.w;
 		}
-		Ty magSq() const
+		constexpr Ty magSq() const
 		{
 			return x * x + y * y + z * z + w * w;
 		}
-		Ty mag() const
+		constexpr Ty mag() const
 		{
-			return std::sqrt(magSq());
+			return detail::sqrt(magSq());
 		}
-		vec<Ty, 4>& normalize()
+		constexpr vec<Ty, 4>& normalize()
 		{
 			return *this /= mag();
 		}
+		constexpr vec<Ty, 4>& normalize_fast()
+		{
+			const Ty len_sq = magSq();
+			if (len_sq == Ty(0))
+				return *this;
+			return *this *= detail::rsqrt(len_sq);
+		}
 
-		// Random vectors
+		// Random vectors, from the calling thread's engine if none is given,
+		// braced initialization draws the components in order
+		template<random_engine Engine>
+		static vec<Ty, 4> random(Engine& engine, Ty min, Ty max)
+		{
+			return vec<Ty, 4> {
+				get_random_uniform<Ty>(engine, min, max),
+				get_random_uniform<Ty>(engine, min, max),
+				get_random_uniform<Ty>(engine, min, max),
+				get_random_uniform<Ty>(engine, min, max)
+			};
+		}
+		template<random_engine Engine>
+		static vec<Ty, 4> random(Engine& engine)
+		{
+			vec<Ty, 4> res {
+				get_random_normal<Ty>(engine, Ty(0), Ty(1)),
+				get_random_normal<Ty>(engine, Ty(0), Ty(1)),
+				get_random_normal<Ty>(engine, Ty(0), Ty(1)),
+				get_random_normal<Ty>(engine, Ty(0), Ty(1))
+			};
+			return res.normalize();
+		}
 		static vec<Ty, 4> random(Ty min, Ty max)
 		{
-			return vec<Ty, 4>(
-				get_random_uniform<Ty>(min, max),
-				get_random_uniform<Ty>(min, max),
-				get_random_uniform<Ty>(min, max),
-				get_random_uniform<Ty>(min, max)
-			);
+			return random(thread_generator_for<Ty>(), min, max);
 		}
 		static vec<Ty, 4> random()
 		{
-			vec<Ty, 4> res(
-				get_random_normal<Ty>(Ty(0), Ty(1)),
-				get_random_normal<Ty>(Ty(0), Ty(1)),
-				get_random_normal<Ty>(Ty(0), Ty(1)),
-				get_random_normal<Ty>(Ty(0), Ty(1))
+			return random(thread_generator_for<Ty>());
+		}
+
+	};
+
+
+	/* ################ SIMD 3d/4d Vector Definitons ############### */
+
+	// For types with a native 4 lane register (float on SSE, double on AVX)
+	// 3d and 4d vectors are stored in a register. 3d vectors keep the
+	// unused 4th lane at zero so full register reductions stay correct.
+	// Intrinsics are not constexpr, so during constant evaluation the
+	// named components are used instead of the register.
+	//
+	// The register makes a 3d vector as large and as aligned as a 4d one:
+	// vec3f takes 16 bytes instead of 12, and vec3d 32 instead of 24 with
+	// AVX. Arrays of them are not tightly packed Ty[3] data, so vertex
+	// buffers, files and other code expecting three components per vector
+	// have to be converted through x, y and z. Builds with BANAN_NO_SIMD
+	// or without the register keep the packed layout.
+
+	template<simd::has_reg4 Ty>
+	class vec<Ty, 3>
+	{
+	private:
+		using reg = simd::reg4<Ty>;
+
+	public:
+		union
+		{
+			typename reg::type simd;
+			Ty values[3];
+			struct { Ty x, y, z; };
+			struct { Ty r, g, b; };
+		};
+
+	public:
+		// Constructors
+		constexpr vec()
+		{
+			if (std::is_constant_evaluated())
+			{
+				x = Ty(0);
+				y = Ty(0);
+				z = Ty(0);
+			}
+			else
+				simd = reg::zero();
+		}
+		constexpr vec(const Ty& x, const Ty& y, const Ty& z)
+		{
+			if (std::is_constant_evaluated())
+			{
+				this->x = x;
+				this->y = y;
+				this->z = z;
+			}
+			else
+				simd = reg::set(x, y, z, Ty(0));
+		}
+		// From a register, the 4th lane is cleared
+		explicit vec(typename reg::type simd)
+			: simd(reg::blend_w(simd, reg::zero()))
+		{ }
+		vec(typename reg::type simd, detail::padded_t)
+			: simd(simd)
+		{ }
+
+		// Element access
+		constexpr Ty& operator[](uint32_t i)
+		{
+			if (std::is_constant_evaluated())
+				return i == 0 ? x : i == 1 ? y : z;
+			return values[i];
+		}
+		constexpr const Ty& operator[](uint32_t i) const
+		{
+			if (std::is_constant_evaluated())
+				return i == 0 ? x : i == 1 ? y : z;
+			return values[i];
+		}
+
+		// Unary operators
+		constexpr vec<Ty, 3> operator+() const
+		{
+			return *this;
+		}
+		constexpr vec<Ty, 3> operator-() const
+		{
+			if (std::is_constant_evaluated())
+				return vec<Ty, 3>(-x, -y, -z);
+			return vec<Ty, 3>(reg::neg(simd), detail::padded);
+		}
+
+		// Assignment operators
+		constexpr vec<Ty, 3>& operator+=(const vec<Ty, 3>& v)
+		{
+			if (std::is_constant_evaluated())
+			{
+				x += v.x;
+				y += v.y;
+				z += v.z;
+			}
+			else
+				simd = reg::add(simd, v.simd);
+			return *this;
+		}
+		constexpr vec<Ty, 3>& operator-=(const vec<Ty, 3>& v)
+		{
+			if (std::is_constant_evaluated())
+			{
+				x -= v.x;
+				y -= v.y;
+				z -= v.z;
+			}
+			else
+				simd = reg::sub(simd, v.simd);
+			return *this;
+		}
+		constexpr vec<Ty, 3>& operator*=(const Ty& val)
+		{
+			if (std::is_constant_evaluated())
+			{
+				x *= val;
+				y *= val;
+				z *= val;
+			}
+			else // Multiply the padding lane by zero, not val, so inf and NaN cannot reach it
+				simd = reg::mul(simd, reg::set(val, val, val, Ty(0)));
+			return *this;
+		}
+		constexpr vec<Ty, 3>& operator/=(const Ty& val)
+		{
+			if (std::is_constant_evaluated())
+			{
+				x /= val;
+				y /= val;
+				z /= val;
+			}
+			else // Divide the padding lane by one to keep it zero
+				simd = reg::div(simd, reg::set(val, val, val, Ty(1)));
+			return *this;
+		}
+
+		// Other vector operators
+		constexpr Ty dot(const vec<Ty, 3>& v)	const
+		{
+			if (std::is_constant_evaluated())
+				return x * v.x + y * v.y + z * v.z;
+			return reg::first(reg::hsum(reg::mul(simd, v.simd)));
+		}
+		constexpr Ty magSq()					const
+		{
+			return dot(*this);
+		}
+		constexpr Ty mag()						const
+		{
+			return detail::sqrt(magSq());
+		}
+		constexpr vec<Ty, 3>& normalize()
+		{
+			if (std::is_constant_evaluated())
+			{
+				if (magSq() == Ty(0))
+					return *this;
+				return *this /= mag();
+			}
+			typename reg::type len_sq = reg::hsum(reg::mul(simd, simd));
+			if (reg::first(len_sq) == Ty(0))
+				return *this;
+			simd = reg::div(simd, reg::sqrt(len_sq));
+			return *this;
+		}
+		constexpr vec<Ty, 3>& normalize_fast()
+		{
+			if (std::is_constant_evaluated())
+				return normalize();
+			// Zero and subnormal lengths take the exact path, the estimate
+			// would give inf for them
+			typename reg::type len_sq = reg::hsum(reg::mul(simd, simd));
+			if (reg::first(len_sq) < std::numeric_limits<Ty>::min())
+				return normalize();
+			simd = reg::mul(simd, reg::rsqrt(len_sq));
+			return *this;
+		}
+
+		// Cross product
+		constexpr vec<Ty, 3> cross(const vec<Ty, 3>& v) const
+		{
+			if (std::is_constant_evaluated())
+			{
+				return vec<Ty, 3>(
+					y * v.z - z * v.y,
+					z * v.x - x * v.z,
+					x * v.y - y * v.x
+				);
+			}
+			typename reg::type c = reg::sub(
+				reg::mul(simd, reg::yzxw(v.simd)),
+				reg::mul(reg::yzxw(simd), v.simd)
 			);
+			return vec<Ty, 3>(reg::yzxw(c), detail::padded);
+		}
+
+		// Random vectors, from the calling thread's engine if none is given,
+		// braced initialization draws the components in order
+		template<random_engine Engine>
+		static vec<Ty, 3> random(Engine& engine, Ty min, Ty max)
+		{
+			return vec<Ty, 3> {
+				get_random_uniform<Ty>(engine, min, max),
+				get_random_uniform<Ty>(engine, min, max),
+				get_random_uniform<Ty>(engine, min, max)
+			};
+		}
+		template<random_engine Engine>
+		static vec<Ty, 3> random(Engine& engine)
+		{
+			vec<Ty, 3> res {
+				get_random_normal<Ty>(engine, Ty(0), Ty(1)),
+				get_random_normal<Ty>(engine, Ty(0), Ty(1)),
+				get_random_normal<Ty>(engine, Ty(0), Ty(1))
+			};
+			return res.normalize();
+		}
+		template<random_engine Engine>
+		static vec<Ty, 3> random_in_unit_sphere(Engine& engine)
+		{
+			const Ty a = get_random_uniform<Ty>(engine, Ty(-1), Ty(1));
+			const Ty b = get_random_uniform<Ty>(engine, Ty(-1), Ty(1));
+			const Ty c = get_random_uniform<Ty>(engine, Ty(-1), Ty(1));
+			const Ty h = get_random_uniform<Ty>(engine, Ty(-1), Ty(1));
+			Ty x, y, z;
+			detail::ball_point<simd::native<Ty, 1>, Ty>(a, b, c, h, x, y, z);
+			return vec<Ty, 3>(x, y, z);
+		}
+		static vec<Ty, 3> random(Ty min, Ty max)
+		{
+			return random(thread_generator_for<Ty>(), min, max);
+		}
+		static vec<Ty, 3> random()
+		{
+			return random(thread_generator_for<Ty>());
+		}
+		static vec<Ty, 3> random_in_unit_sphere()
+		{
+			return random_in_unit_sphere(thread_generator_for<Ty>());
+		}
+
+	};
+
+	template<simd::has_reg4 Ty>
+	class vec<Ty, 4>
+	{
+	private:
+		using reg = simd::reg4<Ty>;
+
+	public:
+		union
+		{
+			typename reg::type simd;
+			Ty values[4];
+			struct { Ty x, y, z, w; };
+			struct { Ty r, g, b, a; };
+		};
+
+	public:
+		// Constructors
+		constexpr vec()
+		{
+			if (std::is_constant_evaluated())
+			{
+				x = Ty(0);
+				y = Ty(0);
+				z = Ty(0);
+				w = Ty(0);
+			}
+			else
+				simd = reg::zero();
+		}
+		constexpr vec(const Ty& x, const Ty& y, const Ty& z, const Ty& w)
+		{
+			if (std::is_constant_evaluated())
+			{
+				this->x = x;
+				this->y = y;
+				this->z = z;
+				this->w = w;
+			}
+			else
+				simd = reg::set(x, y, z, w);
+		}
+		explicit vec(typename reg::type simd)
+			: simd(simd)
+		{ }
+		// Every lane is a component, the tag is accepted for code shared with vec<Ty, 3>
+		vec(typename reg::type simd, detail::padded_t)
+			: simd(simd)
+		{ }
+
+		// Element access
+		constexpr Ty& operator[](uint32_t i)
+		{
+			if (std::is_constant_evaluated())
+				return i == 0 ? x : i == 1 ? y : i == 2 ? z : w;
+			return values[i];
+		}
+		constexpr const Ty& operator[](uint32_t i) const
+		{
+			if (std::is_constant_evaluated())
+				return i == 0 ? x : i == 1 ? y : i == 2 ? z : w;
+			return values[i];
+		}
+
+		// Unary operators
+		constexpr vec<Ty, 4> operator+() const
+		{
+			return *this;
+		}
+		constexpr vec<Ty, 4> operator-() const
+		{
+			if (std::is_constant_evaluated())
+				return vec<Ty, 4>(-x, -y, -z, -w);
+			return vec<Ty, 4>(reg::neg(simd));
+		}
+
+		// Assignment operators
+		constexpr vec<Ty, 4>& operator+=(const vec<Ty, 4>& v)
+		{
+			if (std::is_constant_evaluated())
+			{
+				x += v.x;
+				y += v.y;
+				z += v.z;
+				w += v.w;
+			}
+			else
+				simd = reg::add(simd, v.simd);
+			return *this;
+		}
+		constexpr vec<Ty, 4>& operator-=(const vec<Ty, 4>& v)
+		{
+			if (std::is_constant_evaluated())
+			{
+				x -= v.x;
+				y -= v.y;
+				z -= v.z;
+				w -= v.w;
+			}
+			else
+				simd = reg::sub(simd, v.simd);
+			return *this;
+		}
+		constexpr vec<Ty, 4>& operator*=(const Ty& val)
+		{
+			if (std::is_constant_evaluated())
+			{
+				x *= val;
+				y *= val;
+				z *= val;
+				w *= val;
+			}
+			else
+				simd = reg::mul(simd, reg::broadcast(val));
+			return *this;
+		}
+		constexpr vec<Ty, 4>& operator/=(const Ty& val)
+		{
+			if (std::is_constant_evaluated())
+			{
+				x /= val;
+				y /= val;
+				z /= val;
+				w /= val;
+			}
+			else
+				simd = reg::div(simd, reg::broadcast(val));
+			return *this;
+		}
+
+		// Other vector operators
+		constexpr Ty dot(const vec<Ty, 4>& v) const
+		{
+			if (std::is_constant_evaluated())
+				return x * v.x + y * v.y + z * v.z + w * v.w;
+			return reg::first(reg::hsum(reg::mul(simd, v.simd)));
+		}
+		constexpr Ty magSq() const
+		{
+			return dot(*this);
+		}
+		constexpr Ty mag() const
+		{
+			return detail::sqrt(magSq());
+		}
+		constexpr vec<Ty, 4>& normalize()
+		{
+			if (std::is_constant_evaluated())
+				return *this /= mag();
+			simd = reg::div(simd, reg::sqrt(reg::hsum(reg::mul(simd, simd))));
+			return *this;
+		}
+		constexpr vec<Ty, 4>& normalize_fast()
+		{
+			if (std::is_constant_evaluated())
+				return normalize();
+			// As for vec<Ty, 3>, zero vectors are left untouched
+			typename reg::type len_sq = reg::hsum(reg::mul(simd, simd));
+			if (reg::first(len_sq) < std::numeric_limits<Ty>::min())
+			{
+				if (reg::first(len_sq) != Ty(0))
+					simd = reg::div(simd, reg::sqrt(len_sq));
+				return *this;
+			}
+			simd = reg::mul(simd, reg::rsqrt(len_sq));
+			return *this;
+		}
+
+		// Random vectors, from the calling thread's engine if none is given,
+		// braced initialization draws the components in order
+		template<random_engine Engine>
+		static vec<Ty, 4> random(Engine& engine, Ty min, Ty max)
+		{
+			return vec<Ty, 4> {
+				get_random_uniform<Ty>(engine, min, max),
+				get_random_uniform<Ty>(engine, min, max),
+				get_random_uniform<Ty>(engine, min, max),
+				get_random_uniform<Ty>(engine, min, max)
+			};
+		}
+		template<random_engine Engine>
+		static vec<Ty, 4> random(Engine& engine)
+		{
+			vec<Ty, 4> res {
+				get_random_normal<Ty>(engine, Ty(0), Ty(1)),
+				get_random_normal<Ty>(engine, Ty(0), Ty(1)),
+				get_random_normal<Ty>(engine, Ty(0), Ty(1)),
+				get_random_normal<Ty>(engine, Ty(0), Ty(1))
+			};
 			return res.normalize();
 		}
+		static vec<Ty, 4> random(Ty min, Ty max)
+		{
+			return random(thread_generator_for<Ty>(), min, max);
+		}
+		static vec<Ty, 4> random()
+		{
+			return random(thread_generator_for<Ty>());
+		}
 
 	};
 
 
 	/* ################### 5d+ Vector Definiton #################### */
 
+	// Operations are generated at compile time by the detail::vec_* kernels
+	// (unrolled for small sizes, register chunks for large ones).
 	template<typename Ty, uint32_t Size>
 	class vec
 	{
@@ -370,93 +1213,105 @@ namespace Banan
 		Ty values[Size]{};
 
 	public:
-		vec() = default;
+		constexpr vec() = default;
+		constexpr vec(const vec<Ty, Size>& v) = default;
 		
 
+		// Element access
+		constexpr Ty& operator[](uint32_t i)
+		{
+			return values[i];
+		}
+		constexpr const Ty& operator[](uint32_t i) const
+		{
+			return values[i];
+		}
+
 		// Unary operators
-		vec<Ty, Size> operator+() const
+		constexpr vec<Ty, Size> operator+() const
 		{
 			return *this;
 		}
-		vec<Ty, Size> operator-() const
+		constexpr vec<Ty, Size> operator-() const
 		{
 			vec<Ty, Size> result = *this;
-			for (int i = 0; i < Size; i++)
-				result.values[i] = -result.values[i];
+			detail::vec_apply_scalar<detail::op_mul, Size>(result.values, Ty(-1));
 			return result;
 		}
 
 		// Assignment operators
-		vec<Ty, Size>& operator =(const vec<Ty, Size>& v)
+		constexpr vec<Ty, Size>& operator =(const vec<Ty, Size>& v) = default;
+		constexpr vec<Ty, Size>& operator+=(const vec<Ty, Size>& v)
 		{
-			for (int i = 0; i < Size; i++)
-				values[i] = v.values[i];
+			detail::vec_apply<detail::op_add, Size>(values, v.values);
 			return *this;
 		}
-		vec<Ty, Size>& operator+=(const vec<Ty, Size>& v)
+		constexpr vec<Ty, Size>& operator-=(const vec<Ty, Size>& v)
 		{
-			for (int i = 0; i < Size; i++)
-				values[i] += v.values[i];
+			detail::vec_apply<detail::op_sub, Size>(values, v.values);
 			return *this;
 		}
-		vec<Ty, Size>& operator-=(const vec<Ty, Size>& v)
+		constexpr vec<Ty, Size>& operator*=(const Ty& val)
 		{
-			for (int i = 0; i < Size; i++)
-				values[i] -= v.values[i];
+			detail::vec_apply_scalar<detail::op_mul, Size>(values, val);
 			return *this;
 		}
-		vec<Ty, Size>& operator*=(const Ty& val)
+		constexpr vec<Ty, Size>& operator/=(const Ty& val)
 		{
-			for (int i = 0; i < Size; i++)
-				values[i] *= val;
-			return *this;
-		}
-		vec<Ty, Size>& operator/=(const Ty& val)
-		{
-			for (int i = 0; i < Size; i++)
-				values[i] /= val;
+			detail::vec_apply_scalar<detail::op_div, Size>(values, val);
 			return *this;
 		}
 
 		// Other vector operators
-		Ty dot(const vec<Ty, Size>& v) const
+		constexpr Ty dot(const vec<Ty, Size>& v) const
 		{
-			Ty result = Ty(0);
-			for (int i = 0; i < Size; i++)
-				result += values[i] * v.values[i];
-			return result;
+			return detail::vec_dot<Size>(values, v.values);
 		}
-		Ty magSq() const
+		constexpr Ty magSq() const
 		{
-			Ty result = Ty(0);
-			for (int i = 0; i < Size; i++)
-				result += values[i] * values[i];
-			return result;
+			return detail::vec_dot<Size>(values, values);
 		}
-		Ty mag() const
+		constexpr Ty mag() const
 		{
-			return std::sqrt(magSq());
+			return detail::sqrt(magSq());
 		}
-		vec<Ty, Size>& normalize()
+		constexpr vec<Ty, Size>& normalize()
 		{
 			return *this /= mag();
 		}
+		constexpr vec<Ty, Size>& normalize_fast()
+		{
+			const Ty len_sq = magSq();
+			if (len_sq == Ty(0))
+				return *this;
+			return *this *= detail::rsqrt(len_sq);
+		}
 
-		// Random vectors
-		static vec<Ty, Size> random(Ty min, Ty max)
+		// Random vectors, from the calling thread's engine if none is given
+		template<random_engine Engine>
+		static vec<Ty, Size> random(Engine& engine, Ty min, Ty max)
 		{
 			vec<Ty, Size> res;
-			for (int i = 0; i < Size; i++)
-				res[i] = get_random_uniform<Ty>(min, max);
+			for (uint32_t i = 0; i < Size; i++)
+				res[i] = get_random_uniform<Ty>(engine, min, max);
 			return res;
 		}
-		static vec<Ty, Size> random()
+		template<random_engine Engine>
+		static vec<Ty, Size> random(Engine& engine)
 		{
 			vec<Ty, Size> res;
-			for (int i = 0; i < Size; i++)
-				res[i] = get_random_normal<Ty>(Ty(0), Ty(1));
+			for (uint32_t i = 0; i < Size; i++)
+				res[i] = get_random_normal<Ty>(engine, Ty(0), Ty(1));
 			return res.normalize();
 		}
+		static vec<Ty, Size> random(Ty min, Ty max)
+		{
+			return random(thread_generator_for<Ty>(), min, max);
+		}
+		static vec<Ty, Size> random()
+		{
+			return random(thread_generator_for<Ty>());
+		}
 
 	};
 
@@ -465,36 +1320,206 @@ namespace Banan
 
 	// Unit vector
 	template<typename Ty, uint32_t Size>
-	vec<Ty, Size> unit(const vec<Ty, Size>& v)
+	constexpr vec<Ty, Size> unit(const vec<Ty, Size>& v)
 	{
 		vec<Ty, Size> copy = v;
 		return copy.normalize();
 	}
+	template<typename Ty, uint32_t Size>
+	constexpr vec<Ty, Size> unit_fast(const vec<Ty, Size>& v)
+	{
+		vec<Ty, Size> copy = v;
+		return copy.normalize_fast();
+	}
+
+	// Normalize arrays of vectors with the fast path. Squared lengths are
+	// gathered in blocks so the reciprocal square roots run in the widest
+	// native register, zero length vectors are left untouched and registers
+	// holding a subnormal length fall back to 1 / sqrt. out must hold at
+	// least in.size() vectors.
+	template<typename Ty, uint32_t Size, std::size_t InExtent, std::size_t OutExtent>
+	void unit_fast(std::span<const vec<Ty, Size>, InExtent> in, std::span<vec<Ty, Size>, OutExtent> out)
+	{
+		assert(out.size() >= in.size() && "unit_fast output is shorter than its input");
+		using native = simd::native_widest<Ty>;
+		constexpr std::size_t block = 64;
+		alignas(64) Ty scale[block];
+
+		for (std::size_t base = 0; base < in.size(); base += block)
+		{
+			std::size_t count = std::min(block, in.size() - base);
+			for (std::size_t i = 0; i < count; i++)
+				scale[i] = in[base + i].magSq();
+
+			std::size_t i = 0;
+			if constexpr (std::is_floating_point_v<Ty>)
+			{
+				for (; i + native::lanes <= count; i += native::lanes)
+				{
+					auto len_sq = native::load(scale + i);
+					auto one = native::broadcast(Ty(1));
+					auto zero = native::cmp_eq(len_sq, native::broadcast(Ty(0)));
+					auto tiny = native::cmp_lt(len_sq, native::broadcast(std::numeric_limits<Ty>::min()));
+					auto inv = native::movemask(tiny) ? native::div(one, native::sqrt(len_sq)) : native::rsqrt(len_sq);
+					native::store(scale + i, native::blend(zero, one, inv));
+				}
+			}
+			for (; i < count; i++)
+				scale[i] = scale[i] == Ty(0) ? Ty(1) : detail::rsqrt(scale[i]);
+
+			for (i = 0; i < count; i++)
+				out[base + i] = in[base + i] * scale[i];
+		}
+	}
+	template<typename Ty, uint32_t Size, std::size_t Extent>
+	void normalize_fast(std::span<vec<Ty, Size>, Extent> vs)
+	{
+		unit_fast(std::span<const vec<Ty, Size>>(vs), vs);
+	}
+
+	// Dirichlet(alpha) distributed vectors, Gamma(alpha[i]) components
+	// divided by their sum, from the calling thread's engine if none is
+	// given. Arrays are filled through fill_dirichlet of random.h, a
+	// component at a time for blocks of vectors.
+	template<typename Ty, uint32_t Size, random_engine Engine>
+	vec<Ty, Size> get_random_dirichlet(Engine& engine, const vec<Ty, Size>& alpha)
+	{
+		Ty components[Size];
+		for (uint32_t i = 0; i < Size; i++)
+			components[i] = alpha[i];
+		vec<Ty, Size> res;
+		detail::get_random_dirichlet<Ty>(engine, std::span<const Ty>(components), [&](std::size_t k) -> Ty& { return res[uint32_t(k)]; });
+		return res;
+	}
+	template<typename Ty, uint32_t Size>
+	vec<Ty, Size> get_random_dirichlet(const vec<Ty, Size>& alpha)
+	{
+		return get_random_dirichlet(thread_generator_for<Ty>(), alpha);
+	}
+	template<typename Ty, uint32_t Size, random_engine Engine, std::size_t Extent>
+	void fill_dirichlet(Engine& engine, std::span<vec<Ty, Size>, Extent> out, const vec<Ty, Size>& alpha)
+	{
+		Ty components[Size];
+		for (uint32_t i = 0; i < Size; i++)
+			components[i] = alpha[i];
+		detail::fill_dirichlet<Ty>(engine, out.size(), std::span<const Ty>(components),
+			[&](std::size_t i, std::size_t k) -> Ty& { return out[i][uint32_t(k)]; });
+	}
+	template<typename Ty, uint32_t Size, std::size_t Extent>
+	void fill_dirichlet(std::span<vec<Ty, Size>, Extent> out, const vec<Ty, Size>& alpha)
+	{
+		fill_dirichlet(thread_generator_for<Ty>(), out, alpha);
+	}
+
+	namespace detail
+	{
+		// Draws Inputs uniform values on [-1, 1) per point a block at a
+		// time, kernel(N, inputs..., outputs...) maps them to the Size
+		// components in the widest native register, native<Ty, 1> handles
+		// the tail.
+		template<typename Ty, uint32_t Inputs, uint32_t Size, typename Engine, typename Kernel>
+		void fill_points(Engine& engine, std::span<vec<Ty, Size>> out, const Kernel& kernel)
+		{
+			using native = simd::native_widest<Ty>;
+			using scalar = simd::native<Ty, 1>;
+			constexpr std::size_t block = 256;
+			alignas(64) Ty in[Inputs][block];
+			alignas(64) Ty res[Size][block];
+
+			const auto run = [&]<typename N, uint32_t... I, uint32_t... J>(N, std::size_t i, std::integer_sequence<uint32_t, I...>, std::integer_sequence<uint32_t, J...>)
+			{
+				typename N::type values[Size];
+				kernel(N(), N::load(in[I] + i)..., values[J]...);
+				(N::store(res[J] + i, values[J]), ...);
+			};
+
+			for (std::size_t base = 0; base < out.size(); base += block)
+			{
+				const std::size_t count = std::min(block, out.size() - base);
+				for (uint32_t k = 0; k < Inputs; k++)
+					fill_uniform<Ty>(engine, std::span<Ty>(in[k], count), Ty(-1), Ty(1));
+
+				std::size_t i = 0;
+				for (; i + native::lanes <= count; i += native::lanes)
+					run(native(), i, std::make_integer_sequence<uint32_t, Inputs>(), std::make_integer_sequence<uint32_t, Size>());
+				for (; i < count; i++)
+					run(scalar(), i, std::make_integer_sequence<uint32_t, Inputs>(), std::make_integer_sequence<uint32_t, Size>());
+
+				for (i = 0; i < count; i++)
+					for (uint32_t k = 0; k < Size; k++)
+						out[base + i][k] = res[k][i];
+			}
+		}
+	}
+
+	// Arrays of uniform points in the unit disc and ball and on the unit
+	// sphere, from the calling thread's engine if none is given. The points
+	// go through the kernels of random_in_unit_disc and
+	// random_in_unit_sphere a simd register at a time.
+	template<typename Ty, random_engine Engine, std::size_t Extent>
+	void fill_in_unit_disc(Engine& engine, std::span<vec<Ty, 2>, Extent> out)
+	{
+		detail::fill_points<Ty, 2>(engine, std::span<vec<Ty, 2>>(out), [](auto n, auto a, auto b, auto& x, auto& y)
+		{
+			detail::disc_point<decltype(n), Ty>(a, b, x, y);
+		});
+	}
+	template<typename Ty, std::size_t Extent>
+	void fill_in_unit_disc(std::span<vec<Ty, 2>, Extent> out)
+	{
+		fill_in_unit_disc(thread_generator_for<Ty>(), out);
+	}
+	template<typename Ty, random_engine Engine, std::size_t Extent>
+	void fill_in_unit_sphere(Engine& engine, std::span<vec<Ty, 3>, Extent> out)
+	{
+		detail::fill_points<Ty, 4>(engine, std::span<vec<Ty, 3>>(out), [](auto n, auto a, auto b, auto c, auto h, auto& x, auto& y, auto& z)
+		{
+			detail::ball_point<decltype(n), Ty>(a, b, c, h, x, y, z);
+		});
+	}
+	template<typename Ty, std::size_t Extent>
+	void fill_in_unit_sphere(std::span<vec<Ty, 3>, Extent> out)
+	{
+		fill_in_unit_sphere(thread_generator_for<Ty>(), out);
+	}
+	template<typename Ty, random_engine Engine, std::size_t Extent>
+	void fill_on_unit_sphere(Engine& engine, std::span<vec<Ty, 3>, Extent> out)
+	{
+		detail::fill_points<Ty, 3>(engine, std::span<vec<Ty, 3>>(out), [](auto n, auto a, auto b, auto h, auto& x, auto& y, auto& z)
+		{
+			detail::sphere_point<decltype(n), Ty>(a, b, h, x, y, z);
+		});
+	}
+	template<typename Ty, std::size_t Extent>
+	void fill_on_unit_sphere(std::span<vec<Ty, 3>, Extent> out)
+	{
+		fill_on_unit_sphere(thread_generator_for<Ty>(), out);
+	}
 
 	// Reflect/Refract vector
 	template<typename Ty, uint32_t Size>
-	vec<Ty, Size> reflect(const vec<Ty, Size>& v, const vec<Ty, Size>& n)
+	constexpr vec<Ty, Size> reflect(const vec<Ty, Size>& v, const vec<Ty, Size>& n)
 	{
 		return v - Ty(2) * (v * n) * n;
 	}
 	template<typename Ty, uint32_t Size>
-	vec<Ty, Size> refract(const vec<Ty, Size>& v, const vec<Ty, Size>& n, Ty refraction_ratio)
+	constexpr vec<Ty, Size> refract(const vec<Ty, Size>& v, const vec<Ty, Size>& n, Ty refraction_ratio)
 	{
 		Ty cos_theta = std::min(-v * n, Ty(1));
 		vec<Ty, Size> r_out_prep = refraction_ratio * (v + cos_theta * n);
-		vec<Ty, Size> r_out_paral = -std::sqrt(std::abs(Ty(1) - r_out_prep.magSq())) * n;
+		vec<Ty, Size> r_out_paral = -detail::sqrt(detail::abs(Ty(1) - r_out_prep.magSq())) * n;
 		return r_out_prep + r_out_paral;
 	}
 
 	// Addition/Subtraction of vectors
 	template<typename Ty, uint32_t Size>
-	vec<Ty, Size> operator+(const vec<Ty, Size>& a, const vec<Ty, Size>& b)
+	constexpr vec<Ty, Size> operator+(const vec<Ty, Size>& a, const vec<Ty, Size>& b)
 	{
 		vec<Ty, Size> copy = a;
 		return copy += b;
 	}
 	template<typename Ty, uint32_t Size>
-	vec<Ty, Size> operator-(const vec<Ty, Size>& a, const vec<Ty, Size>& b)
+	constexpr vec<Ty, Size> operator-(const vec<Ty, Size>& a, const vec<Ty, Size>& b)
 	{
 		vec<Ty, Size> copy = a;
 		return copy -= b;
@@ -502,19 +1527,19 @@ namespace Banan
 
 	// Multiplying/Dividing vector with scalar
 	template<typename Ty, uint32_t Size>
-	vec<Ty, Size> operator*(const vec<Ty, Size>& v, const Ty& val)
+	constexpr vec<Ty, Size> operator*(const vec<Ty, Size>& v, const Ty& val)
 	{
 		vec<Ty, Size> copy = v;
 		return copy *= val;
 	}
 	template<typename Ty, uint32_t Size>
-	vec<Ty, Size> operator*(const Ty& val, const vec<Ty, Size>& v)
+	constexpr vec<Ty, Size> operator*(const Ty& val, const vec<Ty, Size>& v)
 	{
 		vec<Ty, Size> copy = v;
 		return copy *= val;
 	}
 	template<typename Ty, uint32_t Size>
-	vec<Ty, Size> operator/(const vec<Ty, Size>& v, const Ty& val)
+	constexpr vec<Ty, Size> operator/(const vec<Ty, Size>& v, const Ty& val)
 	{
 		vec<Ty, Size> copy = v;
 		return copy /= val;
@@ -522,33 +1547,82 @@ namespace Banan
 
 	// Multiplying vector with vector (dot and cross (3d))
 	template<typename Ty, uint32_t Size>
-	Ty operator*(const vec<Ty, Size>& a, const vec<Ty, Size>& b)
+	constexpr Ty operator*(const vec<Ty, Size>& a, const vec<Ty, Size>& b)
 	{
 		return a.dot(b);
 	}
 	template<typename Ty, uint32_t Size>
-	Ty dot(const vec<Ty, Size>& a, const vec<Ty, Size>& b)
+	constexpr Ty dot(const vec<Ty, Size>& a, const vec<Ty, Size>& b)
 	{
 		return a.dot(b);
 	}
 	template<typename Ty>
-	vec<Ty, 3> cross(const vec<Ty, 3>& a, const vec<Ty, 3>& b)
+	constexpr vec<Ty, 3> cross(const vec<Ty, 3>& a, const vec<Ty, 3>& b)
 	{
 		return a.cross(b);
 	}
 
 	// Multiply elements together
 	template<typename Ty, uint32_t Size>
-	vec<Ty, Size> elem_mult(const vec<Ty, Size>& a, const vec<Ty, Size>& b)
+	constexpr vec<Ty, Size> elem_mult(const vec<Ty, Size>& a, const vec<Ty, Size>& b)
 	{
 		vec<Ty, Size> result = a;
-		for (int i = 0; i < Size; i++)
-			result.values[i] *= b.values[i];
+		if constexpr (Size > 4)
+			detail::vec_apply<detail::op_mul, Size>(result.values, b.values);
+		else
+		{
+			for (uint32_t i = 0; i < Size; i++)
+				result[i] *= b[i];
+		}
 		return result;
 	}
 
+	// SIMD versions of the helpers above for register backed vectors
+	template<simd::has_reg4 Ty, uint32_t Size> requires (Size == 3 || Size == 4)
+	constexpr vec<Ty, Size> reflect(const vec<Ty, Size>& v, const vec<Ty, Size>& n)
+	{
+		if (std::is_constant_evaluated())
+			return v - Ty(2) * v.dot(n) * n;
+		using reg = simd::reg4<Ty>;
+		typename reg::type d = reg::hsum(reg::mul(v.simd, n.simd));
+		return vec<Ty, Size>(reg::sub(v.simd, reg::mul(reg::add(d, d), n.simd)), detail::padded);
+	}
+	template<simd::has_reg4 Ty, uint32_t Size> requires (Size == 3 || Size == 4)
+	constexpr vec<Ty, Size> refract(const vec<Ty, Size>& v, const vec<Ty, Size>& n, Ty refraction_ratio)
+	{
+		if (std::is_constant_evaluated())
+		{
+			vec<Ty, Size> r_out_prep = refraction_ratio * (v + std::min(-v.dot(n), Ty(1)) * n);
+			return r_out_prep - detail::sqrt(detail::abs(Ty(1) - r_out_prep.magSq())) * n;
+		}
+		using reg = simd::reg4<Ty>;
+		typename reg::type one = reg::broadcast(Ty(1));
+		typename reg::type cos_theta = reg::min(reg::neg(reg::hsum(reg::mul(v.simd, n.simd))), one);
+		typename reg::type r_out_prep = reg::mul(reg::broadcast(refraction_ratio), reg::add(v.simd, reg::mul(cos_theta, n.simd)));
+		typename reg::type k = reg::sqrt(reg::abs(reg::sub(one, reg::hsum(reg::mul(r_out_prep, r_out_prep)))));
+		return vec<Ty, Size>(reg::sub(r_out_prep, reg::mul(k, n.simd)), detail::padded);
+	}
+	template<simd::has_reg4 Ty, uint32_t Size> requires (Size == 3 || Size == 4)
+	constexpr vec<Ty, Size> elem_mult(const vec<Ty, Size>& a, const vec<Ty, Size>& b)
+	{
+		if (std::is_constant_evaluated())
+		{
+			vec<Ty, Size> result = a;
+			for (uint32_t i = 0; i < Size; i++)
+				result[i] *= b[i];
+			return result;
+		}
+		using reg = simd::reg4<Ty>;
+		return vec<Ty, Size>(reg::mul(a.simd, b.simd), detail::padded);
+	}
+
+
 
 
+	// The layout of register backed 3d vectors, see above
+	static_assert(!simd::has_reg4<float> || sizeof(vec<float, 3>) == 4 * sizeof(float));
+	static_assert(!simd::has_reg4<double> || sizeof(vec<double, 3>) == 4 * sizeof(double));
+	static_assert(simd::has_reg4<float> || sizeof(vec<float, 3>) == 3 * sizeof(float));
 
 	// Definitions for most common vectors
 	using vec2i = vec<int32_t,	2>;
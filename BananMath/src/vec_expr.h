@@ -0,0 +1,303 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <type_traits>
+
+#include "vec.h"
+
+// Opt-in expression templates for vec arithmetic.
+//
+// Wrap operands with expr::lazy() and the usual operators build an
+// expression tree instead of temporaries. The tree is evaluated in one
+// fused loop when converted to a vec, passed to expr::eval or assigned
+// with expr::assign / += / -=:
+//
+//	vec<float, 256> r = expr::lazy(a) + s * expr::lazy(b) - c;
+//
+// Expressions hold references to their vec operands, so they must be
+// evaluated before any operand goes out of scope. Element-wise
+// expressions are safe to assign back into one of their operands.
+
+namespace Banan::expr
+{
+
+	template<typename E>
+	concept expression = requires(const E& e, uint32_t i)
+	{
+		typename E::value_type;
+		{ E::size } -> std::convertible_to<uint32_t>;
+		{ e[i] } -> std::convertible_to<typename E::value_type>;
+	};
+
+	// Evaluate expression into a new vector
+	template<expression E>
+	vec<typename E::value_type, E::size> eval(const E& e)
+	{
+		vec<typename E::value_type, E::size> result;
+		for (uint32_t i = 0; i < E::size; i++)
+			result[i] = e[i];
+		return result;
+	}
+
+	// Base of all expression nodes, allows implicit evaluation to vec
+	template<typename Derived, typename Ty, uint32_t Size>
+	class node
+	{
+	public:
+		using value_type = Ty;
+		static constexpr uint32_t size = Size;
+
+	public:
+		operator vec<Ty, Size>() const
+		{
+			return expr::eval(static_cast<const Derived&>(*this));
+		}
+	};
+
+	/* ######################### Leaves ########################## */
+
+	// Reference to an existing vector
+	template<typename Ty, uint32_t Size>
+	class ref : public node<ref<Ty, Size>, Ty, Size>
+	{
+	public:
+		explicit ref(const vec<Ty, Size>& v)
+			: m_vec(v)
+		{ }
+
+		Ty operator[](uint32_t i) const
+		{
+			return m_vec[i];
+		}
+
+	private:
+		const vec<Ty, Size>& m_vec;
+	};
+
+	// Scalar broadcast to every element
+	template<typename Ty, uint32_t Size>
+	class broadcast : public node<broadcast<Ty, Size>, Ty, Size>
+	{
+	public:
+		explicit broadcast(const Ty& val)
+			: m_val(val)
+		{ }
+
+		Ty operator[](uint32_t) const
+		{
+			return m_val;
+		}
+
+	private:
+		Ty m_val;
+	};
+
+	/* ######################### Nodes ########################### */
+
+	struct op_add { template<typename Ty> static Ty apply(const Ty& a, const Ty& b) { return a + b; } };
+	struct op_sub { template<typename Ty> static Ty apply(const Ty& a, const Ty& b) { return a - b; } };
+	struct op_mul { template<typename Ty> static Ty apply(const Ty& a, const Ty& b) { return a * b; } };
+	struct op_div { template<typename Ty> static Ty apply(const Ty& a, const Ty& b) { return a / b; } };
+
+	template<expression E>
+	class negate : public node<negate<E>, typename E::value_type, E::size>
+	{
+	public:
+		explicit negate(const E& e)
+			: m_e(e)
+		{ }
+
+		typename E::value_type operator[](uint32_t i) const
+		{
+			return -m_e[i];
+		}
+
+	private:
+		E m_e;
+	};
+
+	template<expression L, expression R, typename Op>
+	class binary : public node<binary<L, R, Op>, typename L::value_type, L::size>
+	{
+		static_assert(L::size == R::size, "vector expressions must have equal size");
+		static_assert(std::is_same_v<typename L::value_type, typename R::value_type>, "vector expressions must have equal value type");
+
+	public:
+		binary(const L& l, const R& r)
+			: m_l(l), m_r(r)
+		{ }
+
+		typename L::value_type operator[](uint32_t i) const
+		{
+			return Op::apply(m_l[i], m_r[i]);
+		}
+
+	private:
+		L m_l;
+		R m_r;
+	};
+
+	/* ####################### Operands ########################## */
+
+	namespace detail
+	{
+		template<typename T>
+		struct is_vec : std::false_type { };
+		template<typename Ty, uint32_t Size>
+		struct is_vec<vec<Ty, Size>> : std::true_type { };
+
+		// Vectors become ref leaves, expressions are stored by value
+		template<typename Ty, uint32_t Size>
+		ref<Ty, Size> as_node(const vec<Ty, Size>& v)
+		{
+			return ref<Ty, Size>(v);
+		}
+		template<expression E>
+		const E& as_node(const E& e)
+		{
+			return e;
+		}
+
+		template<typename T>
+		using node_t = std::remove_cvref_t<decltype(as_node(std::declval<const T&>()))>;
+	}
+
+	template<typename T>
+	concept operand = expression<T> || detail::is_vec<T>::value;
+
+	// Both sides operands and at least one an expression, vec op vec stays eager
+	template<typename L, typename R>
+	concept lazy_pair = operand<L> && operand<R> && (expression<L> || expression<R>);
+
+	// Start an expression from a vector
+	template<typename Ty, uint32_t Size>
+	ref<Ty, Size> lazy(const vec<Ty, Size>& v)
+	{
+		return ref<Ty, Size>(v);
+	}
+
+	/* ####################### Operators ######################### */
+
+	template<expression E>
+	E operator+(const E& e)
+	{
+		return e;
+	}
+	template<expression E>
+	negate<E> operator-(const E& e)
+	{
+		return negate<E>(e);
+	}
+
+	// Addition/Subtraction of vectors
+	template<typename L, typename R> requires lazy_pair<L, R>
+	auto operator+(const L& l, const R& r)
+	{
+		return binary<detail::node_t<L>, detail::node_t<R>, op_add>(detail::as_node(l), detail::as_node(r));
+	}
+	template<typename L, typename R> requires lazy_pair<L, R>
+	auto operator-(const L& l, const R& r)
+	{
+		return binary<detail::node_t<L>, detail::node_t<R>, op_sub>(detail::as_node(l), detail::as_node(r));
+	}
+
+	// Multiplying/Dividing vector with scalar
+	template<expression E>
+	auto operator*(const E& e, const typename E::value_type& val)
+	{
+		using scalar = broadcast<typename E::value_type, E::size>;
+		return binary<E, scalar, op_mul>(e, scalar(val));
+	}
+	template<expression E>
+	auto operator*(const typename E::value_type& val, const E& e)
+	{
+		using scalar = broadcast<typename E::value_type, E::size>;
+		return binary<scalar, E, op_mul>(scalar(val), e);
+	}
+	template<expression E>
+	auto operator/(const E& e, const typename E::value_type& val)
+	{
+		using scalar = broadcast<typename E::value_type, E::size>;
+		return binary<E, scalar, op_div>(e, scalar(val));
+	}
+
+	// Multiply elements together, lazy even for two plain vectors
+	template<operand L, operand R>
+	auto elem_mult(const L& l, const R& r)
+	{
+		return binary<detail::node_t<L>, detail::node_t<R>, op_mul>(detail::as_node(l), detail::as_node(r));
+	}
+
+	/* ###################### Reductions ######################### */
+
+	// Reductions evaluate immediately in a single pass
+	template<operand L, operand R>
+	auto dot(const L& l, const R& r)
+	{
+		auto a = detail::as_node(l);
+		auto b = detail::as_node(r);
+		using Ty = typename decltype(a)::value_type;
+		Ty result = Ty(0);
+		for (uint32_t i = 0; i < decltype(a)::size; i++)
+			result += a[i] * b[i];
+		return result;
+	}
+	template<expression E>
+	typename E::value_type magSq(const E& e)
+	{
+		using Ty = typename E::value_type;
+		Ty result = Ty(0);
+		for (uint32_t i = 0; i < E::size; i++)
+		{
+			Ty v = e[i];
+			result += v * v;
+		}
+		return result;
+	}
+
+	/* ###################### Assignment ######################### */
+
+	// Evaluate expression into an existing vector
+	template<typename Ty, uint32_t Size, expression E> requires (E::size == Size)
+	vec<Ty, Size>& assign(vec<Ty, Size>& v, const E& e)
+	{
+		for (uint32_t i = 0; i < Size; i++)
+			v[i] = e[i];
+		return v;
+	}
+	template<typename Ty, uint32_t Size, expression E> requires (E::size == Size)
+	vec<Ty, Size>& operator+=(vec<Ty, Size>& v, const E& e)
+	{
+		for (uint32_t i = 0; i < Size; i++)
+			v[i] += e[i];
+		return v;
+	}
+	template<typename Ty, uint32_t Size, expression E> requires (E::size == Size)
+	vec<Ty, Size>& operator-=(vec<Ty, Size>& v, const E& e)
+	{
+		for (uint32_t i = 0; i < Size; i++)
+			v[i] -= e[i];
+		return v;
+	}
+
+	/* ################## Reflect/Refract vector ################# */
+
+	// The dot products are evaluated up front, the rest fuses into one loop
+	template<typename Ty, uint32_t Size>
+	auto reflect(const vec<Ty, Size>& v, const vec<Ty, Size>& n)
+	{
+		return lazy(v) - (Ty(2) * v.dot(n)) * lazy(n);
+	}
+	template<typename Ty, uint32_t Size>
+	vec<Ty, Size> refract(const vec<Ty, Size>& v, const vec<Ty, Size>& n, Ty refraction_ratio)
+	{
+		Ty cos_theta = std::min(-v.dot(n), Ty(1));
+		auto r_out_prep = refraction_ratio * (lazy(v) + cos_theta * lazy(n));
+		Ty k = std::sqrt(std::abs(Ty(1) - magSq(r_out_prep)));
+		return eval(r_out_prep - k * lazy(n));
+	}
+
+}
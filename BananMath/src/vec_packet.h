@@ -0,0 +1,703 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "simd.h"
+#include "vec.h"
+
+namespace Banan
+{
+
+	// Packets hold Width independent lanes and are processed lane-wise in
+	// the widest native register that divides Width (see simd::native_for).
+	// Width 4 fits SSE, 8 fits AVX and 16 fits AVX-512 for float.
+
+	/* ######################## Lane Mask ######################### */
+
+	// packet_mask<Ty, Width> holds the result of a lane-wise comparison of
+	// packet<Ty, Width>. Lanes are stored with all bits set when true, in
+	// the same layout as the packet so select maps to a register blend.
+	template<typename Ty, uint32_t Width>
+	class packet_mask
+	{
+	private:
+		using native = simd::native_for<Ty, Width>;
+		using reg = typename native::type;
+		using bits = typename simd::native<Ty, 1>::bits;
+
+	public:
+		union
+		{
+			reg regs[Width / native::lanes];
+			Ty lanes[Width];
+		};
+
+	public:
+		// Constructors
+		packet_mask() = default;
+		explicit packet_mask(bool val)
+		{
+			for (uint32_t i = 0; i < Width; i++)
+				lanes[i] = simd::native<Ty, 1>::mask(val);
+		}
+
+		// Element access
+		bool operator[](uint32_t i) const
+		{
+			return std::bit_cast<bits>(lanes[i]) != 0;
+		}
+		void set(uint32_t i, bool val)
+		{
+			lanes[i] = simd::native<Ty, 1>::mask(val);
+		}
+
+		// Logical operators
+		packet_mask<Ty, Width> operator!() const
+		{
+			packet_mask<Ty, Width> result;
+			for (uint32_t i = 0; i < Width / native::lanes; i++)
+				result.regs[i] = native::mask_not(regs[i]);
+			return result;
+		}
+		friend packet_mask<Ty, Width> operator&(const packet_mask<Ty, Width>& a, const packet_mask<Ty, Width>& b)
+		{
+			packet_mask<Ty, Width> result;
+			for (uint32_t i = 0; i < Width / native::lanes; i++)
+				result.regs[i] = native::mask_and(a.regs[i], b.regs[i]);
+			return result;
+		}
+		friend packet_mask<Ty, Width> operator|(const packet_mask<Ty, Width>& a, const packet_mask<Ty, Width>& b)
+		{
+			packet_mask<Ty, Width> result;
+			for (uint32_t i = 0; i < Width / native::lanes; i++)
+				result.regs[i] = native::mask_or(a.regs[i], b.regs[i]);
+			return result;
+		}
+
+		// Reductions
+		bool any() const
+		{
+			uint32_t result = 0;
+			for (uint32_t i = 0; i < Width / native::lanes; i++)
+				result |= native::movemask(regs[i]);
+			return result != 0;
+		}
+		bool all() const
+		{
+			constexpr uint32_t full = (uint32_t(1) << native::lanes) - 1;
+			uint32_t result = full;
+			for (uint32_t i = 0; i < Width / native::lanes; i++)
+				result &= native::movemask(regs[i]);
+			return result == full;
+		}
+		bool none() const
+		{
+			return !any();
+		}
+
+	};
+
+	/* ###################### Scalar Packet ####################### */
+
+	// packet<Ty, Width> stands in for a scalar Ty; dot products and
+	// magnitudes of vec_packets are returned as packets. Operators are
+	// friends so scalars convert implicitly (p * 2.0f, 1.0f - p).
+	template<typename Ty, uint32_t Width>
+	class packet
+	{
+		static_assert(Width > 0 && (Width & (Width - 1)) == 0, "packet width must be a power of two");
+		static_assert(sizeof(Ty) == 4 || sizeof(Ty) == 8, "packet lanes must be 32 or 64 bits wide");
+
+	private:
+		using native = simd::native_for<Ty, Width>;
+		using reg = typename native::type;
+
+		// Applies op to each register sized chunk
+		template<typename Op>
+		static packet<Ty, Width> map(const packet<Ty, Width>& a, Op op)
+		{
+			packet<Ty, Width> result;
+			for (uint32_t i = 0; i < Width / native::lanes; i++)
+				result.regs[i] = op(a.regs[i]);
+			return result;
+		}
+		template<typename Op>
+		static packet<Ty, Width> map(const packet<Ty, Width>& a, const packet<Ty, Width>& b, Op op)
+		{
+			packet<Ty, Width> result;
+			for (uint32_t i = 0; i < Width / native::lanes; i++)
+				result.regs[i] = op(a.regs[i], b.regs[i]);
+			return result;
+		}
+		template<typename Op>
+		static packet_mask<Ty, Width> compare(const packet<Ty, Width>& a, const packet<Ty, Width>& b, Op op)
+		{
+			packet_mask<Ty, Width> result;
+			for (uint32_t i = 0; i < Width / native::lanes; i++)
+				result.regs[i] = op(a.regs[i], b.regs[i]);
+			return result;
+		}
+
+	public:
+		union
+		{
+			reg regs[Width / native::lanes];
+			Ty lanes[Width];
+		};
+
+	public:
+		// Constructors
+		packet() = default;
+		packet(const Ty& val)
+		{
+			for (uint32_t i = 0; i < Width / native::lanes; i++)
+				regs[i] = native::broadcast(val);
+		}
+
+		// Loading/Storing
+		static packet<Ty, Width> load(const Ty* src)
+		{
+			packet<Ty, Width> result;
+			for (uint32_t i = 0; i < Width; i++)
+				result.lanes[i] = src[i];
+			return result;
+		}
+		void store(Ty* dst) const
+		{
+			for (uint32_t i = 0; i < Width; i++)
+				dst[i] = lanes[i];
+		}
+
+		// Element access
+		Ty& operator[](uint32_t i)
+		{
+			return lanes[i];
+		}
+		const Ty& operator[](uint32_t i) const
+		{
+			return lanes[i];
+		}
+
+		// Unary operators
+		packet<Ty, Width> operator+() const
+		{
+			return *this;
+		}
+		packet<Ty, Width> operator-() const
+		{
+			return map(*this, [](reg a) { return native::neg(a); });
+		}
+
+		// Assignment operators
+		packet<Ty, Width>& operator+=(const packet<Ty, Width>& p)
+		{
+			return *this = *this + p;
+		}
+		packet<Ty, Width>& operator-=(const packet<Ty, Width>& p)
+		{
+			return *this = *this - p;
+		}
+		packet<Ty, Width>& operator*=(const packet<Ty, Width>& p)
+		{
+			return *this = *this * p;
+		}
+		packet<Ty, Width>& operator/=(const packet<Ty, Width>& p)
+		{
+			return *this = *this / p;
+		}
+
+		// Arithmetic operators
+		friend packet<Ty, Width> operator+(const packet<Ty, Width>& a, const packet<Ty, Width>& b)
+		{
+			return map(a, b, [](reg x, reg y) { return native::add(x, y); });
+		}
+		friend packet<Ty, Width> operator-(const packet<Ty, Width>& a, const packet<Ty, Width>& b)
+		{
+			return map(a, b, [](reg x, reg y) { return native::sub(x, y); });
+		}
+		friend packet<Ty, Width> operator*(const packet<Ty, Width>& a, const packet<Ty, Width>& b)
+		{
+			return map(a, b, [](reg x, reg y) { return native::mul(x, y); });
+		}
+		friend packet<Ty, Width> operator/(const packet<Ty, Width>& a, const packet<Ty, Width>& b)
+		{
+			return map(a, b, [](reg x, reg y) { return native::div(x, y); });
+		}
+
+		// Lane-wise comparison
+		friend packet_mask<Ty, Width> operator==(const packet<Ty, Width>& a, const packet<Ty, Width>& b)
+		{
+			return compare(a, b, [](reg x, reg y) { return native::cmp_eq(x, y); });
+		}
+		friend packet_mask<Ty, Width> operator!=(const packet<Ty, Width>& a, const packet<Ty, Width>& b)
+		{
+			return !(a == b);
+		}
+		friend packet_mask<Ty, Width> operator<(const packet<Ty, Width>& a, const packet<Ty, Width>& b)
+		{
+			return compare(a, b, [](reg x, reg y) { return native::cmp_lt(x, y); });
+		}
+		friend packet_mask<Ty, Width> operator<=(const packet<Ty, Width>& a, const packet<Ty, Width>& b)
+		{
+			return compare(a, b, [](reg x, reg y) { return native::cmp_le(x, y); });
+		}
+		friend packet_mask<Ty, Width> operator>(const packet<Ty, Width>& a, const packet<Ty, Width>& b)
+		{
+			return b < a;
+		}
+		friend packet_mask<Ty, Width> operator>=(const packet<Ty, Width>& a, const packet<Ty, Width>& b)
+		{
+			return b <= a;
+		}
+
+		// Lane-wise math
+		friend packet<Ty, Width> sqrt(const packet<Ty, Width>& p)
+		{
+			return map(p, [](reg a) { return native::sqrt(a); });
+		}
+		friend packet<Ty, Width> rsqrt(const packet<Ty, Width>& p)
+		{
+			return map(p, [](reg a) { return native::rsqrt(a); });
+		}
+		friend packet<Ty, Width> abs(const packet<Ty, Width>& p)
+		{
+			return map(p, [](reg a) { return native::abs(a); });
+		}
+		friend packet<Ty, Width> min(const packet<Ty, Width>& a, const packet<Ty, Width>& b)
+		{
+			return map(a, b, [](reg x, reg y) { return native::min(x, y); });
+		}
+		friend packet<Ty, Width> max(const packet<Ty, Width>& a, const packet<Ty, Width>& b)
+		{
+			return map(a, b, [](reg x, reg y) { return native::max(x, y); });
+		}
+
+		// Masked select, lanes of a where mask is set and b elsewhere
+		friend packet<Ty, Width> select(const packet_mask<Ty, Width>& mask, const packet<Ty, Width>& a, const packet<Ty, Width>& b)
+		{
+			packet<Ty, Width> result;
+			for (uint32_t i = 0; i < Width / native::lanes; i++)
+				result.regs[i] = native::blend(mask.regs[i], a.regs[i], b.regs[i]);
+			return result;
+		}
+
+	};
+
+	/* ###################### Vector Packet ####################### */
+
+	template<typename Ty, uint32_t N, uint32_t Width>
+	class vec_packet;
+
+	namespace detail
+	{
+		// Component storage, named like the matching vec<Ty, N>
+		template<typename Ty, uint32_t N, uint32_t Width>
+		struct vec_packet_storage
+		{
+			packet<Ty, Width> values[N];
+		};
+
+		template<typename Ty, uint32_t Width>
+		struct vec_packet_storage<Ty, 2, Width>
+		{
+			union
+			{
+				packet<Ty, Width> values[2];
+				struct { packet<Ty, Width> x, y; };
+			};
+		};
+
+		template<typename Ty, uint32_t Width>
+		struct vec_packet_storage<Ty, 3, Width>
+		{
+			union
+			{
+				packet<Ty, Width> values[3];
+				struct { packet<Ty, Width> x, y, z; };
+				struct { packet<Ty, Width> r, g, b; };
+			};
+		};
+
+		template<typename Ty, uint32_t Width>
+		struct vec_packet_storage<Ty, 4, Width>
+		{
+			union
+			{
+				packet<Ty, Width> values[4];
+				struct { packet<Ty, Width> x, y, z, w; };
+				struct { packet<Ty, Width> r, g, b, a; };
+			};
+		};
+	}
+
+	// vec_packet<Ty, N, Width> holds Width vec<Ty, N> in structure-of-arrays
+	// form: values[c].lanes[i] is component c of vector i. It has the same
+	// interface as vec<Ty, N> with scalars replaced by packet<Ty, Width>.
+	template<typename Ty, uint32_t N, uint32_t Width>
+	class vec_packet : public detail::vec_packet_storage<Ty, N, Width>
+	{
+	private:
+		static constexpr bool transposable = [] {
+			if constexpr (simd::has_reg4<Ty>)
+				return (N == 3 || N == 4) && simd::native_for<Ty, Width>::lanes == 4;
+			else
+				return false;
+		}();
+
+	public:
+		using scalar_type = packet<Ty, Width>;
+		using mask_type = packet_mask<Ty, Width>;
+
+	public:
+		// Constructors
+		vec_packet()
+		{
+			for (uint32_t c = 0; c < N; c++)
+				this->values[c] = scalar_type(Ty(0));
+		}
+		template<typename... Args> requires (sizeof...(Args) == N && N > 1)
+		vec_packet(const Args&... components)
+		{
+			const scalar_type list[N] { scalar_type(components)... };
+			for (uint32_t c = 0; c < N; c++)
+				this->values[c] = list[c];
+		}
+		explicit vec_packet(const vec<Ty, N>& v)
+		{
+			for (uint32_t c = 0; c < N; c++)
+				this->values[c] = scalar_type(v[c]);
+		}
+
+		// Copies go one register at a time. Copying the storage union as a
+		// whole lets the compiler move it with one wide load, which cannot
+		// forward from the register sized stores that filled it.
+		vec_packet(const vec_packet<Ty, N, Width>& v)
+		{
+			for (uint32_t c = 0; c < N; c++)
+				this->values[c] = v.values[c];
+		}
+		vec_packet<Ty, N, Width>& operator=(const vec_packet<Ty, N, Width>& v)
+		{
+			for (uint32_t c = 0; c < N; c++)
+				this->values[c] = v.values[c];
+			return *this;
+		}
+
+		// Loading/Storing, converts between Width consecutive vectors and SoA.
+		// Vectors held in a simd register are transposed four at a time
+		// straight into 4 lane packet registers.
+		static vec_packet<Ty, N, Width> load(const vec<Ty, N>* src)
+		{
+			vec_packet<Ty, N, Width> result;
+			if constexpr (transposable)
+			{
+				using reg = simd::native<Ty, 4>;
+				for (uint32_t i = 0; i < Width; i += 4)
+				{
+					typename reg::type r[4] { src[i].simd, src[i + 1].simd, src[i + 2].simd, src[i + 3].simd };
+					reg::transpose(r[0], r[1], r[2], r[3]);
+					for (uint32_t c = 0; c < N; c++)
+						result.values[c].regs[i / 4] = r[c];
+				}
+			}
+			else
+			{
+				for (uint32_t i = 0; i < Width; i++)
+					result.set_lane(i, src[i]);
+			}
+			return result;
+		}
+		void store(vec<Ty, N>* dst) const
+		{
+			if constexpr (transposable)
+			{
+				using reg = simd::native<Ty, 4>;
+				for (uint32_t i = 0; i < Width; i += 4)
+				{
+					// Padding lane of vec<Ty, 3> is kept at zero. Named registers
+					// rather than an array, which the compiler copies to dst as one
+					// block through the stack.
+					typename reg::type r0 = this->values[0].regs[i / 4];
+					typename reg::type r1 = this->values[1].regs[i / 4];
+					typename reg::type r2 = this->values[2].regs[i / 4];
+					typename reg::type r3 = reg::broadcast(Ty(0));
+					if constexpr (N == 4)
+						r3 = this->values[3].regs[i / 4];
+					reg::transpose(r0, r1, r2, r3);
+					dst[i].simd = r0;
+					dst[i + 1].simd = r1;
+					dst[i + 2].simd = r2;
+					dst[i + 3].simd = r3;
+				}
+			}
+			else
+			{
+				for (uint32_t i = 0; i < Width; i++)
+					dst[i] = lane(i);
+			}
+		}
+		vec<Ty, N> lane(uint32_t i) const
+		{
+			vec<Ty, N> result;
+			for (uint32_t c = 0; c < N; c++)
+				result[c] = this->values[c].lanes[i];
+			return result;
+		}
+		void set_lane(uint32_t i, const vec<Ty, N>& v)
+		{
+			for (uint32_t c = 0; c < N; c++)
+				this->values[c].lanes[i] = v[c];
+		}
+
+		// Element access
+		scalar_type& operator[](uint32_t c)
+		{
+			return this->values[c];
+		}
+		const scalar_type& operator[](uint32_t c) const
+		{
+			return this->values[c];
+		}
+
+		// Unary operators
+		vec_packet<Ty, N, Width> operator+() const
+		{
+			return *this;
+		}
+		vec_packet<Ty, N, Width> operator-() const
+		{
+			vec_packet<Ty, N, Width> result = *this;
+			for (uint32_t c = 0; c < N; c++)
+				result.values[c] = -result.values[c];
+			return result;
+		}
+
+		// Assignment operators
+		vec_packet<Ty, N, Width>& operator+=(const vec_packet<Ty, N, Width>& v)
+		{
+			for (uint32_t c = 0; c < N; c++)
+				this->values[c] += v.values[c];
+			return *this;
+		}
+		vec_packet<Ty, N, Width>& operator-=(const vec_packet<Ty, N, Width>& v)
+		{
+			for (uint32_t c = 0; c < N; c++)
+				this->values[c] -= v.values[c];
+			return *this;
+		}
+		vec_packet<Ty, N, Width>& operator*=(const scalar_type& val)
+		{
+			for (uint32_t c = 0; c < N; c++)
+				this->values[c] *= val;
+			return *this;
+		}
+		vec_packet<Ty, N, Width>& operator/=(const scalar_type& val)
+		{
+			// Lane-wise division, a reciprocal multiply would round differently from vec
+			for (uint32_t c = 0; c < N; c++)
+				this->values[c] /= val;
+			return *this;
+		}
+
+		// Other vector operators
+		scalar_type dot(const vec_packet<Ty, N, Width>& v) const
+		{
+			scalar_type result = this->values[0] * v.values[0];
+			for (uint32_t c = 1; c < N; c++)
+				result += this->values[c] * v.values[c];
+			return result;
+		}
+		scalar_type magSq() const
+		{
+			return dot(*this);
+		}
+		scalar_type mag() const
+		{
+			return sqrt(magSq());
+		}
+		vec_packet<Ty, N, Width>& normalize()
+		{
+			// Zero length lanes are left untouched like vec<Ty, 3>::normalize
+			scalar_type len = mag();
+			return *this /= select(len == scalar_type(Ty(0)), scalar_type(Ty(1)), len);
+		}
+		vec_packet<Ty, N, Width>& normalize_fast()
+		{
+			// The estimate gives inf for zero and subnormal lengths, packets
+			// holding one take the exact path
+			scalar_type len_sq = magSq();
+			if ((len_sq < scalar_type(std::numeric_limits<Ty>::min())).any())
+				return normalize();
+			return *this *= rsqrt(len_sq);
+		}
+
+		// Cross product
+		vec_packet<Ty, 3, Width> cross(const vec_packet<Ty, 3, Width>& v) const requires (N == 3)
+		{
+			return vec_packet<Ty, 3, Width>(
+				this->y * v.z - this->z * v.y,
+				this->z * v.x - this->x * v.z,
+				this->x * v.y - this->y * v.x
+			);
+		}
+
+	};
+
+
+	/* ################### For All vector packets ################### */
+
+	// Unit vector
+	template<typename Ty, uint32_t N, uint32_t Width>
+	vec_packet<Ty, N, Width> unit(const vec_packet<Ty, N, Width>& v)
+	{
+		vec_packet<Ty, N, Width> copy = v;
+		return copy.normalize();
+	}
+	template<typename Ty, uint32_t N, uint32_t Width>
+	vec_packet<Ty, N, Width> unit_fast(const vec_packet<Ty, N, Width>& v)
+	{
+		vec_packet<Ty, N, Width> copy = v;
+		return copy.normalize_fast();
+	}
+
+	// Reflect/Refract vector
+	template<typename Ty, uint32_t N, uint32_t Width>
+	vec_packet<Ty, N, Width> reflect(const vec_packet<Ty, N, Width>& v, const vec_packet<Ty, N, Width>& n)
+	{
+		return v - packet<Ty, Width>(Ty(2)) * v.dot(n) * n;
+	}
+	template<typename Ty, uint32_t N, uint32_t Width>
+	vec_packet<Ty, N, Width> refract(const vec_packet<Ty, N, Width>& v, const vec_packet<Ty, N, Width>& n, const packet<Ty, Width>& refraction_ratio)
+	{
+		packet<Ty, Width> cos_theta = min(-v.dot(n), packet<Ty, Width>(Ty(1)));
+		vec_packet<Ty, N, Width> r_out_prep = refraction_ratio * (v + cos_theta * n);
+		vec_packet<Ty, N, Width> r_out_paral = -sqrt(abs(packet<Ty, Width>(Ty(1)) - r_out_prep.magSq())) * n;
+		return r_out_prep + r_out_paral;
+	}
+	template<typename Ty, uint32_t N, uint32_t Width>
+	vec_packet<Ty, N, Width> refract(const vec_packet<Ty, N, Width>& v, const vec_packet<Ty, N, Width>& n, const Ty& refraction_ratio)
+	{
+		return refract(v, n, packet<Ty, Width>(refraction_ratio));
+	}
+
+	// Addition/Subtraction of vectors
+	template<typename Ty, uint32_t N, uint32_t Width>
+	vec_packet<Ty, N, Width> operator+(const vec_packet<Ty, N, Width>& a, const vec_packet<Ty, N, Width>& b)
+	{
+		vec_packet<Ty, N, Width> copy = a;
+		return copy += b;
+	}
+	template<typename Ty, uint32_t N, uint32_t Width>
+	vec_packet<Ty, N, Width> operator-(const vec_packet<Ty, N, Width>& a, const vec_packet<Ty, N, Width>& b)
+	{
+		vec_packet<Ty, N, Width> copy = a;
+		return copy -= b;
+	}
+
+	// Multiplying/Dividing vector with scalar or scalar packet
+	template<typename Ty, uint32_t N, uint32_t Width>
+	vec_packet<Ty, N, Width> operator*(const vec_packet<Ty, N, Width>& v, const packet<Ty, Width>& val)
+	{
+		vec_packet<Ty, N, Width> copy = v;
+		return copy *= val;
+	}
+	template<typename Ty, uint32_t N, uint32_t Width>
+	vec_packet<Ty, N, Width> operator*(const packet<Ty, Width>& val, const vec_packet<Ty, N, Width>& v)
+	{
+		vec_packet<Ty, N, Width> copy = v;
+		return copy *= val;
+	}
+	template<typename Ty, uint32_t N, uint32_t Width>
+	vec_packet<Ty, N, Width> operator*(const vec_packet<Ty, N, Width>& v, const Ty& val)
+	{
+		vec_packet<Ty, N, Width> copy = v;
+		return copy *= packet<Ty, Width>(val);
+	}
+	template<typename Ty, uint32_t N, uint32_t Width>
+	vec_packet<Ty, N, Width> operator*(const Ty& val, const vec_packet<Ty, N, Width>& v)
+	{
+		vec_packet<Ty, N, Width> copy = v;
+		return copy *= packet<Ty, Width>(val);
+	}
+	template<typename Ty, uint32_t N, uint32_t Width>
+	vec_packet<Ty, N, Width> operator/(const vec_packet<Ty, N, Width>& v, const packet<Ty, Width>& val)
+	{
+		vec_packet<Ty, N, Width> copy = v;
+		return copy /= val;
+	}
+	template<typename Ty, uint32_t N, uint32_t Width>
+	vec_packet<Ty, N, Width> operator/(const vec_packet<Ty, N, Width>& v, const Ty& val)
+	{
+		vec_packet<Ty, N, Width> copy = v;
+		return copy /= packet<Ty, Width>(val);
+	}
+
+	// Multiplying vector with vector (dot and cross (3d))
+	template<typename Ty, uint32_t N, uint32_t Width>
+	packet<Ty, Width> operator*(const vec_packet<Ty, N, Width>& a, const vec_packet<Ty, N, Width>& b)
+	{
+		return a.dot(b);
+	}
+	template<typename Ty, uint32_t N, uint32_t Width>
+	packet<Ty, Width> dot(const vec_packet<Ty, N, Width>& a, const vec_packet<Ty, N, Width>& b)
+	{
+		return a.dot(b);
+	}
+	template<typename Ty, uint32_t Width>
+	vec_packet<Ty, 3, Width> cross(const vec_packet<Ty, 3, Width>& a, const vec_packet<Ty, 3, Width>& b)
+	{
+		return a.cross(b);
+	}
+
+	// Multiply elements together
+	template<typename Ty, uint32_t N, uint32_t Width>
+	vec_packet<Ty, N, Width> elem_mult(const vec_packet<Ty, N, Width>& a, const vec_packet<Ty, N, Width>& b)
+	{
+		vec_packet<Ty, N, Width> result = a;
+		for (uint32_t c = 0; c < N; c++)
+			result.values[c] *= b.values[c];
+		return result;
+	}
+
+	// Lane-wise comparison, true where all components match
+	template<typename Ty, uint32_t N, uint32_t Width>
+	packet_mask<Ty, Width> operator==(const vec_packet<Ty, N, Width>& a, const vec_packet<Ty, N, Width>& b)
+	{
+		packet_mask<Ty, Width> result = a.values[0] == b.values[0];
+		for (uint32_t c = 1; c < N; c++)
+			result = result & (a.values[c] == b.values[c]);
+		return result;
+	}
+	template<typename Ty, uint32_t N, uint32_t Width>
+	packet_mask<Ty, Width> operator!=(const vec_packet<Ty, N, Width>& a, const vec_packet<Ty, N, Width>& b)
+	{
+		return !(a == b);
+	}
+
+	// Masked select, lanes of a where mask is set and b elsewhere
+	template<typename Ty, uint32_t N, uint32_t Width>
+	vec_packet<Ty, N, Width> select(const packet_mask<Ty, Width>& mask, const vec_packet<Ty, N, Width>& a, const vec_packet<Ty, N, Width>& b)
+	{
+		vec_packet<Ty, N, Width> result;
+		for (uint32_t c = 0; c < N; c++)
+			result.values[c] = select(mask, a.values[c], b.values[c]);
+		return result;
+	}
+
+
+
+
+	// Definitions for most common packets
+	template<uint32_t Width> using vec2f_packet = vec_packet<float,		2, Width>;
+	template<uint32_t Width> using vec2d_packet = vec_packet<double,	2, Width>;
+
+	template<uint32_t Width> using vec3f_packet = vec_packet<float,		3, Width>;
+	template<uint32_t Width> using vec3d_packet = vec_packet<double,	3, Width>;
+
+	template<uint32_t Width> using vec4f_packet = vec_packet<float,		4, Width>;
+	template<uint32_t Width> using vec4d_packet = vec_packet<double,	4, Width>;
+
+}
@@ -0,0 +1,366 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "batch.h"
+#include "check.h"
+#include "random.h"
+
+namespace
+{
+	using namespace Banan;
+
+	// Sizes around every block width and a few large enough to split
+	constexpr std::size_t s_sizes[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 63, 100, 1001 };
+
+	template<typename Ty, uint32_t N>
+	std::vector<vec<Ty, N>> random_vecs(std::size_t count, uint64_t seed)
+	{
+		pcg32_fast engine(seed);
+		std::vector<vec<Ty, N>> result(count);
+		for (vec<Ty, N>& v : result)
+			for (uint32_t i = 0; i < N; i++)
+				v[i] = get_random_uniform<Ty>(engine, Ty(-4), Ty(4));
+		return result;
+	}
+
+	// Largest component difference of two arrays of vectors, relative to
+	// the magnitude of the expected component
+	template<typename Ty, uint32_t N>
+	double max_error(std::span<const vec<Ty, N>> got, std::span<const vec<Ty, N>> expected)
+	{
+		double worst = 0;
+		for (std::size_t i = 0; i < got.size(); i++)
+			for (uint32_t k = 0; k < N; k++)
+			{
+				const double e = double(expected[i][k]);
+				worst = std::max(worst, std::abs(double(got[i][k]) - e) / (1 + std::abs(e)));
+			}
+		return worst;
+	}
+
+	template<typename T>
+	bool bitwise_equal(const std::vector<T>& a, const std::vector<T>& b)
+	{
+		return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+	}
+
+	template<typename Ty>
+	constexpr double tolerance = sizeof(Ty) == 4 ? 1e-5 : 1e-13;
+
+	// Every vector kernel against the vec operators, into a separate output
+	// and in place over the first input
+	template<typename Ty, uint32_t N>
+	void check_kernels()
+	{
+		for (std::size_t count : s_sizes)
+		{
+			using V = vec<Ty, N>;
+			const std::vector<V> a = random_vecs<Ty, N>(count, count), b = random_vecs<Ty, N>(count, count + 1000);
+			std::vector<V> n(count), u(count), out(count), expected(count);
+			for (std::size_t i = 0; i < count; i++)
+			{
+				n[i] = unit(b[i]);
+				u[i] = unit(a[i]);
+			}
+
+			auto check = [&](auto kernel, auto reference)
+			{
+				for (std::size_t i = 0; i < count; i++)
+					expected[i] = reference(i);
+				kernel(std::span<V>(out));
+				BANAN_CHECK(max_error<Ty, N>(out, expected) < tolerance<Ty>);
+			};
+			check([&](std::span<V> o) { batch::add(a, b, o); }, [&](std::size_t i) { return a[i] + b[i]; });
+			check([&](std::span<V> o) { batch::scale(a, Ty(1.5), o); }, [&](std::size_t i) { return a[i] * Ty(1.5); });
+			check([&](std::span<V> o) { batch::lerp(a, b, Ty(0.25), o); }, [&](std::size_t i) { return a[i] + (b[i] - a[i]) * Ty(0.25); });
+			check([&](std::span<V> o) { batch::elem_mult(a, b, o); }, [&](std::size_t i) { return elem_mult(a[i], b[i]); });
+			check([&](std::span<V> o) { batch::normalize(a, o); }, [&](std::size_t i) { return unit(a[i]); });
+			check([&](std::span<V> o) { batch::reflect(a, n, o); }, [&](std::size_t i) { return reflect(a[i], n[i]); });
+			check([&](std::span<V> o) { batch::refract(u, n, Ty(0.8), o); }, [&](std::size_t i) { return refract(u[i], n[i], Ty(0.8)); });
+			if constexpr (N == 3)
+				check([&](std::span<V> o) { batch::cross(a, b, o); }, [&](std::size_t i) { return a[i].cross(b[i]); });
+
+			std::vector<Ty> dots(count), lengths(count);
+			batch::dot<N>(a, b, std::span<Ty>(dots));
+			batch::magSq<N>(a, std::span<Ty>(lengths));
+			bool close = true;
+			for (std::size_t i = 0; i < count; i++)
+				close &= test::near(dots[i], a[i].dot(b[i]), 100 * tolerance<Ty>) && test::near(lengths[i], a[i].magSq(), 100 * tolerance<Ty>);
+			BANAN_CHECK(close);
+
+			// In place
+			std::vector<V> c = a;
+			batch::add(c, b, std::span<V>(c));
+			for (std::size_t i = 0; i < count; i++)
+				expected[i] = a[i] + b[i];
+			BANAN_CHECK(max_error<Ty, N>(c, expected) < tolerance<Ty>);
+			c = a;
+			batch::normalize(c, std::span<V>(c));
+			for (std::size_t i = 0; i < count; i++)
+				expected[i] = unit(a[i]);
+			BANAN_CHECK(max_error<Ty, N>(c, expected) < tolerance<Ty>);
+		}
+	}
+}
+
+BANAN_TEST(batch_kernels_match_vec)
+{
+	check_kernels<float, 2>();
+	check_kernels<float, 3>();
+	check_kernels<float, 4>();
+	check_kernels<float, 5>();
+	check_kernels<double, 3>();
+	check_kernels<double, 4>();
+}
+
+// The lane-wise kernels run vec3 arrays as flat scalars, the padding lane
+// of the register backed vec3 must come out zero
+BANAN_TEST(batch_flat_kernels_keep_padding_zero)
+{
+	const float inf = std::numeric_limits<float>::infinity();
+	for (std::size_t count : s_sizes)
+	{
+		std::vector<vec3f> a(count, vec3f(1.0f, 1.0f, 1.0f)), out(count);
+		batch::scale(a, inf, std::span<vec3f>(out));
+		bool infinite = true;
+		for (const vec3f& v : out)
+			infinite &= v.magSq() == inf && v.dot(vec3f(1.0f, 1.0f, 1.0f)) == inf;
+		BANAN_CHECK(infinite);
+
+		batch::add(out, a, std::span<vec3f>(out));
+		infinite = true;
+		for (const vec3f& v : out)
+			infinite &= v.magSq() == inf;
+		BANAN_CHECK(infinite);
+	}
+}
+
+// Results do not depend on how the array is split across threads. The
+// serial call may differ from the split one in the last bit where the
+// compiler contracts a * b - c into an fma in one inlined copy and not
+// the other (GCC and Clang do by default), so pools of any size must
+// agree bitwise and the serial result closely.
+namespace
+{
+	template<typename Ty>
+	void check_parallel()
+	{
+		using V3 = vec<Ty, 3>;
+		using V4 = vec<Ty, 4>;
+		constexpr std::size_t count = 100003;
+		const std::vector<V3> a = random_vecs<Ty, 3>(count, 1), b = random_vecs<Ty, 3>(count, 2);
+		const std::vector<V4> c = random_vecs<Ty, 4>(count, 3);
+		const mat<Ty, 4, 4> m = mat<Ty, 4, 4>(
+			Ty(1), Ty(2), Ty(0), Ty(3),
+			Ty(0), Ty(1), Ty(-1), Ty(1),
+			Ty(2), Ty(0), Ty(1), Ty(-2),
+			Ty(0.1), Ty(0.2), Ty(0.3), Ty(4));
+		const quat<Ty> q = quat<Ty>::from_axis_angle(unit(V3(Ty(1), Ty(2), Ty(3))), Ty(0.7));
+
+		// Every kernel into one output per call, serially or on pool
+		struct results
+		{
+			std::vector<V3> add, cross, normalize, points, projected, rotated;
+			std::vector<V4> transformed;
+			std::vector<Ty> dots;
+		};
+		auto run = [&](auto&... pool)
+		{
+			results r { std::vector<V3>(count), std::vector<V3>(count), std::vector<V3>(count), std::vector<V3>(count),
+				std::vector<V3>(count), std::vector<V3>(count), std::vector<V4>(count), std::vector<Ty>(count) };
+			batch::add(pool..., a, b, std::span<V3>(r.add));
+			batch::cross(pool..., a, b, std::span<V3>(r.cross));
+			batch::normalize(pool..., a, std::span<V3>(r.normalize));
+			batch::transform_points(pool..., m, a, std::span<V3>(r.points));
+			batch::project_points(pool..., m, a, std::span<V3>(r.projected));
+			batch::rotate(pool..., q, a, std::span<V3>(r.rotated));
+			batch::transform(pool..., m, c, std::span<V4>(r.transformed));
+			batch::dot<3>(pool..., a, b, std::span<Ty>(r.dots));
+			return r;
+		};
+
+		const results serial = run();
+		thread_pool single(1);
+		const results reference = run(single);
+		BANAN_CHECK(max_error<Ty, 3>(serial.cross, reference.cross) < tolerance<Ty>);
+		BANAN_CHECK(max_error<Ty, 3>(serial.points, reference.points) < tolerance<Ty>);
+		BANAN_CHECK(max_error<Ty, 4>(serial.transformed, reference.transformed) < tolerance<Ty>);
+		BANAN_CHECK(bitwise_equal(serial.add, reference.add));
+
+		for (uint32_t threads : { 2u, 3u, 4u })
+		{
+			thread_pool pool(threads);
+			const results r = run(pool);
+			BANAN_CHECK(bitwise_equal(r.add, reference.add));
+			BANAN_CHECK(bitwise_equal(r.cross, reference.cross));
+			BANAN_CHECK(bitwise_equal(r.normalize, reference.normalize));
+			BANAN_CHECK(bitwise_equal(r.points, reference.points));
+			BANAN_CHECK(bitwise_equal(r.projected, reference.projected));
+			BANAN_CHECK(bitwise_equal(r.rotated, reference.rotated));
+			BANAN_CHECK(bitwise_equal(r.transformed, reference.transformed));
+			BANAN_CHECK(bitwise_equal(r.dots, reference.dots));
+		}
+	}
+}
+
+BANAN_TEST(batch_parallel_matches_serial)
+{
+	check_parallel<float>();
+	check_parallel<double>();
+}
+
+// The transform kernels against mat * vec, below and above the size where
+// stores turn non-temporal
+namespace
+{
+	template<typename Ty, layout L>
+	void check_transforms()
+	{
+		using V3 = vec<Ty, 3>;
+		using V4 = vec<Ty, 4>;
+		const mat<Ty, 4, 4, L> m(
+			Ty(0.5), Ty(-1), Ty(0), Ty(3),
+			Ty(1), Ty(2), Ty(-1), Ty(1),
+			Ty(0), Ty(1), Ty(3), Ty(-2),
+			Ty(0.1), Ty(0.2), Ty(0.3), Ty(4));
+		const mat<Ty, 3, 3, L> linear(
+			m(0, 0), m(0, 1), m(0, 2),
+			m(1, 0), m(1, 1), m(1, 2),
+			m(2, 0), m(2, 1), m(2, 2));
+		const mat<Ty, 3, 3, L> normal = linear.inverse().transpose();
+
+		for (std::size_t count : { std::size_t(1001), std::size_t(9) * 1024 * 1024 / sizeof(V3) })
+		{
+			const std::vector<V3> p = random_vecs<Ty, 3>(count, count);
+			const std::vector<V4> h = random_vecs<Ty, 4>(count, count + 1);
+			std::vector<V3> out(count), expected(count);
+			std::vector<V4> out4(count), expected4(count);
+
+			batch::transform_points(m, p, std::span<V3>(out));
+			for (std::size_t i = 0; i < count; i++)
+			{
+				const V4 r = m * V4(p[i].x, p[i].y, p[i].z, Ty(1));
+				expected[i] = V3(r.x, r.y, r.z);
+			}
+			BANAN_CHECK(max_error<Ty, 3>(out, expected) < tolerance<Ty> * 10);
+
+			batch::project_points(m, p, std::span<V3>(out));
+			for (std::size_t i = 0; i < count; i++)
+			{
+				const V4 r = m * V4(p[i].x, p[i].y, p[i].z, Ty(1));
+				expected[i] = V3(r.x, r.y, r.z) / r.w;
+			}
+			// Near w = 0 the division amplifies rounding, compare where it is tame
+			double worst = 0;
+			for (std::size_t i = 0; i < count; i++)
+			{
+				const Ty w = m(3, 0) * p[i].x + m(3, 1) * p[i].y + m(3, 2) * p[i].z + m(3, 3);
+				if (std::abs(w) > Ty(0.5))
+					worst = std::max(worst, max_error<Ty, 3>(std::span(&out[i], 1), std::span(&expected[i], 1)));
+			}
+			BANAN_CHECK(worst < tolerance<Ty> * 100);
+
+			batch::transform_directions(m, p, std::span<V3>(out));
+			for (std::size_t i = 0; i < count; i++)
+				expected[i] = linear * p[i];
+			BANAN_CHECK(max_error<Ty, 3>(out, expected) < tolerance<Ty> * 10);
+
+			batch::transform_normals(m, p, std::span<V3>(out));
+			for (std::size_t i = 0; i < count; i++)
+				expected[i] = normal * p[i];
+			BANAN_CHECK(max_error<Ty, 3>(out, expected) < tolerance<Ty> * 100);
+
+			batch::transform(m, h, std::span<V4>(out4));
+			for (std::size_t i = 0; i < count; i++)
+				expected4[i] = m * h[i];
+			BANAN_CHECK(max_error<Ty, 4>(out4, expected4) < tolerance<Ty> * 10);
+		}
+	}
+}
+
+BANAN_TEST(batch_transforms_match_mat)
+{
+	check_transforms<float, layout::column_major>();
+	check_transforms<float, layout::row_major>();
+	check_transforms<double, layout::column_major>();
+}
+
+// Quaternion rotation, nlerp and slerp against their matrix and scalar forms
+namespace
+{
+	template<typename Ty>
+	void check_quat()
+	{
+		using V3 = vec<Ty, 3>;
+		pcg32_fast engine(5);
+		std::vector<quat<Ty>> a(1001), b(1001), out(1001);
+		for (std::size_t i = 0; i < a.size(); i++)
+		{
+			a[i] = quat<Ty>::from_axis_angle(unit(random_vecs<Ty, 3>(1, 2 * i)[0]), get_random_uniform<Ty>(engine, Ty(-3), Ty(3)));
+			b[i] = quat<Ty>::from_axis_angle(unit(random_vecs<Ty, 3>(1, 2 * i + 1)[0]), get_random_uniform<Ty>(engine, Ty(-3), Ty(3)));
+		}
+
+		// rotate, q * v and the rotation matrix agree and keep lengths
+		const std::vector<V3> v = random_vecs<Ty, 3>(1001, 7);
+		bool rotations = true;
+		for (std::size_t i = 0; i < a.size(); i++)
+		{
+			const V3 r = a[i].rotate(v[i]);
+			rotations &= test::near((r - a[i] * v[i]).mag(), 0, tolerance<Ty> * 10);
+			rotations &= test::near((r - a[i].to_mat3() * v[i]).mag(), 0, tolerance<Ty> * 10);
+			rotations &= test::near(r.mag(), v[i].mag(), tolerance<Ty> * 10);
+			rotations &= test::near((a[i].inverse().rotate(r) - v[i]).mag(), 0, tolerance<Ty> * 10);
+		}
+		BANAN_CHECK(rotations);
+
+		std::vector<V3> rotated(v.size()), expected(v.size());
+		batch::rotate(a[0], v, std::span<V3>(rotated));
+		for (std::size_t i = 0; i < v.size(); i++)
+			expected[i] = a[0].rotate(v[i]);
+		BANAN_CHECK(max_error<Ty, 3>(rotated, expected) < tolerance<Ty> * 10);
+
+		// slerp at the ends, halfway between rotations of one axis
+		const V3 axis = unit(V3(Ty(1), Ty(-2), Ty(2)));
+		const quat<Ty> half = slerp(quat<Ty>::from_axis_angle(axis, Ty(0.2)), quat<Ty>::from_axis_angle(axis, Ty(1.4)), Ty(0.5));
+		const quat<Ty> middle = quat<Ty>::from_axis_angle(axis, Ty(0.8));
+		BANAN_CHECK(test::near(std::abs(half.dot(middle)), 1, tolerance<Ty> * 10));
+		BANAN_CHECK(test::near(std::abs(slerp(a[3], b[3], Ty(1)).dot(b[3])), 1, tolerance<Ty> * 10));
+
+		// Opposite and nearly equal pairs take the nlerp branch of slerp
+		b[4] = -a[4];
+		b[6] = a[6] * quat<Ty>::from_axis_angle(axis, Ty(0.01));
+		for (Ty t : { Ty(0), Ty(0.3), Ty(0.7), Ty(1) })
+		{
+			batch::nlerp(a, b, t, std::span<quat<Ty>>(out));
+			bool close = true;
+			for (std::size_t i = 0; i < a.size(); i++)
+				close &= test::near((out[i].xyzw - nlerp(a[i], b[i], t).xyzw).mag(), 0, tolerance<Ty> * 10);
+			BANAN_CHECK(close);
+
+			// The packet acos and sin are within a few ulp of std::acos and std::sin
+			batch::slerp(a, b, t, std::span<quat<Ty>>(out));
+			close = true;
+			for (std::size_t i = 0; i < a.size(); i++)
+				close &= test::near((out[i].xyzw - slerp(a[i], b[i], t).xyzw).mag(), 0, tolerance<Ty> * 10);
+			BANAN_CHECK(close);
+		}
+
+		// Extrapolation goes through the quaternion slerp
+		batch::slerp(a, b, Ty(1.5), std::span<quat<Ty>>(out));
+		bool same = true;
+		for (std::size_t i = 0; i < a.size(); i++)
+			same &= (out[i].xyzw - slerp(a[i], b[i], Ty(1.5)).xyzw).magSq() == Ty(0);
+		BANAN_CHECK(same);
+	}
+}
+
+BANAN_TEST(quat_rotations_and_interpolation)
+{
+	check_quat<float>();
+	check_quat<double>();
+}
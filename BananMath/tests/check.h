@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <span>
+#include <vector>
+
+// Minimal test harness.
+//
+// Every tests/*.cpp registers its cases with BANAN_TEST and main.cpp runs
+// the ones whose name contains one of the command line arguments, or all
+// of them, and exits with the number of failed cases. Statistical checks
+// use fixed seeds, so they pass or fail the same way on every run; their
+// bounds are wide enough (about 1e-5 false alarms each) to survive a
+// change of seed.
+
+namespace Banan::test
+{
+
+	struct test_case
+	{
+		const char* name;
+		void (*run)();
+	};
+
+	inline std::vector<test_case>& registry()
+	{
+		static std::vector<test_case> s_cases;
+		return s_cases;
+	}
+
+	struct registrar
+	{
+		registrar(const char* name, void (*run)())
+		{
+			registry().push_back({ name, run });
+		}
+	};
+
+	// Failed checks of the running case
+	inline int s_failures = 0;
+
+	inline void fail(const char* file, int line, const char* what)
+	{
+		std::printf("    %s:%d: %s\n", file, line, what);
+		s_failures++;
+	}
+
+	inline bool near(double a, double b, double tolerance)
+	{
+		return std::abs(a - b) <= tolerance;
+	}
+
+	// Running mean and variance (Welford)
+	struct moments
+	{
+		std::size_t count = 0;
+		double mean = 0;
+		double m2 = 0;
+
+		void add(double x)
+		{
+			count++;
+			const double delta = x - mean;
+			mean += delta / double(count);
+			m2 += delta * (x - mean);
+		}
+		double variance() const
+		{
+			return count > 1 ? m2 / double(count - 1) : 0;
+		}
+		// True if the mean is within 5 standard errors of expected, for
+		// values of the given true variance
+		bool mean_near(double expected, double true_variance) const
+		{
+			return near(mean, expected, 5 * std::sqrt(true_variance / double(count)));
+		}
+	};
+
+	// Pearson's statistic of observed counts against expected counts
+	inline double chi_square(std::span<const double> observed, std::span<const double> expected)
+	{
+		double sum = 0;
+		for (std::size_t i = 0; i < observed.size(); i++)
+			sum += (observed[i] - expected[i]) * (observed[i] - expected[i]) / expected[i];
+		return sum;
+	}
+
+	// Upper 1e-5 quantile of the chi-square distribution with dof degrees of
+	// freedom (Wilson-Hilferty)
+	inline double chi_square_limit(std::size_t dof)
+	{
+		const double k = double(dof), z = 4.265;
+		const double c = 1 - 2 / (9 * k) + z * std::sqrt(2 / (9 * k));
+		return k * c * c * c;
+	}
+
+	// Counts of the values in each bin tested against the expected fraction
+	// of each bin, true if the fit is plausible. Bins expected to hold
+	// fewer than 20 values are pooled, the statistic is meaningless for
+	// them alone; a pool still under 20 joins the smallest other bin.
+	inline bool fits(std::span<const double> counts, std::span<const double> fractions)
+	{
+		double total = 0;
+		for (double c : counts)
+			total += c;
+
+		std::vector<double> observed, expected;
+		double pooled_count = 0, pooled_expected = 0;
+		for (std::size_t i = 0; i < fractions.size(); i++)
+		{
+			if (fractions[i] * total >= 20)
+			{
+				observed.push_back(counts[i]);
+				expected.push_back(fractions[i] * total);
+			}
+			else
+			{
+				pooled_count += counts[i];
+				pooled_expected += fractions[i] * total;
+			}
+		}
+		if (pooled_expected >= 20 || (observed.empty() && pooled_expected > 0))
+		{
+			observed.push_back(pooled_count);
+			expected.push_back(pooled_expected);
+		}
+		else if (pooled_expected > 0 || pooled_count > 0)
+		{
+			const std::size_t smallest = std::min_element(expected.begin(), expected.end()) - expected.begin();
+			observed[smallest] += pooled_count;
+			expected[smallest] += pooled_expected;
+		}
+		// A single bin has no degrees of freedom
+		return observed.size() < 2 ||
+			chi_square(observed, expected) < chi_square_limit(observed.size() - 1);
+	}
+
+}
+
+// Variadic so template argument lists need no extra parentheses
+#define BANAN_CHECK(...) \
+	((__VA_ARGS__) ? void(0) : ::Banan::test::fail(__FILE__, __LINE__, #__VA_ARGS__))
+
+#define BANAN_CHECK_NEAR(a, b, tolerance) \
+	(::Banan::test::near(double(a), double(b), double(tolerance)) ? void(0) : \
+		(std::printf("    %s = %.9g, %s = %.9g\n", #a, double(a), #b, double(b)), \
+		::Banan::test::fail(__FILE__, __LINE__, "|" #a " - " #b "| <= " #tolerance)))
+
+#define BANAN_TEST(name) \
+	static void name(); \
+	static const ::Banan::test::registrar s_test_##name(#name, name); \
+	static void name()
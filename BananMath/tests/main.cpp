@@ -0,0 +1,28 @@
+#include <cstdio>
+#include <string_view>
+
+#include "check.h"
+
+// Runs every registered test case, or those whose name contains one of the
+// arguments: BananMathTests alias ziggurat
+
+int main(int argc, char** argv)
+{
+	int failed = 0, run = 0;
+	for (const Banan::test::test_case& c : Banan::test::registry())
+	{
+		bool selected = argc < 2;
+		for (int i = 1; i < argc; i++)
+			selected |= std::string_view(c.name).find(argv[i]) != std::string_view::npos;
+		if (!selected)
+			continue;
+
+		Banan::test::s_failures = 0;
+		c.run();
+		std::printf("%-6s %s\n", Banan::test::s_failures == 0 ? "ok" : "FAILED", c.name);
+		failed += Banan::test::s_failures != 0;
+		run++;
+	}
+	std::printf("\n%d of %d test cases failed\n", failed, run);
+	return failed;
+}
@@ -0,0 +1,650 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numbers>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "pcg/pcg_uint128.hpp"
+
+#include "alias_table.h"
+#include "check.h"
+#include "random.h"
+#include "random_lanes.h"
+#include "vec.h"
+
+namespace
+{
+	using namespace Banan;
+
+	double normal_cdf(double x)
+	{
+		return 0.5 * std::erfc(-x / std::numbers::sqrt2);
+	}
+
+	// Fractions of the bins between consecutive edges, with open ends
+	template<typename Cdf>
+	std::vector<double> bin_fractions(std::span<const double> edges, const Cdf& cdf)
+	{
+		std::vector<double> fractions;
+		double below = 0;
+		for (double edge : edges)
+		{
+			fractions.push_back(cdf(edge) - below);
+			below = cdf(edge);
+		}
+		fractions.push_back(1 - below);
+		return fractions;
+	}
+
+	template<typename T>
+	std::vector<double> bin_counts(std::span<const T> values, std::span<const double> edges)
+	{
+		std::vector<double> counts(edges.size() + 1);
+		for (T value : values)
+			counts[std::upper_bound(edges.begin(), edges.end(), double(value)) - edges.begin()]++;
+		return counts;
+	}
+
+	template<typename T>
+	test::moments moments_of(std::span<const T> values)
+	{
+		test::moments m;
+		for (T value : values)
+			m.add(double(value));
+		return m;
+	}
+
+	template<typename T>
+	bool all_finite(std::span<const T> values)
+	{
+		return std::all_of(values.begin(), values.end(), [](T value) { return std::isfinite(value); });
+	}
+
+	// Edges every half standard deviation out to 4
+	const std::vector<double> s_normal_edges = []()
+	{
+		std::vector<double> edges;
+		for (int i = -8; i <= 8; i++)
+			edges.push_back(0.5 * i);
+		return edges;
+	}();
+	const std::vector<double> s_exponential_edges = { 0.05, 0.1, 0.25, 0.5, 0.75, 1, 1.5, 2, 3, 4, 5, 6, 7.5, 9 };
+}
+
+/* ########################## Engines ########################## */
+
+// The thread engines restart on seed_generator, every thread draws its own
+// sequence and threads given the same index by seed_thread draw alike
+BANAN_TEST(seed_generator_reproduces_sequences)
+{
+	seed_generator(1234);
+	const uint32_t first = thread_generator()();
+	const double first64 = get_random_uniform<double>();
+	seed_generator(1234);
+	BANAN_CHECK(thread_generator()() == first);
+	BANAN_CHECK(get_random_uniform<double>() == first64);
+
+	seed_generator(99);
+	BANAN_CHECK(thread_generator()() == default_engine(detail::thread_seed(99, detail::thread_index()))());
+
+	uint32_t others[2] = {};
+	std::thread a([&]() { others[0] = thread_generator()(); });
+	a.join();
+	std::thread b([&]() { others[1] = thread_generator()(); });
+	b.join();
+	BANAN_CHECK(others[0] != others[1]);
+
+	// Numbered threads draw the same whatever order they start in
+	uint32_t numbered[3] = {};
+	double numbered64[3] = {};
+	auto draw = [&](uint32_t i)
+	{
+		seed_thread(i % 2);
+		numbered[i] = thread_generator()();
+		numbered64[i] = get_random_uniform<double>();
+	};
+	for (uint32_t i : { 2u, 1u, 0u })
+		std::thread(draw, i).join();
+	BANAN_CHECK(numbered[0] == numbered[2] && numbered64[0] == numbered64[2]);
+	BANAN_CHECK(numbered[0] != numbered[1]);
+	BANAN_CHECK(numbered[1] == default_engine(detail::thread_seed(99, 1))());
+}
+
+BANAN_TEST(random_streams_are_reproducible_and_distinct)
+{
+	const random_streams streams(42);
+	stream_engine a = streams.stream(7), b = streams.stream(7), c = streams.stream(8);
+	bool same = true, distinct = false;
+	for (int i = 0; i < 1000; i++)
+	{
+		const uint32_t x = a();
+		same &= x == b();
+		distinct |= x != c();
+	}
+	BANAN_CHECK(same);
+	BANAN_CHECK(distinct);
+
+	// Neighbouring seeds and streams do not correlate: half the bits differ
+	stream_engine d = random_streams(43).stream(7), e = random_streams(42).stream(7);
+	int differing = 0;
+	for (int i = 0; i < 1000; i++)
+		differing += std::popcount(d() ^ e());
+	BANAN_CHECK_NEAR(differing / 1000.0, 16, 0.5);
+
+	// Blocks are windows of the master stream
+	stream_engine master(detail::mix_seed(42));
+	stream_engine block0 = streams.block(0, 100), block3 = streams.block(3, 100);
+	bool windows = true;
+	for (int i = 0; i < 400; i++)
+	{
+		const uint32_t x = master();
+		if (i < 100)
+			windows &= x == block0();
+		if (i >= 300)
+			windows &= x == block3();
+	}
+	BANAN_CHECK(windows);
+}
+
+// Lane i of pcg32_lanes is stream first_stream + i, interleaved
+namespace
+{
+	template<uint32_t Lanes>
+	void check_lanes()
+	{
+		const random_streams streams(77);
+		pcg32_lanes<Lanes> lanes(77, 5), filled(77, 5);
+		std::vector<stream_engine> engines;
+		for (uint32_t i = 0; i < Lanes; i++)
+			engines.push_back(streams.stream(5 + i));
+
+		// A partial block first, then whole blocks through fill
+		std::vector<uint32_t> block(Lanes * 37 + 3);
+		filled.fill(block);
+		bool equal = true;
+		for (std::size_t k = 0; k < block.size(); k++)
+		{
+			const uint32_t expected = engines[k % Lanes]();
+			equal &= lanes() == expected && block[k] == expected;
+		}
+		BANAN_CHECK(equal);
+	}
+}
+
+BANAN_TEST(pcg32_lanes_match_streams)
+{
+	check_lanes<1>();
+	check_lanes<4>();
+	check_lanes<8>();
+	check_lanes<16>();
+	check_lanes<pcg32_simd::lanes>();
+}
+
+BANAN_TEST(uint_x4_matches_uint128)
+{
+#if defined(__SIZEOF_INT128__)
+	using emulated = pcg_extras::uint_x4<uint32_t, uint64_t>;
+	auto same = [](const emulated& a, __uint128_t b)
+	{
+		return a.d.v01 == uint64_t(b) && a.d.v23 == uint64_t(b >> 64);
+	};
+
+	pcg64_fast engine(3);
+	const uint64_t edges[] = { 0, 1, 2, 0xFFFFFFFF, 0x100000000, 0x7FFFFFFFFFFFFFFF, 0x8000000000000000, 0xFFFFFFFFFFFFFFFF };
+	bool equal = true;
+	for (int i = 0; i < 100000; i++)
+	{
+		const uint64_t a_hi = i < 64 ? edges[i % 8] : engine(), a_lo = i < 64 ? edges[i / 8] : engine();
+		const uint64_t b_hi = engine(), b_lo = i < 64 ? edges[(i + 3) % 8] : engine();
+		const emulated a(a_hi, a_lo), b(b_hi, b_lo);
+		const __uint128_t na = (__uint128_t(a_hi) << 64) | a_lo, nb = (__uint128_t(b_hi) << 64) | b_lo;
+		equal &= same(a * b, na * nb);
+		equal &= same(a * emulated(b_lo), na * b_lo);
+		equal &= same(a + b, na + nb);
+		equal &= same(a - b, na - nb);
+		equal &= same(-a, -na);
+		equal &= same(a >> (i % 128), na >> (i % 128));
+		equal &= same(a << (i % 128), na << (i % 128));
+
+		uint64_t high;
+		const uint64_t low = pcg_extras::mul64x64(a_lo, b_lo, &high);
+		equal &= same(emulated(high, low), __uint128_t(a_lo) * b_lo);
+	}
+	BANAN_CHECK(equal);
+#endif
+}
+
+/* ######################### Uniform ########################### */
+
+// Floating point fills stay in [min, max) with the right moments, and
+// engines without blocks give the values of get_random_uniform
+namespace
+{
+	template<typename T, typename Engine>
+	void check_fill_uniform(uint64_t seed, bool same_as_scalar)
+	{
+		Engine engine(seed), scalar(seed);
+		std::vector<T> values(100003);
+		fill_uniform<T>(engine, values, T(-2), T(3));
+		BANAN_CHECK(std::all_of(values.begin(), values.end(), [](T v) { return v >= T(-2) && v < T(3); }));
+		const test::moments m = moments_of<T>(values);
+		BANAN_CHECK(m.mean_near(0.5, 25.0 / 12));
+		BANAN_CHECK_NEAR(m.variance(), 25.0 / 12, 0.05);
+
+		if (same_as_scalar)
+		{
+			bool equal = true;
+			for (T v : values)
+				equal &= v == get_random_uniform<T>(scalar, T(-2), T(3));
+			BANAN_CHECK(equal);
+		}
+	}
+}
+
+BANAN_TEST(fill_uniform_ranges_and_moments)
+{
+	check_fill_uniform<float, pcg32_fast>(1, true);
+	check_fill_uniform<double, pcg32_fast>(2, true);
+	check_fill_uniform<float, pcg64_fast>(3, false);
+	check_fill_uniform<double, pcg64_fast>(4, true);
+	check_fill_uniform<float, pcg32_simd>(5, false);
+	check_fill_uniform<double, pcg32_simd>(6, false);
+	check_fill_uniform<float, std::mt19937>(7, false);
+}
+
+// Doubles carry 53 random bits whether the engine gives 32 or 64 per step
+namespace
+{
+	template<typename Engine>
+	void check_double_resolution()
+	{
+		Engine engine(11);
+		int fine = 0;
+		bool on_grid = true;
+		for (int i = 0; i < 10000; i++)
+		{
+			const double value = get_random_uniform<double>(engine);
+			const double scaled = std::ldexp(value, 53);
+			on_grid &= scaled == std::floor(scaled);
+			fine += std::ldexp(value, 32) != std::floor(std::ldexp(value, 32));
+		}
+		BANAN_CHECK(on_grid);
+		BANAN_CHECK(fine > 9990);
+	}
+}
+
+BANAN_TEST(double_uniform_has_53_bits)
+{
+	check_double_resolution<pcg32_fast>();
+	check_double_resolution<pcg64_fast>();
+	check_double_resolution<pcg32_simd>();
+}
+
+// fill_uniform on integers rejects the same draws as detail::bounded, so
+// it gives the values of repeated get_random_uniform calls
+namespace
+{
+	template<typename T, typename Engine>
+	void check_bounded(T min, T max)
+	{
+		Engine engine(min ^ max), scalar(min ^ max);
+		std::vector<T> values(20000);
+		fill_uniform<T>(engine, values, min, max);
+		bool equal = true, inside = true;
+		for (T v : values)
+		{
+			equal &= v == get_random_uniform<T>(scalar, min, max);
+			inside &= v >= min && v <= max;
+		}
+		BANAN_CHECK(equal);
+		BANAN_CHECK(inside);
+		BANAN_CHECK(engine() == scalar());
+	}
+
+	template<typename Engine>
+	void check_bounded_ranges()
+	{
+		check_bounded<int32_t, Engine>(0, 9);
+		check_bounded<int32_t, Engine>(-5, 5);
+		check_bounded<uint32_t, Engine>(0, 0x80000007);
+		check_bounded<uint32_t, Engine>(0, 0xFFFFFFFF);
+		check_bounded<int32_t, Engine>(INT32_MIN, INT32_MAX);
+		check_bounded<int64_t, Engine>(-3, 1ll << 40);
+		check_bounded<uint64_t, Engine>(0, 0x8000000000000007);
+		check_bounded<uint64_t, Engine>(0, ~uint64_t(0));
+		check_bounded<uint8_t, Engine>(10, 200);
+	}
+}
+
+BANAN_TEST(bounded_integers_match_scalar)
+{
+	check_bounded_ranges<pcg32_fast>();
+	check_bounded_ranges<pcg64_fast>();
+
+	// And are uniform: a range just over 2^31 rejects about half the draws
+	pcg32_fast engine(8);
+	std::vector<uint32_t> values(200000);
+	fill_uniform<uint32_t>(engine, values, 0, 9);
+	std::vector<double> counts(10), fractions(10, 0.1);
+	for (uint32_t v : values)
+		counts[v]++;
+	BANAN_CHECK(test::fits(counts, fractions));
+
+	fill_uniform<uint32_t>(engine, values, 0, 0x80000000);
+	std::fill(counts.begin(), counts.end(), 0.0);
+	for (uint32_t v : values)
+		counts[std::min<uint32_t>(v / 0x0CCCCCCD, 9)]++;
+	BANAN_CHECK(test::fits(counts, fractions));
+}
+
+/* ##################### Normal and exponential ##################### */
+
+// compact_lanes moves the kept lanes to the front in order, for every mask
+namespace
+{
+	template<uint32_t Width, typename T>
+	void check_compact()
+	{
+		bool equal = true;
+		for (uint32_t kept = 0; kept < (uint32_t(1) << Width); kept++)
+		{
+			T values[Width], expected[Width];
+			uint32_t count = 0;
+			for (uint32_t i = 0; i < Width; i++)
+			{
+				values[i] = T(i + 1);
+				if (kept >> i & 1)
+					expected[count++] = T(i + 1);
+			}
+			equal &= detail::compact_lanes<Width>(values, kept) == count;
+			equal &= std::equal(values, values + count, expected);
+		}
+		BANAN_CHECK(equal);
+	}
+
+	template<typename T, uint32_t Layers, typename Engine>
+	void check_normal(uint64_t seed)
+	{
+		Engine engine(seed);
+		std::vector<T> values(400009);
+		fill_normal<T, Layers>(engine, std::span<T>(values), T(0), T(1));
+		BANAN_CHECK(all_finite<T>(values));
+		const test::moments m = moments_of<T>(values);
+		BANAN_CHECK(m.mean_near(0, 1));
+		BANAN_CHECK_NEAR(m.variance(), 1, 0.01);
+		BANAN_CHECK(test::fits(bin_counts<T>(values, s_normal_edges), bin_fractions(s_normal_edges, normal_cdf)));
+
+		// Tail beyond the base layer, 6.3e-5 of the values past 4
+		std::size_t tail = 0;
+		for (T value : values)
+			tail += std::abs(value) > T(4);
+		BANAN_CHECK_NEAR(double(tail), 2 * normal_cdf(-4) * values.size(), 5 * std::sqrt(2 * normal_cdf(-4) * values.size()));
+
+		// One at a time and shifted
+		for (T& value : values)
+			value = get_random_normal<T, Layers>(engine, T(3), T(2));
+		const test::moments scalar = moments_of<T>(values);
+		BANAN_CHECK(scalar.mean_near(3, 4));
+		BANAN_CHECK_NEAR(scalar.variance(), 4, 0.04);
+	}
+
+	template<typename T, uint32_t Layers, typename Engine>
+	void check_exponential(uint64_t seed)
+	{
+		Engine engine(seed);
+		std::vector<T> values(400009);
+		fill_exponential<T, Layers>(engine, std::span<T>(values), T(1));
+		BANAN_CHECK(all_finite<T>(values));
+		BANAN_CHECK(std::all_of(values.begin(), values.end(), [](T v) { return v >= T(0); }));
+		const test::moments m = moments_of<T>(values);
+		BANAN_CHECK(m.mean_near(1, 1));
+		BANAN_CHECK_NEAR(m.variance(), 1, 0.03);
+		BANAN_CHECK(test::fits(bin_counts<T>(values, s_exponential_edges), bin_fractions(s_exponential_edges, [](double x) { return 1 - std::exp(-x); })));
+
+		for (T& value : values)
+			value = get_random_exponential<T, Layers>(engine, T(4));
+		const test::moments scalar = moments_of<T>(values);
+		BANAN_CHECK(scalar.mean_near(0.25, 1.0 / 16));
+		BANAN_CHECK_NEAR(scalar.variance(), 1.0 / 16, 0.002);
+	}
+}
+
+BANAN_TEST(ziggurat_lane_compaction)
+{
+	check_compact<4, float>();
+	check_compact<8, float>();
+	check_compact<16, float>();
+	check_compact<4, double>();
+	check_compact<8, double>();
+	check_compact<detail::ziggurat_lanes<detail::normal_shape<float, 256>>::width + 1, float>();
+}
+
+BANAN_TEST(normal_moments_and_chi_square)
+{
+	check_normal<float, ziggurat_layers, pcg32_fast>(1);
+	check_normal<double, ziggurat_layers, pcg64_fast>(2);
+	check_normal<double, ziggurat_layers, pcg32_fast>(3);
+	check_normal<float, ziggurat_layers, pcg32_simd>(4);
+	check_normal<float, ziggurat_layers, std::mt19937>(5);
+}
+
+BANAN_TEST(exponential_moments_and_chi_square)
+{
+	check_exponential<float, ziggurat_layers, pcg32_fast>(1);
+	check_exponential<double, ziggurat_layers, pcg64_fast>(2);
+	check_exponential<float, ziggurat_layers, pcg32_simd>(3);
+	check_exponential<double, ziggurat_layers, std::mt19937_64>(4);
+}
+
+// Tables generated at compile time for other layer counts
+BANAN_TEST(ziggurat_layer_counts)
+{
+	check_normal<float, 128, pcg32_fast>(6);
+	check_normal<double, 128, pcg64_fast>(7);
+	check_normal<float, 1024, pcg32_fast>(8);
+	check_normal<double, 1024, pcg64_fast>(9);
+	check_exponential<float, 512, pcg32_fast>(10);
+	check_exponential<float, 1024, pcg32_fast>(11);
+	check_exponential<double, 2048, pcg64_fast>(12);
+}
+
+/* ##################### Gamma, Beta, Dirichlet ##################### */
+
+namespace
+{
+	template<typename T>
+	void check_gamma(T shape)
+	{
+		pcg64_fast engine(uint64_t(shape * 1000));
+		std::vector<T> values(200003);
+		fill_gamma<T>(engine, values, shape, T(2));
+		BANAN_CHECK(all_finite<T>(values));
+		BANAN_CHECK(std::all_of(values.begin(), values.end(), [](T v) { return v >= T(0); }));
+		const test::moments m = moments_of<T>(values);
+		BANAN_CHECK(m.mean_near(2 * shape, 4 * shape));
+		BANAN_CHECK_NEAR(m.variance(), 4 * shape, 4 * shape * (shape < 0.5 ? 0.2 : 0.03));
+
+		for (T& value : values)
+			value = get_random_gamma<T>(engine, shape);
+		const test::moments scalar = moments_of<T>(values);
+		BANAN_CHECK(scalar.mean_near(shape, shape));
+	}
+
+	template<typename T>
+	void check_beta(T a, T b)
+	{
+		pcg64_fast engine(uint64_t(a * 100 + b));
+		std::vector<T> values(200003);
+		fill_beta<T>(engine, values, a, b);
+		BANAN_CHECK(std::all_of(values.begin(), values.end(), [](T v) { return v >= T(0) && v <= T(1); }));
+		const double mean = double(a) / (a + b), variance = double(a) * b / ((a + b) * (a + b) * (a + b + 1));
+		const test::moments m = moments_of<T>(values);
+		BANAN_CHECK(m.mean_near(mean, variance));
+		BANAN_CHECK_NEAR(m.variance(), variance, variance * 0.03);
+
+		for (T& value : values)
+			value = get_random_beta<T>(engine, a, b);
+		BANAN_CHECK(std::all_of(values.begin(), values.end(), [](T v) { return v >= T(0) && v <= T(1); }));
+		BANAN_CHECK(moments_of<T>(values).mean_near(mean, variance));
+	}
+
+	template<typename T>
+	void check_dirichlet(std::vector<T> alpha)
+	{
+		pcg64_fast engine(alpha.size());
+		const std::size_t k = alpha.size(), draws = 100000;
+		std::vector<T> values(k * draws);
+		fill_dirichlet<T>(engine, values, alpha);
+		double sum_alpha = 0;
+		for (T a : alpha)
+			sum_alpha += a;
+
+		bool simplex = all_finite<T>(values);
+		for (std::size_t i = 0; i < draws; i++)
+		{
+			double sum = 0;
+			for (std::size_t j = 0; j < k; j++)
+				sum += values[i * k + j];
+			simplex &= test::near(sum, 1, 1e-5);
+		}
+		BANAN_CHECK(simplex);
+
+		for (std::size_t j = 0; j < k; j++)
+		{
+			test::moments m;
+			for (std::size_t i = 0; i < draws; i++)
+				m.add(values[i * k + j]);
+			const double mean = alpha[j] / sum_alpha;
+			BANAN_CHECK(m.mean_near(mean, mean * (1 - mean) / (sum_alpha + 1)));
+		}
+	}
+}
+
+BANAN_TEST(gamma_moments)
+{
+	for (double shape : { 0.01, 0.1, 0.5, 0.999, 1.0, 2.5, 10.0, 100.0 })
+	{
+		check_gamma<float>(float(shape));
+		check_gamma<double>(shape);
+	}
+}
+
+BANAN_TEST(beta_moments)
+{
+	check_beta<float>(2.0f, 5.0f);
+	check_beta<double>(0.5, 0.5);
+	check_beta<double>(0.05, 0.2);
+	check_beta<float>(0.01f, 0.01f);
+	check_beta<double>(30.0, 1.5);
+}
+
+BANAN_TEST(dirichlet_sums_and_moments)
+{
+	check_dirichlet<float>({ 1.0f, 2.0f, 3.0f });
+	check_dirichlet<double>({ 0.1, 0.1, 0.1, 0.1 });
+	check_dirichlet<float>({ 0.005f, 0.01f, 2.0f });
+	check_dirichlet<double>({ 0.001, 0.001 });
+
+	pcg64_fast engine(4);
+	bool simplex = true;
+	for (int i = 0; i < 10000; i++)
+	{
+		const vec3f v = get_random_dirichlet(engine, vec3f(0.01f, 0.02f, 0.03f));
+		simplex &= std::isfinite(v.x + v.y + v.z) && test::near(v.x + v.y + v.z, 1, 1e-5);
+	}
+	BANAN_CHECK(simplex);
+}
+
+/* ######################## Alias table ######################### */
+
+namespace
+{
+	// Probability of every outcome implied by the buckets of table
+	template<typename Ty>
+	std::vector<double> implied(const alias_table<Ty>& table)
+	{
+		std::vector<double> p(table.size());
+		const double bucket = 1.0 / (double(table.size()) * 4294967296.0);
+		for (uint32_t i = 0; i < table.size(); i++)
+		{
+			const auto& e = table.entries()[i];
+			p[i] += double(e.threshold) * bucket;
+			p[e.alias] += (4294967296.0 - double(e.threshold)) * bucket;
+		}
+		return p;
+	}
+
+	std::vector<float> weights(std::size_t count, int kind)
+	{
+		pcg32_fast engine(count + kind);
+		std::vector<float> w(count);
+		for (std::size_t i = 0; i < count; i++)
+		{
+			const float u = get_random_uniform<float>(engine);
+			switch (kind)
+			{
+			case 0: w[i] = u; break;
+			case 1: w[i] = std::exp(20 * u); break;
+			case 2: w[i] = i % 7 == 0 ? 0.0f : 1.0f; break;
+			default: w[i] = i == count / 2 ? 1e6f : u * 1e-3f; break;
+			}
+		}
+		return w;
+	}
+}
+
+BANAN_TEST(alias_table_probabilities)
+{
+	for (int kind = 0; kind < 4; kind++)
+	{
+		const std::vector<float> w = weights(1000, kind);
+		const alias_table<float> table(w);
+		double total = 0;
+		for (float x : w)
+			total += x;
+		BANAN_CHECK_NEAR(table.total(), total, total * 1e-6);
+
+		// Every outcome gets its weight up to the 32 bit thresholds
+		const std::vector<double> p = implied(table);
+		bool exact = true;
+		for (std::size_t i = 0; i < w.size(); i++)
+			exact &= test::near(p[i], w[i] / total, 1e-9) && (w[i] != 0 || p[i] == 0);
+		BANAN_CHECK(exact);
+
+		// Draws follow it, one by one and in bulk
+		pcg64_fast engine(kind);
+		std::vector<uint32_t> draws(2000000);
+		table.fill(engine, draws);
+		for (std::size_t i = 0; i < 200000; i++)
+			draws[i] = table.sample(engine);
+		std::vector<double> counts(w.size()), fractions(w.size());
+		for (uint32_t d : draws)
+			counts[d]++;
+		for (std::size_t i = 0; i < w.size(); i++)
+			fractions[i] = w[i] / total;
+		BANAN_CHECK(test::fits(counts, fractions));
+	}
+}
+
+// The executor build sweeps chunks independently and must give the table
+// of the serial sweep, bucket for bucket
+BANAN_TEST(alias_table_parallel_matches_serial)
+{
+	for (int kind = 0; kind < 4; kind++)
+		for (std::size_t count : { std::size_t(1000), std::size_t(200003), std::size_t(1) << 20 })
+		{
+			const std::vector<float> w = weights(count, kind);
+			const alias_table<float> serial(w);
+			for (uint32_t threads : { 1u, 3u, 4u })
+			{
+				thread_pool pool(threads);
+				const alias_table<float> parallel(pool, w);
+				BANAN_CHECK(parallel.size() == serial.size());
+				BANAN_CHECK(std::memcmp(parallel.entries().data(), serial.entries().data(), serial.entries().size_bytes()) == 0);
+			}
+		}
+}
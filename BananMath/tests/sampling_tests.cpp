@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <numbers>
+#include <span>
+#include <vector>
+
+#include "check.h"
+#include "random.h"
+#include "random_lanes.h"
+#include "sampling.h"
+#include "vec.h"
+
+namespace
+{
+	using namespace Banan;
+
+	constexpr std::size_t s_count = 200003;
+
+	// Counts of values in equal bins of [0, 1)
+	std::vector<double> uniform_counts(const std::vector<double>& values, std::size_t bins)
+	{
+		std::vector<double> counts(bins);
+		for (double v : values)
+			counts[std::min(std::size_t(v * double(bins)), bins - 1)]++;
+		return counts;
+	}
+
+	// True if the values, mapped by their cdf, are uniform on [0, 1)
+	bool follows(const std::vector<double>& values, const std::function<double(double)>& cdf, std::size_t bins = 20)
+	{
+		std::vector<double> mapped(values.size());
+		std::transform(values.begin(), values.end(), mapped.begin(), cdf);
+		return test::fits(uniform_counts(mapped, bins), std::vector<double>(bins, 1.0 / double(bins)));
+	}
+
+	template<typename Ty>
+	std::vector<vec<Ty, 3>> random_normals(std::size_t count, uint64_t seed)
+	{
+		pcg32_fast engine(seed);
+		std::vector<vec<Ty, 3>> normals(count);
+		for (vec<Ty, 3>& n : normals)
+			n = vec<Ty, 3>::random(engine);
+		return normals;
+	}
+}
+
+/* ####################### Disc and ball ####################### */
+
+// Points inside the disc and ball with uniform area (volume): the squared
+// (cubed) radius and the angle around the centre are uniform
+namespace
+{
+	template<typename Ty, typename Engine>
+	void check_disc(bool bulk)
+	{
+		Engine engine(17);
+		std::vector<vec<Ty, 2>> points(s_count);
+		if (bulk)
+			fill_in_unit_disc(engine, std::span<vec<Ty, 2>>(points));
+		else
+			for (vec<Ty, 2>& p : points)
+				p = vec<Ty, 2>::random_in_unit_disc(engine);
+
+		std::vector<double> area(s_count), angle(s_count);
+		test::moments x, y;
+		bool inside = true;
+		for (std::size_t i = 0; i < s_count; i++)
+		{
+			const double r2 = double(points[i].magSq());
+			inside &= r2 <= 1 + 1e-6;
+			area[i] = r2;
+			angle[i] = std::atan2(double(points[i].y), double(points[i].x)) / (2 * std::numbers::pi) + 0.5;
+			x.add(points[i].x);
+			y.add(points[i].y);
+		}
+		BANAN_CHECK(inside);
+		BANAN_CHECK(x.mean_near(0, 0.25) && y.mean_near(0, 0.25));
+		BANAN_CHECK_NEAR(x.variance(), 0.25, 0.005);
+		BANAN_CHECK(follows(area, [](double v) { return v; }));
+		BANAN_CHECK(follows(angle, [](double v) { return v; }, 32));
+	}
+
+	template<typename Ty, typename Engine>
+	void check_ball(bool bulk)
+	{
+		Engine engine(19);
+		std::vector<vec<Ty, 3>> points(s_count);
+		if (bulk)
+			fill_in_unit_sphere(engine, std::span<vec<Ty, 3>>(points));
+		else
+			for (vec<Ty, 3>& p : points)
+				p = vec<Ty, 3>::random_in_unit_sphere(engine);
+
+		std::vector<double> volume(s_count), height(s_count);
+		test::moments x;
+		bool inside = true;
+		for (std::size_t i = 0; i < s_count; i++)
+		{
+			const double r = std::sqrt(double(points[i].magSq()));
+			inside &= r <= 1 + 1e-6;
+			volume[i] = r * r * r;
+			// The height of a direction on the sphere is uniform in [-1, 1]
+			height[i] = r > 0 ? (double(points[i].z) / r + 1) / 2 : 0.5;
+			x.add(points[i].x);
+		}
+		BANAN_CHECK(inside);
+		BANAN_CHECK(x.mean_near(0, 0.2));
+		BANAN_CHECK_NEAR(x.variance(), 0.2, 0.004);
+		BANAN_CHECK(follows(volume, [](double v) { return v; }));
+		BANAN_CHECK(follows(height, [](double v) { return v; }));
+	}
+}
+
+BANAN_TEST(disc_points_are_uniform)
+{
+	check_disc<float, pcg32_fast>(false);
+	check_disc<float, pcg32_fast>(true);
+	check_disc<double, pcg64_fast>(false);
+	check_disc<double, pcg64_fast>(true);
+	check_disc<float, pcg32_simd>(true);
+}
+
+BANAN_TEST(ball_points_are_uniform)
+{
+	check_ball<float, pcg32_fast>(false);
+	check_ball<float, pcg32_fast>(true);
+	check_ball<double, pcg64_fast>(false);
+	check_ball<double, pcg64_fast>(true);
+	check_ball<float, pcg32_simd>(true);
+}
+
+BANAN_TEST(sphere_directions_are_uniform)
+{
+	pcg32_fast engine(23);
+	std::vector<vec3f> directions(s_count);
+	fill_on_unit_sphere(engine, std::span<vec3f>(directions));
+	std::vector<double> height(s_count), angle(s_count);
+	bool unit_length = true;
+	for (std::size_t i = 0; i < s_count; i++)
+	{
+		unit_length &= test::near(directions[i].mag(), 1, 1e-5);
+		height[i] = (double(directions[i].z) + 1) / 2;
+		angle[i] = std::atan2(double(directions[i].y), double(directions[i].x)) / (2 * std::numbers::pi) + 0.5;
+	}
+	BANAN_CHECK(unit_length);
+	BANAN_CHECK(follows(height, [](double v) { return v; }));
+	BANAN_CHECK(follows(angle, [](double v) { return v; }, 32));
+}
+
+/* ######################## Directions ######################### */
+
+// Directions around random normals: unit length, on the right side and
+// with angles to the normal distributed as the pdf says. The expected
+// fraction of every bin of cos_theta is 2 pi times the integral of
+// pdf(cos_theta) over it, so the samplers are checked against the pdfs.
+namespace
+{
+	// Fraction of the directions with cosine in [c0, c1]
+	double pdf_mass(const std::function<double(double)>& pdf, double c0, double c1)
+	{
+		constexpr int steps = 2000;
+		double sum = 0;
+		const double h = (c1 - c0) / steps;
+		for (int i = 0; i < steps; i++)
+			sum += pdf(c0 + (i + 0.5) * h);
+		return 2 * std::numbers::pi * sum * h;
+	}
+
+	template<typename Ty>
+	void check_directions(const std::vector<vec<Ty, 3>>& normals, const std::vector<vec<Ty, 3>>& directions, double cos_min, const std::function<double(double)>& pdf)
+	{
+		// Bins equal in the fourth root of 1 - cos_theta, narrow enough near
+		// the normal to resolve the sharp microfacet lobes
+		constexpr std::size_t bins = 32;
+		auto edge = [&](std::size_t b) { return 1 - (1 - cos_min) * std::pow(double(b) / bins, 4.0); };
+
+		std::vector<double> counts(bins), fractions(bins);
+		bool valid = true;
+		for (std::size_t i = 0; i < directions.size(); i++)
+		{
+			const double c = double(directions[i].dot(normals[i]));
+			valid &= test::near(directions[i].mag(), 1, 1e-4) && c >= cos_min - 1e-5;
+			const double t = std::pow(std::clamp((1 - c) / (1 - cos_min), 0.0, 1.0), 0.25);
+			counts[std::min(std::size_t(t * bins), bins - 1)]++;
+		}
+		BANAN_CHECK(valid);
+
+		double total = 0;
+		for (std::size_t b = 0; b < bins; b++)
+		{
+			fractions[b] = pdf_mass(pdf, edge(b + 1), edge(b));
+			total += fractions[b];
+		}
+		// The pdf integrates to one over its support
+		BANAN_CHECK_NEAR(total, 1, 1e-4);
+		BANAN_CHECK(test::fits(counts, fractions));
+	}
+
+	template<typename Ty, typename Engine>
+	void check_samplers()
+	{
+		const std::vector<vec<Ty, 3>> normals = random_normals<Ty>(s_count, 29);
+		std::vector<vec<Ty, 3>> out(s_count);
+		Engine engine(31);
+
+		auto hemisphere = [](double) { return double(hemisphere_pdf<Ty>()); };
+		fill_hemisphere(engine, normals, std::span<vec<Ty, 3>>(out));
+		check_directions<Ty>(normals, out, 0, hemisphere);
+		for (std::size_t i = 0; i < s_count; i++)
+			out[i] = random_hemisphere(engine, normals[i]);
+		check_directions<Ty>(normals, out, 0, hemisphere);
+
+		auto cosine = [](double c) { return double(cosine_hemisphere_pdf(Ty(c))); };
+		fill_cosine_hemisphere(engine, normals, std::span<vec<Ty, 3>>(out));
+		check_directions<Ty>(normals, out, 0, cosine);
+		for (std::size_t i = 0; i < s_count; i++)
+			out[i] = random_cosine_hemisphere(engine, normals[i]);
+		check_directions<Ty>(normals, out, 0, cosine);
+
+		const Ty cos_max = Ty(0.8);
+		auto cone = [&](double) { return double(cone_pdf(cos_max)); };
+		fill_cone(engine, normals, cos_max, std::span<vec<Ty, 3>>(out));
+		check_directions<Ty>(normals, out, cos_max, cone);
+		for (std::size_t i = 0; i < s_count; i++)
+			out[i] = random_cone(engine, normals[i], cos_max);
+		check_directions<Ty>(normals, out, cos_max, cone);
+
+		for (Ty alpha : { Ty(0.05), Ty(0.3), Ty(1) })
+		{
+			auto ggx = [&](double c) { return double(ggx_pdf(Ty(c), alpha)); };
+			fill_ggx_half(engine, normals, alpha, std::span<vec<Ty, 3>>(out));
+			check_directions<Ty>(normals, out, 0, ggx);
+			for (std::size_t i = 0; i < s_count; i++)
+				out[i] = random_ggx_half(engine, normals[i], alpha);
+			check_directions<Ty>(normals, out, 0, ggx);
+
+			auto beckmann = [&](double c) { return double(beckmann_pdf(Ty(c), alpha)); };
+			fill_beckmann_half(engine, normals, alpha, std::span<vec<Ty, 3>>(out));
+			check_directions<Ty>(normals, out, 0, beckmann);
+			for (std::size_t i = 0; i < s_count; i++)
+				out[i] = random_beckmann_half(engine, normals[i], alpha);
+			check_directions<Ty>(normals, out, 0, beckmann);
+		}
+	}
+}
+
+BANAN_TEST(direction_samplers_follow_pdfs)
+{
+	check_samplers<float, pcg32_fast>();
+	check_samplers<double, pcg64_fast>();
+}
+
+// Cones with one cosine per axis
+BANAN_TEST(cone_per_axis_angles)
+{
+	const std::vector<vec3f> axes = random_normals<float>(10000, 37);
+	std::vector<float> cos_max(axes.size());
+	std::vector<vec3f> out(axes.size());
+	pcg32_fast engine(41);
+	fill_uniform<float>(engine, cos_max, -0.5f, 0.99f);
+	fill_cone(engine, axes, std::span<const float>(cos_max), std::span<vec3f>(out));
+	bool inside = true;
+	for (std::size_t i = 0; i < axes.size(); i++)
+		inside &= out[i].dot(axes[i]) >= cos_max[i] - 1e-5f && test::near(out[i].mag(), 1, 1e-5);
+	BANAN_CHECK(inside);
+}
@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "check.h"
+#include "random.h"
+#include "vec.h"
+#include "vec_expr.h"
+#include "vec_packet.h"
+
+namespace
+{
+	using namespace Banan;
+
+	template<typename Ty, uint32_t N>
+	vec<Ty, N> random_vec(pcg32_fast& engine, Ty min = Ty(-4), Ty max = Ty(4))
+	{
+		vec<Ty, N> v;
+		for (uint32_t i = 0; i < N; i++)
+			v[i] = get_random_uniform<Ty>(engine, min, max);
+		return v;
+	}
+
+	// Components of a and b against a reference computed in double
+	template<typename V, std::size_t N>
+	bool close(const V& a, const std::array<double, N>& b, double tolerance)
+	{
+		for (uint32_t i = 0; i < N; i++)
+			if (!test::near(double(a[i]), b[i], tolerance * (1 + std::abs(b[i]))))
+				return false;
+		return true;
+	}
+
+	// The register backed vec3 and vec4 (and the scalar classes without
+	// simd) against component-wise formulas
+	template<typename Ty, uint32_t N>
+	void check_operators()
+	{
+		const double tolerance = sizeof(Ty) == 4 ? 1e-5 : 1e-12;
+		pcg32_fast engine(N);
+		for (int k = 0; k < 1000; k++)
+		{
+			const vec<Ty, N> a = random_vec<Ty, N>(engine), b = random_vec<Ty, N>(engine);
+			const Ty s = get_random_uniform<Ty>(engine, Ty(0.5), Ty(2));
+			std::array<double, N> sum, diff, scaled, quotient, product;
+			double dot = 0;
+			for (uint32_t i = 0; i < N; i++)
+			{
+				sum[i] = double(a[i]) + double(b[i]);
+				diff[i] = double(a[i]) - double(b[i]);
+				scaled[i] = double(a[i]) * double(s);
+				quotient[i] = double(a[i]) / double(s);
+				product[i] = double(a[i]) * double(b[i]);
+				dot += double(a[i]) * double(b[i]);
+			}
+			BANAN_CHECK(close(a + b, sum, tolerance));
+			BANAN_CHECK(close(a - b, diff, tolerance));
+			BANAN_CHECK(close(a * s, scaled, tolerance));
+			BANAN_CHECK(close(a / s, quotient, tolerance));
+			BANAN_CHECK(close(elem_mult(a, b), product, tolerance));
+			BANAN_CHECK(test::near(a.dot(b), dot, tolerance * 100));
+			BANAN_CHECK(test::near(a.magSq(), double(a.dot(a)), tolerance * 100));
+
+			// reflect mirrors a in the plane of the unit normal
+			const vec<Ty, N> n = unit(b);
+			const vec<Ty, N> r = reflect(a, n);
+			BANAN_CHECK(test::near(r.magSq(), a.magSq(), tolerance * 100));
+			BANAN_CHECK(test::near(r.dot(n), -double(a.dot(n)), tolerance * 100));
+
+			if constexpr (N == 3)
+			{
+				const std::array<double, 3> cross = {
+					double(a.y) * b.z - double(a.z) * b.y,
+					double(a.z) * b.x - double(a.x) * b.z,
+					double(a.x) * b.y - double(a.y) * b.x
+				};
+				BANAN_CHECK(close(a.cross(b), cross, tolerance * 10));
+
+				// Refraction with ratio 1 passes a unit vector straight through
+				const vec<Ty, 3> d = unit(a);
+				const vec<Ty, 3> through = refract(d, d.dot(n) < 0 ? n : -n, Ty(1));
+				BANAN_CHECK(test::near(through.dot(d), 1, tolerance * 10));
+			}
+		}
+	}
+}
+
+BANAN_TEST(vec_operators_match_components)
+{
+	check_operators<float, 2>();
+	check_operators<float, 3>();
+	check_operators<float, 4>();
+	check_operators<double, 3>();
+	check_operators<double, 4>();
+}
+
+// The padding lane of register backed vec3 must stay zero, or inf * 0 in
+// it turns dot and magSq into NaN
+BANAN_TEST(vec3_padding_lane_stays_zero)
+{
+	const float inf = std::numeric_limits<float>::infinity();
+	vec3f v(1.0f, 2.0f, 3.0f);
+	v *= inf;
+	BANAN_CHECK(v.dot(vec3f(1.0f, 1.0f, 1.0f)) == inf);
+	BANAN_CHECK(v.magSq() == inf);
+	BANAN_CHECK((vec3f(1.0f, 1.0f, 1.0f) * inf).magSq() == inf);
+	BANAN_CHECK((vec3f(1.0f, 1.0f, 1.0f) / 0.0f).magSq() == inf);
+
+	vec3d d(1.0, 2.0, 3.0);
+	d *= std::numeric_limits<double>::infinity();
+	BANAN_CHECK(d.magSq() == std::numeric_limits<double>::infinity());
+
+#if defined(BANAN_SSE)
+	// A register with something in its 4th lane loses it on construction
+	const vec3f r(simd::reg4<float>::set(1.0f, 2.0f, 2.0f, 5.0f));
+	BANAN_CHECK(r.magSq() == 9.0f);
+	BANAN_CHECK(r.dot(vec3f(1.0f, 1.0f, 1.0f)) == 5.0f);
+	BANAN_CHECK(test::near(unit(r).mag(), 1, 1e-6));
+#endif
+}
+
+// Geometry tables built at compile time
+namespace
+{
+	constexpr std::array<vec3f, 4> directions = {
+		unit(vec3f(3.0f, 0.0f, 4.0f)),
+		vec3f(1.0f, 0.0f, 0.0f).cross(vec3f(0.0f, 1.0f, 0.0f)),
+		reflect(vec3f(1.0f, -1.0f, 0.0f), vec3f(0.0f, 1.0f, 0.0f)),
+		elem_mult(vec3f(1.0f, 2.0f, 3.0f), vec3f(2.0f, 2.0f, 2.0f)) - vec3f(2.0f, 4.0f, 6.0f)
+	};
+	static_assert(directions[0].x == 0.6f && directions[0].z == 0.8f);
+	static_assert(directions[1].z == 1.0f);
+	static_assert(directions[2].y == 1.0f);
+	static_assert(directions[3].magSq() == 0.0f);
+}
+
+BANAN_TEST(vec_constexpr_matches_runtime)
+{
+	volatile float x = 3.0f, z = 4.0f;
+	const vec3f runtime = unit(vec3f(float(x), 0.0f, float(z)));
+	BANAN_CHECK_NEAR(runtime.x, directions[0].x, 1e-7);
+	BANAN_CHECK_NEAR(runtime.z, directions[0].z, 1e-7);
+}
+
+// The generic vec unrolls up to vec_unroll_limit and runs native chunks
+// above it, both against plain loops
+namespace
+{
+	template<uint32_t Size>
+	void check_generic()
+	{
+		pcg32_fast engine(Size);
+		const vec<float, Size> a = random_vec<float, Size>(engine), b = random_vec<float, Size>(engine);
+		const vec<float, Size> sum = a + b, diff = a - b, scaled = a * 1.5f;
+		double dot = 0;
+		bool equal = true;
+		for (uint32_t i = 0; i < Size; i++)
+		{
+			equal &= sum[i] == a[i] + b[i] && diff[i] == a[i] - b[i] && scaled[i] == a[i] * 1.5f;
+			dot += double(a[i]) * double(b[i]);
+		}
+		BANAN_CHECK(equal);
+		BANAN_CHECK_NEAR(a.dot(b), dot, 1e-5 * Size);
+	}
+}
+
+BANAN_TEST(generic_vec_matches_loops)
+{
+	check_generic<5>();
+	check_generic<8>();
+	check_generic<16>();
+	check_generic<17>();
+	check_generic<64>();
+	check_generic<1000>();
+	check_generic<1024>();
+}
+
+BANAN_TEST(expression_templates_match_eager)
+{
+	pcg32_fast engine(3);
+	const vec<float, 256> a = random_vec<float, 256>(engine), b = random_vec<float, 256>(engine), c = random_vec<float, 256>(engine);
+	const vec<float, 256> eager = a + 2.5f * b - c;
+	const vec<float, 256> lazy = expr::lazy(a) + 2.5f * expr::lazy(b) - c;
+	bool close = true;
+	for (uint32_t i = 0; i < 256; i++)
+		close &= test::near(lazy[i], eager[i], 1e-5);
+	BANAN_CHECK(close);
+
+	// Assigning back into an operand
+	vec<float, 256> d = a;
+	d = expr::lazy(d) * 2.0f + b;
+	bool assigned = true;
+	for (uint32_t i = 0; i < 256; i++)
+		assigned &= test::near(d[i], a[i] * 2.0f + b[i], 1e-5);
+	BANAN_CHECK(assigned);
+}
+
+// normalize_fast within 1e-6 of the exact result, zero vectors left
+// untouched and lengths whose square is subnormal still unit
+namespace
+{
+	template<uint32_t N>
+	void check_normalize_fast()
+	{
+		pcg32_fast engine(N);
+		double worst = 0, worst_subnormal = 0;
+		bool finite = true;
+		for (int k = 0; k < 20000; k++)
+		{
+			// Squared lengths from 2^-140 to below the float overflow at
+			// 2^128, the first 10 octaves subnormal
+			const int exponent = int(k % 133) - 70;
+			vec<float, N> v = random_vec<float, N>(engine, 0.5f, 1.0f);
+			v *= std::ldexp(1.0f, exponent);
+			double length = 0;
+			for (uint32_t i = 0; i < N; i++)
+				length += double(v[i]) * double(v[i]);
+			length = std::sqrt(length);
+			const vec<float, N> u = unit_fast(v);
+			double error = 0;
+			for (uint32_t i = 0; i < N; i++)
+			{
+				finite &= std::isfinite(u[i]);
+				error = std::max(error, std::abs(double(u[i]) - double(v[i]) / length));
+			}
+			double& bound = exponent < -63 ? worst_subnormal : worst;
+			bound = std::max(bound, error);
+		}
+		BANAN_CHECK(finite);
+		BANAN_CHECK(worst < 1e-6);
+		// The subnormal square itself keeps only a few bits
+		BANAN_CHECK(worst_subnormal < 1e-2);
+
+		vec<float, N> zero;
+		for (uint32_t i = 0; i < N; i++)
+			zero[i] = 0.0f;
+		zero.normalize_fast();
+		for (uint32_t i = 0; i < N; i++)
+			BANAN_CHECK(zero[i] == 0.0f);
+	}
+}
+
+BANAN_TEST(normalize_fast_error_and_zero)
+{
+	check_normalize_fast<2>();
+	check_normalize_fast<3>();
+	check_normalize_fast<4>();
+	check_normalize_fast<7>();
+
+	pcg32_fast engine(9);
+	std::vector<vec3f> in(1000), out(1000);
+	for (std::size_t i = 0; i < in.size(); i++)
+		in[i] = random_vec<float, 3>(engine) * (i % 3 == 0 ? 1e-20f : 1.0f);
+	in[10] = vec3f(0.0f, 0.0f, 0.0f);
+	unit_fast(std::span<const vec3f>(in), std::span<vec3f>(out));
+	bool unit_length = true;
+	for (std::size_t i = 0; i < in.size(); i++)
+		if (i != 10)
+			unit_length &= test::near(out[i].mag(), 1, 1e-3);
+	BANAN_CHECK(unit_length);
+	BANAN_CHECK(out[10].magSq() == 0.0f);
+}
+
+// Lanes of a vec_packet against the same operations on single vectors
+BANAN_TEST(vec_packet_matches_vec)
+{
+	constexpr uint32_t W = 8;
+	pcg32_fast engine(11);
+	vec3f a[W], b[W], sum[W], cross[W], unit_a[W], quotient[W];
+	float dot[W];
+	for (uint32_t i = 0; i < W; i++)
+	{
+		a[i] = random_vec<float, 3>(engine);
+		b[i] = random_vec<float, 3>(engine);
+	}
+	const vec_packet<float, 3, W> pa = vec_packet<float, 3, W>::load(a), pb = vec_packet<float, 3, W>::load(b);
+	(pa + pb).store(sum);
+	pa.cross(pb).store(cross);
+	unit(pa).store(unit_a);
+	pa.dot(pb).store(dot);
+	(pa / 3.0f).store(quotient);
+	for (uint32_t i = 0; i < W; i++)
+	{
+		BANAN_CHECK(sum[i].x == (a[i] + b[i]).x && sum[i].z == (a[i] + b[i]).z);
+		BANAN_CHECK_NEAR((cross[i] - a[i].cross(b[i])).mag(), 0, 1e-5);
+		BANAN_CHECK_NEAR((unit_a[i] - unit(a[i])).mag(), 0, 1e-6);
+		BANAN_CHECK_NEAR(dot[i], a[i].dot(b[i]), 1e-5);
+		// Division rounds like vec, not like a multiply by 1/3
+		const vec3f q = a[i] / 3.0f;
+		BANAN_CHECK(quotient[i].x == q.x && quotient[i].y == q.y && quotient[i].z == q.z);
+	}
+}